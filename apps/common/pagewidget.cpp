@@ -47,7 +47,12 @@ const QMargins& PageWidget::margins() const
   return m_renderwidget->margins();
 }
 
-void PageWidget::setBox(std::shared_ptr<tex::Box> box)
+void PageWidget::setTypesetEngine(std::shared_ptr<TypesetEngine> engine)
+{
+  m_renderwidget->setTypesetEngine(std::move(engine));
+}
+
+void PageWidget::setBox(tex::NodeRef<tex::Box> box)
 {
   m_renderwidget->setBox(box);
 
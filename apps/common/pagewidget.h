@@ -28,7 +28,9 @@ public:
   void setMargins(QMargins margins);
   const QMargins& margins() const;
 
-  void setBox(std::shared_ptr<tex::Box> box);
+  void setBox(tex::NodeRef<tex::Box> box);
+
+  void setTypesetEngine(std::shared_ptr<TypesetEngine> engine);
 
 protected:
   void paintEvent(QPaintEvent* ev) override;
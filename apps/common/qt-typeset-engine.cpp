@@ -36,7 +36,7 @@ tex::BoxMetrics QtFontMetricsProdiver::metrics(tex::Character c, tex::Font font)
   return ret;
 }
 
-tex::BoxMetrics QtFontMetricsProdiver::metrics(const std::shared_ptr<tex::Symbol> & symbol, tex::Font font)
+tex::BoxMetrics QtFontMetricsProdiver::metrics(const tex::NodeRef<tex::Symbol> & symbol, tex::Font font)
 {
   if (symbol->isMathSymbol())
   {
@@ -57,7 +57,7 @@ tex::BoxMetrics QtFontMetricsProdiver::metrics(const std::shared_ptr<tex::Symbol
   }
 }
 
-float QtFontMetricsProdiver::italicCorrection(const std::shared_ptr<tex::Symbol> & symbol, tex::Font font)
+float QtFontMetricsProdiver::italicCorrection(const tex::NodeRef<tex::Symbol> & symbol, tex::Font font)
 {
   return 0;
 }
@@ -136,7 +136,7 @@ void TypesetEngine::reset(float mag)
 
   const int class_num = 11; // this class num is not valid, but equals to math::Atom::Rad
   const int fam = 3;
-  mRadicalSign = std::make_shared<tex::MathSymbol>(tex::mathchars::SQRT, class_num, fam);
+  mRadicalSign = tex::make_node<tex::MathSymbol>(tex::mathchars::SQRT, class_num, fam);
 
   mMetrics = std::make_shared<QtFontMetricsProdiver>(m_fonts);
 }
@@ -188,25 +188,31 @@ std::array<tex::MathFont, 16> TypesetEngine::mathfonts() const
   return result;
 }
 
-std::shared_ptr<tex::Box> TypesetEngine::typeset(tex::Character c, tex::Font font)
+tex::NodeRef<tex::Box> TypesetEngine::typeset(tex::Character c, tex::Font font)
 {
   tex::BoxMetrics box = metrics()->metrics(c, font);
-  return std::make_shared<CharBox>(c, font, box, this->font(font));
+  return tex::make_node<CharBox>(c, font, box, this->font(font));
 }
 
-std::shared_ptr<tex::Box> TypesetEngine::typeset(const std::string& text, tex::Font font)
+tex::NodeRef<tex::Box> TypesetEngine::typeset(tex::Character c, tex::Font font, tex::NodeArena& arena)
+{
+  tex::BoxMetrics box = metrics()->metrics(c, font);
+  return arena.make<CharBox>(c, font, box, this->font(font));
+}
+
+tex::NodeRef<tex::Box> TypesetEngine::typeset(const std::string& text, tex::Font font)
 {
   // @TODO: handle this case
   throw std::runtime_error{ "TypesetEngine::typeset() : text typesetting not implemented" };
 }
 
-std::shared_ptr<tex::Box> TypesetEngine::typeset(const std::shared_ptr<tex::Symbol> & symbol, tex::Font font)
+tex::NodeRef<tex::Box> TypesetEngine::typeset(const tex::NodeRef<tex::Symbol> & symbol, tex::Font font)
 {
   if (symbol->isMathSymbol())
   {
     tex::Character c = static_cast<tex::MathSymbol*>(symbol.get())->character();
     tex::BoxMetrics box = metrics()->metrics(symbol, font);
-    return std::make_shared<CharBox>(c, font, box, this->font(font));
+    return tex::make_node<CharBox>(c, font, box, this->font(font));
   }
   else
   {
@@ -215,11 +221,11 @@ std::shared_ptr<tex::Box> TypesetEngine::typeset(const std::shared_ptr<tex::Symb
   }
 }
 
-std::shared_ptr<tex::Box> TypesetEngine::typesetRadicalSign(float minTotalHeight)
+tex::NodeRef<tex::Box> TypesetEngine::typesetRadicalSign(float minTotalHeight)
 {
   tex::Font font = tex::Font(mRadicalSign->family() * 3);
   auto metrics = mMetrics->metrics(mRadicalSign, font);
-  auto ret = std::make_shared<CharBox>(mRadicalSign->character(), font, metrics, m_fonts[font.id()].font);
+  auto ret = tex::make_node<CharBox>(mRadicalSign->character(), font, metrics, m_fonts[font.id()].font);
   const float ratio = minTotalHeight / (metrics.height + metrics.depth);
 
   if (ratio > 1.f)
@@ -233,13 +239,13 @@ std::shared_ptr<tex::Box> TypesetEngine::typesetRadicalSign(float minTotalHeight
   return ret;
 }
 
-std::shared_ptr<tex::Box> TypesetEngine::typesetDelimiter(const std::shared_ptr<tex::Symbol> & symbol, float minTotalHeight)
+tex::NodeRef<tex::Box> TypesetEngine::typesetDelimiter(const tex::NodeRef<tex::Symbol> & symbol, float minTotalHeight)
 {
-  auto mathsymbol = std::static_pointer_cast<tex::MathSymbol>(symbol);
+  auto mathsymbol = tex::static_pointer_cast<tex::MathSymbol>(symbol);
 
   tex::Font font = tex::Font(mathsymbol->family() * 3);
   auto metrics = mMetrics->metrics(mathsymbol, font);
-  auto ret = std::make_shared<CharBox>(mathsymbol->character(), font, metrics, m_fonts[font.id()].font);
+  auto ret = tex::make_node<CharBox>(mathsymbol->character(), font, metrics, m_fonts[font.id()].font);
   const float ratio = minTotalHeight / (metrics.height + metrics.depth);
 
   if (ratio > 1.f)
@@ -253,7 +259,7 @@ std::shared_ptr<tex::Box> TypesetEngine::typesetDelimiter(const std::shared_ptr<
   return ret;
 }
 
-std::shared_ptr<tex::Box> TypesetEngine::typesetLargeOp(const std::shared_ptr<tex::Symbol> & symbol)
+tex::NodeRef<tex::Box> TypesetEngine::typesetLargeOp(const tex::NodeRef<tex::Symbol> & symbol)
 {
   return typeset(symbol, tex::Font::MathRoman);
 }
@@ -6,6 +6,7 @@
 #define LIBTYPESET_APPCOMMON_TYPESETENGINE_H
 
 #include <tex/charbox.h>
+#include <tex/nodearena.h>
 #include <tex/typeset.h>
 #include <tex/tfm.h>
 #include <tex/math/math-typeset.h>
@@ -45,8 +46,8 @@ public:
   ~QtFontMetricsProdiver() = default;
 
   tex::BoxMetrics metrics(tex::Character c, tex::Font font) override;
-  tex::BoxMetrics metrics(const std::shared_ptr<tex::Symbol> & symbol, tex::Font font) override;
-  float italicCorrection(const std::shared_ptr<tex::Symbol> & symbol, tex::Font font) override;
+  tex::BoxMetrics metrics(const tex::NodeRef<tex::Symbol> & symbol, tex::Font font) override;
+  float italicCorrection(const tex::NodeRef<tex::Symbol> & symbol, tex::Font font) override;
   int sfcode(tex::Character c) override;
 
   const tex::FontDimen& fontdimen(tex::Font f) override;
@@ -97,12 +98,13 @@ public:
 
   std::shared_ptr<tex::FontMetricsProvider> metrics() const override;
 
-  std::shared_ptr<tex::Box> typeset(tex::Character c, tex::Font font) override;
-  std::shared_ptr<tex::Box> typeset(const std::string& text, tex::Font font) override;
-  std::shared_ptr<tex::Box> typeset(const std::shared_ptr<tex::Symbol> & symbol, tex::Font font) override;
-  std::shared_ptr<tex::Box> typesetRadicalSign(float minTotalHeight) override;
-  std::shared_ptr<tex::Box> typesetDelimiter(const std::shared_ptr<tex::Symbol> & symbol, float minTotalHeight) override;
-  std::shared_ptr<tex::Box> typesetLargeOp(const std::shared_ptr<tex::Symbol> & symbol) override;
+  tex::NodeRef<tex::Box> typeset(tex::Character c, tex::Font font) override;
+  tex::NodeRef<tex::Box> typeset(tex::Character c, tex::Font font, tex::NodeArena& arena) override;
+  tex::NodeRef<tex::Box> typeset(const std::string& text, tex::Font font) override;
+  tex::NodeRef<tex::Box> typeset(const tex::NodeRef<tex::Symbol> & symbol, tex::Font font) override;
+  tex::NodeRef<tex::Box> typesetRadicalSign(float minTotalHeight) override;
+  tex::NodeRef<tex::Box> typesetDelimiter(const tex::NodeRef<tex::Symbol> & symbol, float minTotalHeight) override;
+  tex::NodeRef<tex::Box> typesetLargeOp(const tex::NodeRef<tex::Symbol> & symbol) override;
 
 protected:
 
@@ -114,7 +116,7 @@ private:
   float m_mag;
   FontTable m_fonts;
   std::shared_ptr<QtFontMetricsProdiver> mMetrics;
-  std::shared_ptr<tex::MathSymbol> mRadicalSign;
+  tex::NodeRef<tex::MathSymbol> mRadicalSign;
 };
 
 #endif // LIBTYPESET_APPCOMMON_TYPESETENGINE_H
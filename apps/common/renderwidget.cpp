@@ -7,6 +7,7 @@
 #include "qt-typeset-engine.h"
 
 #include <tex/charbox.h>
+#include <tex/glyphrun.h>
 #include <tex/layoutreader.h>
 
 #include <QBrush>
@@ -25,12 +26,12 @@ public:
 
   }
 
-  void operator()(const std::shared_ptr<tex::Box>& box, tex::Pos pos)
+  void operator()(const tex::NodeRef<tex::Box>& box, tex::Pos pos)
   {
     widget->paint(*painter, box, QPointF{ pos.x, pos.y });
   }
 
-  void operator()(const std::shared_ptr<tex::Rule>& rule, tex::Pos pos)
+  void operator()(const tex::NodeRef<tex::Rule>& rule, tex::Pos pos)
   {
     widget->paint(*painter, rule, QPointF{ pos.x, pos.y });
   }
@@ -67,12 +68,24 @@ const QMargins& RenderWidget::margins() const
   return m_margins;
 }
 
-void RenderWidget::setBox(std::shared_ptr<tex::Box> box)
+void RenderWidget::setBox(tex::NodeRef<tex::Box> box)
 {
   m_box = box;
   update();
 }
 
+// The engine that created the boxes; glyph runs are drawn with its fonts
+void RenderWidget::setTypesetEngine(std::shared_ptr<TypesetEngine> engine)
+{
+  m_engine = std::move(engine);
+  update();
+}
+
+const std::shared_ptr<TypesetEngine>& RenderWidget::typesetEngine() const
+{
+  return m_engine;
+}
+
 void RenderWidget::paintEvent(QPaintEvent* ev)
 {
   QPainter p{ this };
@@ -88,7 +101,7 @@ void RenderWidget::paintEvent(QPaintEvent* ev)
   }
 }
 
-void RenderWidget::visit(QPainter& painter, std::shared_ptr<tex::Box> box)
+void RenderWidget::visit(QPainter& painter, tex::NodeRef<tex::Box> box)
 {
   LayoutVisitor visitor{ this, &painter };
 
@@ -115,8 +128,14 @@ QRectF RenderWidget::getRect(const QPointF& pos, const tex::Box& box)
   return QRectF{ topLeft, size };
 }
 
-void RenderWidget::paint(QPainter& painter, const std::shared_ptr<tex::Box>& box, const QPointF& pos)
+void RenderWidget::paint(QPainter& painter, const tex::NodeRef<tex::Box>& box, const QPointF& pos)
 {
+  if (box->isGlyphRun())
+  {
+    paintGlyphRun(painter, box->as<tex::GlyphRun>(), pos);
+    return;
+  }
+
   if (!box->isCharacterBox())
     return;
 
@@ -148,7 +167,27 @@ void RenderWidget::paint(QPainter& painter, const std::shared_ptr<tex::Box>& box
   painter.restore();
 }
 
-void RenderWidget::paint(QPainter& painter, const std::shared_ptr<tex::Rule>& rule, const QPointF& pos)
+void RenderWidget::paintGlyphRun(QPainter& painter, const tex::GlyphRun& run, const QPointF& pos)
+{
+  if (!m_engine)
+    return;
+
+  painter.save();
+  painter.setFont(m_engine->fonts().at(run.font().id()).font);
+
+  QPointF origin = pos;
+
+  for (size_t i(0); i < run.size(); ++i)
+  {
+    const uint ucs4 = static_cast<uint>(run.characters()[i]);
+    painter.drawText(origin, QString::fromUcs4(&ucs4, 1));
+    origin.rx() += run.advances()[i];
+  }
+
+  painter.restore();
+}
+
+void RenderWidget::paint(QPainter& painter, const tex::NodeRef<tex::Rule>& rule, const QPointF& pos)
 {
   painter.save();
   painter.setPen(Qt::NoPen);
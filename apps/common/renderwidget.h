@@ -11,13 +11,18 @@
 
 #include "tex/box.h"
 
+#include <memory>
+
 namespace tex
 {
+class GlyphRun;
 class Rule;
 } // namespace tex
 
 class QPainter;
 
+class TypesetEngine;
+
 class RenderWidget : public QWidget
 {
   Q_OBJECT
@@ -30,7 +35,10 @@ public:
   void setMargins(QMargins margins);
   const QMargins& margins() const;
 
-  void setBox(std::shared_ptr<tex::Box> box);
+  void setBox(tex::NodeRef<tex::Box> box);
+
+  void setTypesetEngine(std::shared_ptr<TypesetEngine> engine);
+  const std::shared_ptr<TypesetEngine>& typesetEngine() const;
 
 protected:
   void paintEvent(QPaintEvent* ev) override;
@@ -38,17 +46,20 @@ protected:
 protected:
   friend class LayoutVisitor;
 
-  void visit(QPainter& painter, std::shared_ptr<tex::Box> box);
+  void visit(QPainter& painter, tex::NodeRef<tex::Box> box);
 
   static QRectF getRect(const QPointF& pos, const tex::Box& box);
 
-  virtual void paint(QPainter& painter, const std::shared_ptr<tex::Box>& box, const QPointF& pos);
-  virtual void paint(QPainter& painter, const std::shared_ptr<tex::Rule>& rule, const QPointF& pos);
+  virtual void paint(QPainter& painter, const tex::NodeRef<tex::Box>& box, const QPointF& pos);
+  virtual void paint(QPainter& painter, const tex::NodeRef<tex::Rule>& rule, const QPointF& pos);
+
+  void paintGlyphRun(QPainter& painter, const tex::GlyphRun& run, const QPointF& pos);
 
 private:
   bool m_center = false;
   QMargins m_margins;
-  std::shared_ptr<tex::Box> m_box;
+  tex::NodeRef<tex::Box> m_box;
+  std::shared_ptr<TypesetEngine> m_engine;
 };
 
 #endif // LIBTYPESET_APPCOMMON_RENDERWIDGET_H
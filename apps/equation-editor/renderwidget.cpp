@@ -54,7 +54,7 @@ void EquationEditorRenderWidget::setDrawBaselines(bool on)
   }
 }
 
-void EquationEditorRenderWidget::paint(QPainter& painter, const std::shared_ptr<tex::Box>& box, const QPointF& pos)
+void EquationEditorRenderWidget::paint(QPainter& painter, const tex::NodeRef<tex::Box>& box, const QPointF& pos)
 {
   if (!box->isCharacterBox())
   {
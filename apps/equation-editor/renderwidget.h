@@ -19,10 +19,10 @@ public:
   void setDrawBaselines(bool on);
 
 protected:
-  void paint(QPainter& painter, const std::shared_ptr<tex::Box>& box, const QPointF& pos) override;
+  void paint(QPainter& painter, const tex::NodeRef<tex::Box>& box, const QPointF& pos) override;
 
 private:
-  std::shared_ptr<tex::Box> m_box;
+  tex::NodeRef<tex::Box> m_box;
   bool m_draw_chars = true;
   bool m_draw_char_bbox = false;
   bool m_draw_listbox = false;
@@ -10,7 +10,7 @@
 #include <QPainter>
 #include <QPen>
 
-void LinebreaksViewerRenderWidget::paint(QPainter& painter, const std::shared_ptr<tex::Box>& box, const QPointF& pos)
+void LinebreaksViewerRenderWidget::paint(QPainter& painter, const tex::NodeRef<tex::Box>& box, const QPointF& pos)
 {
   RenderWidget::paint(painter, box, pos);
 
@@ -15,7 +15,7 @@ public:
 public:
   using RenderWidget::RenderWidget;
 
-  void paint(QPainter& painter, const std::shared_ptr<tex::Box>& box, const QPointF& pos) override;
+  void paint(QPainter& painter, const tex::NodeRef<tex::Box>& box, const QPointF& pos) override;
 
 
 };
@@ -76,6 +76,7 @@ LinebreaksViewerWindow::LinebreaksViewerWindow()
   
   QSplitter* vertical_splitter = new QSplitter(Qt::Vertical);
   m_renderwidget = new LinebreaksViewerRenderWidget;
+  m_renderwidget->setTypesetEngine(m_engine);
   vertical_splitter->addWidget(m_renderwidget);
 
   m_textedit = new QPlainTextEdit;
@@ -331,7 +332,7 @@ void LinebreaksViewerWindow::setup(tex::Paragraph& linebreaker)
   linebreaker.hangafter = m_hangafter_input->value();
 }
 
-void LinebreaksViewerWindow::write(std::shared_ptr<tex::Glue>& g, QLineEdit* lineedit)
+void LinebreaksViewerWindow::write(tex::NodeRef<tex::Glue>& g, QLineEdit* lineedit)
 {
   try
   {
@@ -438,6 +439,7 @@ void LinebreaksViewerWindow::processText()
     }
   }
 
+  builder.finish();
   m_list = std::move(builder.result);
 
   tex::Paragraph paragraph;
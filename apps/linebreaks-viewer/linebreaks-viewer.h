@@ -46,7 +46,7 @@ protected Q_SLOTS:
   void onSelectedBreakpointChanged();
 
 protected:
-  void write(std::shared_ptr<tex::Glue>& g, QLineEdit* lineedit);
+  void write(tex::NodeRef<tex::Glue>& g, QLineEdit* lineedit);
   void write(float& space, QLineEdit* lineedit);
   tex::Parshape parseParshape() const;
   void processText();
@@ -56,10 +56,10 @@ private:
   std::shared_ptr<TypesetEngine> m_engine;
   tex::UnitSystem m_unitsystem;
   tex::List m_list;
-  std::shared_ptr<tex::Glue> m_leftskip;
-  std::shared_ptr<tex::Glue> m_rightskip;
-  std::shared_ptr<tex::Glue> m_baselineskip;
-  std::shared_ptr<tex::Glue> m_lineskip;
+  tex::NodeRef<tex::Glue> m_leftskip;
+  tex::NodeRef<tex::Glue> m_rightskip;
+  tex::NodeRef<tex::Glue> m_baselineskip;
+  tex::NodeRef<tex::Glue> m_lineskip;
   float m_lineskiplimit = 0.f;
   float m_hangindent = 0.f;
   tex::Parshape m_parshape;
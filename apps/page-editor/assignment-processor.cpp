@@ -18,6 +18,15 @@ AssignmentProcessor::~AssignmentProcessor()
 
 }
 
+void AssignmentProcessor::reset(std::map<std::string, tex::Font> fonts)
+{
+  m_state = State::Main;
+  m_font_map = std::move(fonts);
+  m_output.clear();
+  m_parshape.reset();
+  m_font.reset();
+}
+
 const std::map<std::string, AssignmentProcessor::CS>& AssignmentProcessor::csmap()
 {
   static const std::map<std::string, AssignmentProcessor::CS> map = {
@@ -93,7 +102,7 @@ bool AssignmentProcessor::changeFont(const std::string& csname)
   if (it == m_font_map.end())
     return false;
 
-  m_machine.memory().font = it->second;
+  m_machine.assign(&TypesettingMachine::Memory::font, it->second);
 
   return true;
 }
@@ -126,7 +135,7 @@ void AssignmentProcessor::write_parshape(tex::parsing::Token& t)
   if (m_parshape->isFinished() || t.isControlSequence())
   {
     tex::Parshape ps = m_parshape->finish();
-    m_machine.memory().parshape = ps;
+    m_machine.assign(&TypesettingMachine::Memory::parshape, std::move(ps));
     m_parshape.reset();
     m_state = State::Main;
 
@@ -45,6 +45,10 @@ public:
 
   std::vector<tex::parsing::Token>& output();
 
+  State state() const;
+  const std::map<std::string, tex::Font>& fonts() const;
+  void reset(std::map<std::string, tex::Font> fonts);
+
 protected:
   bool handleCs(const std::string& csname);
   bool changeFont(const std::string& csname);
@@ -67,4 +71,14 @@ inline std::vector<tex::parsing::Token>& AssignmentProcessor::output()
   return m_output;
 }
 
+inline AssignmentProcessor::State AssignmentProcessor::state() const
+{
+  return m_state;
+}
+
+inline const std::map<std::string, tex::Font>& AssignmentProcessor::fonts() const
+{
+  return m_font_map;
+}
+
 #endif // TYPESET_PAGEEDITOR_ASSIGNMENTPROCESSOR_H
@@ -16,6 +16,7 @@ HorizontalMode::HorizontalMode(TypesettingMachine& m)
   : Mode(m),
     m_hlist(m.typesetEngine(), m.memory().font)
 {
+  m_hlist.arena = m.arena();
   m_is_restricted = parent().kind() == Mode::Kind::Horizontal;
 
   output_routine = [](HorizontalMode&) {
@@ -28,6 +29,7 @@ HorizontalMode::HorizontalMode(TypesettingMachine& m, std::function<void(Horizon
   m_hlist(m.typesetEngine(), m.memory().font),
   output_routine(std::move(o_routine))
 {
+  m_hlist.arena = m.arena();
   m_is_restricted = parent().kind() == Mode::Kind::Horizontal;
 }
 
@@ -248,7 +250,7 @@ void HorizontalMode::write(tex::parsing::Token& t)
   }
 }
 
-void HorizontalMode::write(std::shared_ptr<tex::ListBox> box)
+void HorizontalMode::write(tex::NodeRef<tex::ListBox> box)
 {
   if (m_lower != 0.f)
   {
@@ -283,6 +285,7 @@ void HorizontalMode::writeOutput()
 
 void HorizontalMode::writeToHorizontalMode(HorizontalMode& output, HorizontalMode& self)
 {
+  self.hlist().finish();
   auto b = tex::hbox(std::move(self.hlist().result));
   output.write(b);
 }
@@ -296,10 +299,15 @@ void HorizontalMode::writeToVerticalMode(tex::VListBuilder& output, HorizontalMo
   p.lineskiplimit = self.machine().memory().lineskiplimit;
   p.hsize = self.machine().memory().hsize;
   p.parshape = self.machine().memory().parshape;
+  p.arena = self.machine().arena();
+
+  self.hlist().finish();
   p.prepare(self.hlist().result);
-  tex::List l = p.create(self.hlist().result);
 
-  output.result.insert(output.result.end(), l.cbegin(), l.cend());
+  const auto& cache = self.machine().layoutCache();
+  tex::List l = cache ? cache->create(p, std::move(self.hlist().result)) : p.create(std::move(self.hlist().result));
+
+  output.result.splice(output.result.end(), l);
   output.prevdepth = p.prevdepth;
 }
 
@@ -50,7 +50,7 @@ public:
 
   Kind kind() const override;
   void write(tex::parsing::Token& t) override;
-  void write(std::shared_ptr<tex::ListBox> box);
+  void write(tex::NodeRef<tex::ListBox> box);
   void finish() override;
 
   tex::Font currentFont() const;
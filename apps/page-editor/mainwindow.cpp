@@ -19,6 +19,7 @@
 
 #include <QSplitter>
 
+#include <algorithm>
 #include <chrono>
 
 #include <QDebug>
@@ -43,6 +44,7 @@ MainWindow::MainWindow()
   setWindowTitle("Page Editor");
 
   m_engine = std::make_shared<TypesetEngine>(1.2f);
+  m_layout_cache = std::make_shared<tex::LayoutCache>();
 
   QWidget* content = new QWidget;
 
@@ -56,6 +58,7 @@ MainWindow::MainWindow()
   horizontal_splitter->addWidget(m_textedit);
 
   m_pagewidget = new PageWidget;
+  m_pagewidget->setTypesetEngine(m_engine);
   horizontal_splitter->addWidget(m_pagewidget);
 
   layout->addWidget(horizontal_splitter, 1);
@@ -107,9 +110,24 @@ void MainWindow::processText()
   if (text.empty())
     return;
 
-  TypesettingMachine machine{ m_engine, tex::Font(0) };
-  machine.memory().hsize = m_pagewidget->hsize();
-  auto box = machine.typeset(text);
+  tex::NodeRef<tex::VBox> box;
+
+  if (!m_machine || m_hsize != m_pagewidget->hsize())
+  {
+    m_hsize = m_pagewidget->hsize();
+    m_machine = std::make_unique<TypesettingMachine>(m_engine, tex::Font(0));
+    m_machine->memory().hsize = m_hsize;
+    m_machine->setLayoutCache(m_layout_cache);
+    m_text = text;
+    box = m_machine->typeset(std::move(text));
+  }
+  else
+  {
+    // Only the paragraphs from the first modified character onward are typeset again
+    const size_t offset = std::mismatch(m_text.begin(), m_text.end(), text.begin(), text.end()).first - m_text.begin();
+    m_text = text;
+    box = m_machine->retypeset(offset, std::move(text));
+  }
 
   auto end = std::chrono::high_resolution_clock::now();
 
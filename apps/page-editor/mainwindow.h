@@ -7,11 +7,20 @@
 
 #include <QMainWindow>
 
+#include <memory>
+#include <string>
+
 class QLabel;
 class QPlainTextEdit;
 
 class PageWidget;
 class TypesetEngine;
+class TypesettingMachine;
+
+namespace tex
+{
+class LayoutCache;
+} // namespace tex
 
 class MainWindow : public QMainWindow
 {
@@ -28,6 +37,10 @@ protected:
 
 private:
   std::shared_ptr<TypesetEngine> m_engine;
+  std::shared_ptr<tex::LayoutCache> m_layout_cache;
+  std::unique_ptr<TypesettingMachine> m_machine;
+  std::string m_text;
+  float m_hsize = 0.f;
   PageWidget* m_pagewidget;
   QPlainTextEdit* m_textedit;
   QLabel* m_status_widget;
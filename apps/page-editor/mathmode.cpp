@@ -98,6 +98,7 @@ void MathMode::writeToHorizontalMode(HorizontalMode& output, MathMode& self)
 {
   tex::MathTypesetter mt{ self.machine().typesetEngine() };
   mt.setFonts(self.m_fonts);
+  mt.setArena(self.machine().arena());
 
   tex::List hlist = mt.mlist2hlist(self.mlist(), tex::math::Style::T);
 
@@ -109,6 +110,7 @@ void MathMode::writeToVerticalMode(tex::VListBuilder& output, MathMode& self)
 {
   tex::MathTypesetter mt{ self.machine().typesetEngine() };
   mt.setFonts(self.m_fonts);
+  mt.setArena(self.machine().arena());
 
   tex::List hlist = mt.mlist2hlist(self.mlist(), tex::math::Style::D);
 
@@ -116,7 +118,7 @@ void MathMode::writeToVerticalMode(tex::VListBuilder& output, MathMode& self)
   hlist.insert(hlist.begin(), hfil);
   hlist.insert(hlist.end(), hfil);
 
-  std::shared_ptr<tex::HBox> box = tex::hbox(std::move(hlist), self.machine().memory().hsize);
+  tex::NodeRef<tex::HBox> box = tex::hbox(std::move(hlist), self.machine().memory().hsize);
 
   output.push_back(box);
 }
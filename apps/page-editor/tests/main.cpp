@@ -0,0 +1,16 @@
+// Copyright (C) 2020 Vincent Chambrin
+// This file is part of the 'typeset' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#define CATCH_CONFIG_RUNNER
+#include "catch.hpp"
+
+#include <QGuiApplication>
+
+int main(int argc, char *argv[])
+{
+  // The typeset engine loads its fonts through Qt
+  QGuiApplication app(argc, argv);
+
+  return Catch::Session().run(argc, argv);
+}
@@ -0,0 +1,122 @@
+// Copyright (C) 2020 Vincent Chambrin
+// This file is part of the 'typeset' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "catch.hpp"
+
+#include "typesetting-machine.h"
+
+#include <string>
+
+static std::string sample_text()
+{
+  const std::string par = "Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod tempor incididunt ut labore et dolore magna aliqua.";
+  std::string text;
+
+  for (int i(0); i < 8; ++i)
+  {
+    text += par;
+
+    if (i % 3 == 0)
+      text += " {\\def\\foo{bar}\\foo}";
+
+    text += "\n\n";
+  }
+
+  return text;
+}
+
+static bool same_layout(const tex::VBox& a, const tex::VBox& b)
+{
+  if (a.list().size() != b.list().size())
+    return false;
+
+  auto it = b.list().begin();
+
+  for (const tex::NodeRef<tex::Node>& n : a.list())
+  {
+    const tex::Node& m = **(it++);
+
+    if (n->kind() != m.kind())
+      return false;
+
+    if (n->isBox())
+    {
+      const tex::Box& x = n->as<tex::Box>();
+      const tex::Box& y = m.as<tex::Box>();
+
+      if (x.width() != y.width() || x.height() != y.height() || x.depth() != y.depth())
+        return false;
+    }
+    else if (n->isGlue() && n->as<tex::Glue>().space() != m.as<tex::Glue>().space())
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static tex::NodeRef<tex::VBox> typeset_from_scratch(const std::shared_ptr<TypesetEngine>& engine, std::string text)
+{
+  TypesettingMachine machine{ engine, tex::Font(0) };
+  machine.memory().hsize = 200.f;
+  return machine.typeset(std::move(text));
+}
+
+TEST_CASE("The machine resumes from the last snapshot before an edit", "[typesetting-machine]")
+{
+  auto engine = std::make_shared<TypesetEngine>();
+
+  TypesettingMachine machine{ engine, tex::Font(0) };
+  machine.memory().hsize = 200.f;
+
+  std::string text = sample_text();
+  tex::NodeRef<tex::VBox> box = machine.typeset(text);
+
+  REQUIRE(same_layout(*box, *typeset_from_scratch(engine, text)));
+
+  // A snapshot is taken at each paragraph boundary
+  const std::vector<TypesettingMachine::Snapshot> snapshots = machine.snapshots();
+  REQUIRE(snapshots.size() > 4);
+
+  const size_t offset = snapshots.at(3).position + 6;
+  text.insert(offset, "foo bar ");
+
+  const std::shared_ptr<tex::NodeArena> arena = machine.arena();
+  box = machine.retypeset(offset, text);
+
+  REQUIRE(same_layout(*box, *typeset_from_scratch(engine, text)));
+
+  // The snapshots before the edit are kept, and the nodes that are typeset
+  // again do not go to the arena of the dropped ones
+  REQUIRE(machine.snapshots().size() >= 4);
+  REQUIRE(machine.snapshots().at(3).position == snapshots.at(3).position);
+  REQUIRE(machine.snapshots().at(3).vlist_length == snapshots.at(3).vlist_length);
+  REQUIRE(machine.arena() != arena);
+
+  // Editing the same paragraph again restores the same snapshot
+  text.insert(offset, "baz ");
+  box = machine.retypeset(offset, text);
+
+  REQUIRE(same_layout(*box, *typeset_from_scratch(engine, text)));
+}
+
+TEST_CASE("The machine can typeset several texts", "[typesetting-machine]")
+{
+  auto engine = std::make_shared<TypesetEngine>();
+
+  TypesettingMachine machine{ engine, tex::Font(0) };
+  machine.memory().hsize = 200.f;
+
+  // Stop in the middle of a group and of a macro definition
+  machine.typeset("{\\def\\foo{bar}\\foo\n\n\\def\\baz#1{");
+
+  const std::string text = sample_text();
+  tex::NodeRef<tex::VBox> box = machine.typeset(text);
+
+  REQUIRE(same_layout(*box, *typeset_from_scratch(engine, text)));
+  REQUIRE(machine.snapshots().front().position == 0);
+  REQUIRE(machine.snapshots().front().vlist_length == 0);
+  REQUIRE(machine.snapshots().front().groups.empty());
+}
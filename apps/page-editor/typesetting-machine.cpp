@@ -48,9 +48,9 @@ TypesettingMachine::TypesettingMachine(std::shared_ptr<TypesetEngine> te, tex::F
   m_inputstream{},
   m_preprocessor{},
   m_assignment_processor{*this},
-  m_typeset_engine(te)
+  m_typeset_engine(te),
+  m_arena(std::make_shared<tex::NodeArena>())
 {
-  m_memory.emplace_back();
   memory().font = f;
   memory().catcodes = m_lexer.catcodes();
   memory().hsize = 800.f;
@@ -68,16 +68,44 @@ TypesettingMachine::TypesettingMachine(std::shared_ptr<TypesetEngine> te, tex::F
   enter<VerticalMode>();
 }
 
-std::shared_ptr<tex::VBox> TypesettingMachine::typeset(std::string text)
+// Typesets a new text.
+// A machine that already typeset a text is first restored to the state it
+// was in before that text, which is its first snapshot; settings made
+// through memory() before the first call are therefore kept.
+tex::NodeRef<tex::VBox> TypesettingMachine::typeset(std::string text)
 {
+  if (!m_snapshots.empty())
+    restore(m_snapshots.front());
+
   m_inputstream = InputStream(std::move(text));
 
+  m_snapshots.clear();
+  takeSnapshot();
+
   m_state = State::ReadChar;
-  resume();
+  return run();
+}
 
-  VerticalMode& vm = dynamic_cast<VerticalMode&>(currentMode());
-  tex::List vlist = vm.vlist().result;
-  return tex::vbox(std::move(vlist));
+// Typesets an edited version of the text given to the last call to typeset(),
+// edit_offset being the position of the first character that differs.
+// The machine is restored to the last paragraph boundary before the edit and
+// only the text that follows is processed again.
+tex::NodeRef<tex::VBox> TypesettingMachine::retypeset(size_t edit_offset, std::string text)
+{
+  while (!m_snapshots.empty() && m_snapshots.back().position > edit_offset)
+    m_snapshots.pop_back();
+
+  if (m_snapshots.empty())
+    return typeset(std::move(text));
+
+  restore(m_snapshots.back());
+
+  const size_t position = m_snapshots.back().position;
+  m_inputstream = InputStream(std::move(text));
+  m_inputstream.pos = position;
+
+  m_state = State::ReadChar;
+  return run();
 }
 
 tex::UnitSystem TypesettingMachine::unitSystem() const
@@ -90,16 +118,26 @@ tex::UnitSystem TypesettingMachine::unitSystem() const
   return us;
 }
 
+// Groups only record the fields assigned with assign() and the macros
+// defined inside them, TeX's save stack, instead of copying the memory
 void TypesettingMachine::beginGroup()
 {
   m_preprocessor.beginGroup();
-  m_memory.emplace_back();
-  m_memory.back() = m_memory.at(m_memory.size() - 2);
+  m_groups.push_back(m_save_stack.size());
 }
 
 void TypesettingMachine::endGroup()
 {
-  m_memory.pop_back();
+  const size_t begin = m_groups.back();
+  m_groups.pop_back();
+
+  while (m_save_stack.size() > begin)
+  {
+    m_save_stack.back().restore();
+    m_save_levels[m_save_stack.back().field] = m_save_stack.back().level;
+    m_save_stack.pop_back();
+  }
+
   m_preprocessor.endGroup();
 }
 
@@ -154,6 +192,85 @@ void TypesettingMachine::resume()
   }
 }
 
+tex::NodeRef<tex::VBox> TypesettingMachine::run()
+{
+  VerticalMode& vm = dynamic_cast<VerticalMode&>(*m_modes.front());
+
+  while (state() != TypesettingMachine::Idle)
+  {
+    advance();
+
+    if (vm.vlist().result.size() > m_snapshots.back().vlist_length && atParagraphBoundary())
+      takeSnapshot();
+  }
+
+  tex::List vlist = vm.vlist().result;
+  return tex::vbox(std::move(vlist));
+}
+
+// Returns whether the machine is waiting for input in the outer vertical mode;
+// the only state that is kept at this point is the one saved in a Snapshot:
+// no token is pending and neither the preprocessor nor the modes are in the
+// middle of a command.
+bool TypesettingMachine::atParagraphBoundary() const
+{
+  return state() == State::ReadChar
+    && m_modes.size() == 1
+    && dynamic_cast<const VerticalMode&>(*m_modes.front()).isIdle()
+    && m_tokens.empty()
+    && m_lexer.output().empty()
+    && m_preprocessor.input.empty()
+    && m_preprocessor.output.empty()
+    && m_preprocessor.state().frames.size() == 1
+    && m_assignment_processor.state() == AssignmentProcessor::State::Main;
+}
+
+void TypesettingMachine::takeSnapshot()
+{
+  VerticalMode& vm = dynamic_cast<VerticalMode&>(*m_modes.front());
+
+  Snapshot snapshot;
+  snapshot.position = m_inputstream.pos;
+  snapshot.lexer = m_lexer;
+  snapshot.macros = m_preprocessor.definitions();
+  snapshot.fonts = m_assignment_processor.fonts();
+  snapshot.memory = m_memory;
+  snapshot.savestack = m_save_stack;
+  snapshot.levels = m_save_levels;
+  snapshot.groups = m_groups;
+  snapshot.vlist_length = vm.vlist().result.size();
+  snapshot.prevdepth = vm.vlist().prevdepth;
+
+  m_snapshots.push_back(std::move(snapshot));
+}
+
+// Restores the machine to the state saved in a snapshot.
+// Nodes appended to the outer vertical list after the snapshot are dropped;
+// the input stream is left unchanged.
+// The nodes created from now on go to a new arena: the current one holds
+// the dropped nodes and is released along with the last of its nodes, so
+// that memory does not grow with each edit.
+void TypesettingMachine::restore(const Snapshot& snapshot)
+{
+  VerticalMode& vm = dynamic_cast<VerticalMode&>(*m_modes.front());
+
+  m_lexer = snapshot.lexer;
+  m_preprocessor.reset(snapshot.macros);
+  m_assignment_processor.reset(snapshot.fonts);
+  m_memory = snapshot.memory;
+  m_save_stack = snapshot.savestack;
+  m_save_levels = snapshot.levels;
+  m_groups = snapshot.groups;
+  m_tokens.clear();
+  m_leave_current_mode = false;
+  m_modes.resize(1);
+  m_state = State::Idle;
+
+  m_arena = std::make_shared<tex::NodeArena>();
+  vm.vlist().arena = m_arena;
+  vm.restore(snapshot.vlist_length, snapshot.prevdepth);
+}
+
 void TypesettingMachine::advance()
 {
   try
@@ -14,11 +14,15 @@
 #include "tex/parsing/preprocessor.h"
 #include "tex/lexer.h"
 
+#include "tex/layoutcache.h"
+#include "tex/nodearena.h"
 #include "tex/parshape.h"
 #include "tex/typeset.h"
 #include "tex/units.h"
 #include "tex/vbox.h"
 
+#include <functional>
+#include <map>
 #include <memory>
 #include <vector>
 
@@ -27,13 +31,37 @@ struct TypesettingMachineMemory
   tex::parsing::Lexer::CatCodeTable catcodes;
   tex::Font font;
   float prevdepth = -10000.f;
-  std::shared_ptr<tex::Glue> baselineskip;
-  std::shared_ptr<tex::Glue> lineskip;
+  tex::NodeRef<tex::Glue> baselineskip;
+  tex::NodeRef<tex::Glue> lineskip;
   float lineskiplimit = 0.f;
   float hsize;
   tex::Parshape parshape;
 };
 
+// A field of the memory assigned inside a group, the group level at which
+// it was previously assigned, and how to restore its value from before the group
+struct TypesettingMachineSavedValue
+{
+  const void* field;
+  size_t level;
+  std::function<void()> restore;
+};
+
+// The state of the machine between two paragraphs of the outer vertical list
+struct TypesettingMachineSnapshot
+{
+  size_t position;
+  tex::parsing::Lexer lexer;
+  tex::parsing::Preprocessor::Definitions macros;
+  std::map<std::string, tex::Font> fonts;
+  TypesettingMachineMemory memory;
+  std::vector<TypesettingMachineSavedValue> savestack;
+  std::map<const void*, size_t> levels;
+  std::vector<size_t> groups;
+  size_t vlist_length;
+  float prevdepth;
+};
+
 class TypesettingException : public std::runtime_error
 {
 public:
@@ -63,14 +91,25 @@ public:
 
   State state() const;
 
-  std::shared_ptr<tex::VBox> typeset(std::string text);
+  tex::NodeRef<tex::VBox> typeset(std::string text);
+  tex::NodeRef<tex::VBox> retypeset(size_t edit_offset, std::string text);
+
+  typedef TypesettingMachineSnapshot Snapshot;
+  const std::vector<Snapshot>& snapshots() const;
 
   const std::shared_ptr<TypesetEngine>& typesetEngine() const;
+  const std::shared_ptr<tex::NodeArena>& arena() const;
+
+  const std::shared_ptr<tex::LayoutCache>& layoutCache() const;
+  void setLayoutCache(std::shared_ptr<tex::LayoutCache> cache);
 
   typedef TypesettingMachineMemory Memory;
   Memory& memory();
   const Memory& memory() const;
 
+  template<typename T>
+  void assign(T Memory::*field, T value);
+
   InputStream& inputStream();
   tex::parsing::Lexer& lexer();
   tex::parsing::Preprocessor& preprocessor();
@@ -100,8 +139,16 @@ protected:
   void sendToken();
   bool digestToken();
 
+  tex::NodeRef<tex::VBox> run();
+  bool atParagraphBoundary() const;
+  void takeSnapshot();
+  void restore(const Snapshot& snapshot);
+
 private:
-  std::vector<Memory> m_memory;
+  Memory m_memory;
+  std::vector<TypesettingMachineSavedValue> m_save_stack;
+  std::map<const void*, size_t> m_save_levels;
+  std::vector<size_t> m_groups;
   InputStream m_inputstream;
   tex::parsing::Lexer m_lexer;
   tex::parsing::Preprocessor m_preprocessor;
@@ -110,7 +157,10 @@ private:
   std::vector<std::unique_ptr<Mode>> m_modes;
   bool m_leave_current_mode = false;
   std::shared_ptr<TypesetEngine> m_typeset_engine;
+  std::shared_ptr<tex::NodeArena> m_arena;
+  std::shared_ptr<tex::LayoutCache> m_layout_cache;
   State m_state = State::Idle;
+  std::vector<Snapshot> m_snapshots;
 };
 
 inline TypesettingMachine::State TypesettingMachine::state() const
@@ -123,14 +173,62 @@ inline const std::shared_ptr<TypesetEngine>& TypesettingMachine::typesetEngine()
   return m_typeset_engine;
 }
 
+inline const std::shared_ptr<tex::NodeArena>& TypesettingMachine::arena() const
+{
+  return m_arena;
+}
+
+inline const std::vector<TypesettingMachine::Snapshot>& TypesettingMachine::snapshots() const
+{
+  return m_snapshots;
+}
+
+inline const std::shared_ptr<tex::LayoutCache>& TypesettingMachine::layoutCache() const
+{
+  return m_layout_cache;
+}
+
+inline void TypesettingMachine::setLayoutCache(std::shared_ptr<tex::LayoutCache> cache)
+{
+  m_layout_cache = std::move(cache);
+}
+
 inline TypesettingMachine::Memory& TypesettingMachine::memory()
 {
-  return m_memory.back();
+  return m_memory;
 }
 
 inline const TypesettingMachine::Memory& TypesettingMachine::memory() const
 {
-  return m_memory.back();
+  return m_memory;
+}
+
+// Assigns a field of the memory, saving its previous value the first time
+// it is assigned in the current group so that endGroup() can restore it.
+// As in TeX, the group level at which each field was last assigned is
+// recorded, so that this check does not scan the save stack.
+// Fields written through memory() are not restored.
+template<typename T>
+inline void TypesettingMachine::assign(T Memory::*field, T value)
+{
+  T& current = m_memory.*field;
+  const size_t level = m_groups.size();
+
+  if (level > 0)
+  {
+    size_t& assigned_at = m_save_levels[&current];
+
+    if (assigned_at != level)
+    {
+      m_save_stack.push_back(TypesettingMachineSavedValue{ &current, assigned_at, [&current, old = current]() {
+        current = old;
+        } });
+
+      assigned_at = level;
+    }
+  }
+
+  current = std::move(value);
 }
 
 inline InputStream& TypesettingMachine::inputStream()
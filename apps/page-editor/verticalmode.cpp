@@ -13,6 +13,7 @@ VerticalMode::VerticalMode(TypesettingMachine& m)
     m_vlist{ m.memory().baselineskip, m.memory().lineskip }
 {
   m_vlist.lineskiplimit = m.memory().lineskiplimit;
+  m_vlist.arena = m.arena();
 }
 
 Mode::Kind VerticalMode::kind() const
@@ -65,6 +66,19 @@ tex::VListBuilder& VerticalMode::vlist()
   return m_vlist;
 }
 
+bool VerticalMode::isIdle() const
+{
+  return m_state == State::Main;
+}
+
+void VerticalMode::restore(size_t length, float prevdepth)
+{
+  m_state = State::Main;
+  m_kern_parser.reset();
+  m_vlist.result.erase(std::next(m_vlist.result.begin(), length), m_vlist.result.end());
+  m_vlist.prevdepth = prevdepth;
+}
+
 void VerticalMode::write_main(tex::parsing::Token& t)
 {
   if (t.isControlSequence())
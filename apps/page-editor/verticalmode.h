@@ -46,6 +46,9 @@ public:
 
   tex::VListBuilder& vlist();
 
+  bool isIdle() const;
+  void restore(size_t length, float prevdepth);
+
 protected:
   void write_main(tex::parsing::Token&);
   void write_kern(tex::parsing::Token& t);
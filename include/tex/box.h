@@ -25,8 +25,6 @@ public:
   explicit Box(const BoxMetrics& metrics);
   Box(float h, float d, float w);
 
-  bool isBox() const override;
-
   float height() const { return m_height; }
   float depth() const { return m_depth; }
   float width() const { return m_width; }
@@ -39,6 +37,10 @@ public:
   BoxMetrics metrics() const { return BoxMetrics{ height(), depth(), width() }; }
 
 protected:
+  explicit Box(NodeKind k);
+  Box(NodeKind k, const BoxMetrics& metrics);
+  Box(NodeKind k, float h, float d, float w);
+
   void setHeight(float h);
   void setDepth(float d);
   void setWidth(float w);
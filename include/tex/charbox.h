@@ -20,7 +20,7 @@ private:
 
 public:
   CharacterBox(Character c, Font f, const BoxMetrics& metrics)
-    : Box(metrics),
+    : Box(NodeKind::CharacterBox, metrics),
       m_char(c),
       m_font(f)
   {
@@ -29,8 +29,6 @@ public:
 
   Character character() const { return m_char; }
   Font font() const { return m_font; }
-
-  bool isCharacterBox() const override { return true; }
 };
 
 } // namespace tex
@@ -0,0 +1,70 @@
+// Copyright (C) 2020 Vincent Chambrin
+// This file is part of the 'typeset' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#ifndef LIBTYPESET_COLUMNBALANCER_H
+#define LIBTYPESET_COLUMNBALANCER_H
+
+#include "tex/scaled.h"
+#include "tex/vbox.h"
+
+#include <vector>
+
+namespace tex
+{
+
+class NodeArena;
+
+/*!
+ * \class ColumnBalancer
+ * \brief Splits a vertical list into columns of equal height
+ *
+ * The natural height of every prefix of the list is computed once;
+ * the height of a column is then the difference of two prefix sums, and
+ * the furthest place a column of a given height can end is found by binary
+ * search. The smallest height for which the list fits in the columns is
+ * found by a binary search on the heights at which columns reach a
+ * breakpoint, so that no box is built before the columns are known.
+ *
+ * As with the page builder, columns may end at glue that follows a box,
+ * at a kern followed by glue, or at a penalty; they must end at forced breaks
+ * and discardable nodes are removed at the top of a column.
+ */
+class LIBTYPESET_API ColumnBalancer
+{
+public:
+  std::shared_ptr<NodeArena> arena;
+
+public:
+  explicit ColumnBalancer(const List& vlist);
+  ColumnBalancer(const ColumnBalancer&) = delete;
+  ~ColumnBalancer();
+
+  size_t size() const { return m_nodes.size(); }
+
+  float computeHeight(size_t columns) const;
+  std::vector<size_t> computeBreaks(size_t columns, float height) const;
+  float columnHeight(size_t begin, size_t end) const;
+
+  std::vector<NodeRef<VBox>> balance(size_t columns);
+
+  ColumnBalancer& operator=(const ColumnBalancer&) = delete;
+
+protected:
+  Dimension minimalHeight(size_t columns) const;
+  void candidates(size_t begin, size_t& first, size_t& last) const;
+  bool fill(size_t columns, Dimension height, std::vector<size_t>* breaks) const;
+
+private:
+  std::vector<NodeRef<Node>> m_nodes;
+  std::vector<Dimension> m_heights;
+  std::vector<Dimension> m_depths;
+  std::vector<size_t> m_breaks;
+  std::vector<Dimension> m_reach;
+  std::vector<size_t> m_forced;
+  std::vector<size_t> m_starts;
+};
+
+} // namespace tex
+
+#endif // LIBTYPESET_COLUMNBALANCER_H
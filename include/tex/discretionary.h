@@ -0,0 +1,54 @@
+// Copyright (C) 2020 Vincent Chambrin
+// This file is part of the 'typeset' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#ifndef LIBTYPESET_DISCRETIONARY_H
+#define LIBTYPESET_DISCRETIONARY_H
+
+#include "tex/listbox.h"
+
+namespace tex
+{
+
+/*!
+ * \class Discretionary
+ * \brief A place where a line may be broken with special material around the break
+ *
+ * As TeX's \discretionary{pre}{post}{nobreak}: if the paragraph is broken
+ * at this node, the pre-break list ends the line and the post-break list starts
+ * the next one; otherwise the no-break list is used.
+ *
+ * The lists should only contain boxes and kerns.
+ */
+class LIBTYPESET_API Discretionary final : public Node
+{
+public:
+  Discretionary(List prebreak, List postbreak, List nobreak);
+  ~Discretionary() = default;
+
+  const List& prebreak() const { return m_prebreak; }
+  const List& postbreak() const { return m_postbreak; }
+  const List& nobreak() const { return m_nobreak; }
+
+  float prebreakWidth() const { return m_prebreak_width; }
+  float postbreakWidth() const { return m_postbreak_width; }
+  float nobreakWidth() const { return m_nobreak_width; }
+  float nobreakHeight() const { return m_nobreak_height; }
+  float nobreakDepth() const { return m_nobreak_depth; }
+
+private:
+  List m_prebreak;
+  List m_postbreak;
+  List m_nobreak;
+  float m_prebreak_width;
+  float m_postbreak_width;
+  float m_nobreak_width;
+  float m_nobreak_height;
+  float m_nobreak_depth;
+};
+
+LIBTYPESET_API NodeRef<Discretionary> discretionary(List prebreak, List postbreak = {}, List nobreak = {});
+
+} // namespace tex
+
+#endif // LIBTYPESET_DISCRETIONARY_H
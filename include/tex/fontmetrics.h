@@ -22,8 +22,8 @@ public:
   virtual ~FontMetricsProvider() = default;
 
   virtual BoxMetrics metrics(tex::Character c, tex::Font font) = 0;
-  virtual BoxMetrics metrics(const std::shared_ptr<tex::Symbol> & symbol, tex::Font font) = 0;
-  virtual float italicCorrection(const std::shared_ptr<tex::Symbol> & symbol, tex::Font font) = 0;
+  virtual BoxMetrics metrics(const NodeRef<tex::Symbol> & symbol, tex::Font font) = 0;
+  virtual float italicCorrection(const NodeRef<tex::Symbol> & symbol, tex::Font font) = 0;
   virtual int sfcode(tex::Character c);
 
   virtual const FontDimen& fontdimen(Font font) = 0;
@@ -74,8 +74,8 @@ public:
   inline const std::shared_ptr<FontMetricsProvider> & metricsProvider() const { return mMetricsProvider; }
 
   BoxMetrics metrics(tex::Character c) const;
-  BoxMetrics metrics(const std::shared_ptr<tex::Symbol> & symbol) const;
-  float italicCorrection(const std::shared_ptr<tex::Symbol> & symbol) const;
+  BoxMetrics metrics(const NodeRef<tex::Symbol> & symbol) const;
+  float italicCorrection(const NodeRef<tex::Symbol> & symbol) const;
 
   const FontDimen& fontdimen() const;
 
@@ -125,12 +125,12 @@ private:
   GlueSpec m_spec;
 };
 
-LIBTYPESET_API std::shared_ptr<Glue> glue(float space);
-LIBTYPESET_API std::shared_ptr<Glue> glue(float space, const Shrink & shrink);
-LIBTYPESET_API std::shared_ptr<Glue> glue(float space, const Stretch & stretch);
-LIBTYPESET_API std::shared_ptr<Glue> glue(float space, const Stretch & stretch, const Shrink & shrink);
-LIBTYPESET_API std::shared_ptr<Glue> glue(float space, const Shrink & shrink, const Stretch & stretch);
-LIBTYPESET_API std::shared_ptr<Glue> glue(GlueSpec spec, GlueOrigin origin = GlueOrigin::normal);
+LIBTYPESET_API NodeRef<Glue> glue(float space);
+LIBTYPESET_API NodeRef<Glue> glue(float space, const Shrink & shrink);
+LIBTYPESET_API NodeRef<Glue> glue(float space, const Stretch & stretch);
+LIBTYPESET_API NodeRef<Glue> glue(float space, const Stretch & stretch, const Shrink & shrink);
+LIBTYPESET_API NodeRef<Glue> glue(float space, const Shrink & shrink, const Stretch & stretch);
+LIBTYPESET_API NodeRef<Glue> glue(GlueSpec spec, GlueOrigin origin = GlueOrigin::normal);
 
 } // namespace tex
 
@@ -0,0 +1,63 @@
+// Copyright (C) 2020 Vincent Chambrin
+// This file is part of the 'typeset' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#ifndef LIBTYPESET_GLUECACHE_H
+#define LIBTYPESET_GLUECACHE_H
+
+#include "tex/font.h"
+#include "tex/noderef.h"
+
+#include <memory>
+#include <vector>
+
+namespace tex
+{
+
+class FontMetricsProvider;
+class Glue;
+
+/*!
+ * \class InterwordGlueCache
+ * \brief Interns the interword glue of each (font, spacefactor) pair
+ *
+ * The glue returned by get() is shared by every list it is inserted in and
+ * must therefore never be modified.
+ * A TypesetEngine owns a cache that is shared by the lists built with it
+ * (see TypesetEngine::interwordGlueCache()).
+ *
+ * Each lookup compares the interword parameters of the font's FontDimen with
+ * the ones the cached glues were computed from; the glues of a font are
+ * recomputed whenever these parameters change.
+ */
+class LIBTYPESET_API InterwordGlueCache
+{
+public:
+  explicit InterwordGlueCache(std::shared_ptr<FontMetricsProvider> metrics);
+  InterwordGlueCache(const InterwordGlueCache &) = delete;
+  ~InterwordGlueCache();
+
+  const std::shared_ptr<FontMetricsProvider>& metrics() const { return m_metrics; }
+
+  NodeRef<const Glue> get(Font font, int spacefactor);
+
+  void invalidate(Font font);
+  void clear();
+
+  size_t size() const;
+
+  InterwordGlueCache & operator=(const InterwordGlueCache &) = delete;
+
+private:
+  struct FontEntry;
+  FontEntry& fontEntry(Font font);
+
+private:
+  std::shared_ptr<FontMetricsProvider> m_metrics;
+  std::vector<FontEntry> m_fonts;
+  size_t m_last = 0;
+};
+
+} // namespace tex
+
+#endif // LIBTYPESET_GLUECACHE_H
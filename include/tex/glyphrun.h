@@ -0,0 +1,64 @@
+// Copyright (C) 2020 Vincent Chambrin
+// This file is part of the 'typeset' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#ifndef LIBTYPESET_GLYPHRUN_H
+#define LIBTYPESET_GLYPHRUN_H
+
+#include "tex/box.h"
+#include "tex/font.h"
+#include "tex/smallvector.h"
+#include "tex/unicode.h"
+
+namespace tex
+{
+
+class NodeArena;
+
+/*!
+ * \class GlyphRun
+ * \brief A box made of a sequence of glyphs of the same font
+ *
+ * A glyph run replaces a sequence of character boxes: the codepoints and
+ * advances of the glyphs are stored contiguously and the box has the
+ * aggregate width, height and depth of the glyphs.
+ */
+class LIBTYPESET_API GlyphRun : public Box
+{
+public:
+  static constexpr size_t InlineCapacity = 8;
+
+  explicit GlyphRun(Font f);
+  ~GlyphRun() = default;
+
+  Font font() const { return m_font; }
+
+  size_t size() const { return m_codepoints.size(); }
+  bool empty() const { return m_codepoints.empty(); }
+
+  Character character(size_t i) const { return m_codepoints[i]; }
+  float advance(size_t i) const { return m_advances[i]; }
+  float height(size_t i) const { return m_heights[i]; }
+  float depth(size_t i) const { return m_depths[i]; }
+
+  const SmallVector<Character, InlineCapacity>& characters() const { return m_codepoints; }
+  const SmallVector<float, InlineCapacity>& advances() const { return m_advances; }
+
+  using Box::height;
+  using Box::depth;
+
+  void push_back(Character c, const BoxMetrics& metrics);
+
+  NodeRef<GlyphRun> slice(size_t begin, size_t end, NodeArena* arena = nullptr) const;
+
+private:
+  Font m_font;
+  SmallVector<Character, InlineCapacity> m_codepoints;
+  SmallVector<float, InlineCapacity> m_advances;
+  SmallVector<float, InlineCapacity> m_heights;
+  SmallVector<float, InlineCapacity> m_depths;
+};
+
+} // namespace tex
+
+#endif // LIBTYPESET_GLYPHRUN_H
@@ -15,27 +15,31 @@ class LIBTYPESET_API HBox final : public ListBox
 public:
   HBox(List && list);
   HBox(List && list, float desiredWidth);
+  HBox(List && list, float desiredWidth, const BoxingInfo& info);
+  HBox(ChildList && list, float desiredWidth, const BoxingInfo& info);
   ~HBox() = default;
 
   void getBoxingInfo(float *width, float *height, float *depth, GlueShrink *shrink, GlueStretch *stretch) const;
+  BoxingInfo getBoxingInfo() const;
 
-  bool isHBox() const override;
+  static void accumulate(BoxingInfo& info, const Node& node);
 
 protected:
   friend class HBoxEditor;
 
   void rebox();
   BoxingResult rebox(float desiredWidth);
+  BoxingResult rebox(float desiredWidth, const BoxingInfo& info);
 };
 
-LIBTYPESET_API std::shared_ptr<HBox> hbox(List && hlist);
-LIBTYPESET_API std::shared_ptr<HBox> hbox(std::initializer_list<std::shared_ptr<Node>> && nodes);
-LIBTYPESET_API std::shared_ptr<HBox> hbox(List && hlist, float w);
+LIBTYPESET_API NodeRef<HBox> hbox(List && hlist);
+LIBTYPESET_API NodeRef<HBox> hbox(std::initializer_list<NodeRef<Node>> && nodes);
+LIBTYPESET_API NodeRef<HBox> hbox(List && hlist, float w);
 
-LIBTYPESET_API void raise(std::shared_ptr<HBox> box, float amount);
-LIBTYPESET_API void lower(std::shared_ptr<HBox> box, float amount);
+LIBTYPESET_API void raise(NodeRef<HBox> box, float amount);
+LIBTYPESET_API void lower(NodeRef<HBox> box, float amount);
 
-class LIBTYPESET_API HBoxEditor final
+class LIBTYPESET_API HBoxEditor final : public ListBoxEditor
 {
 private:
   bool mReboxDone;
@@ -44,8 +48,6 @@ public:
   HBoxEditor(HBox & box);
   ~HBoxEditor();
 
-  List & list();
-
   void rebox();
   BoxingResult rebox(float desiredWidth);
 };
@@ -12,7 +12,11 @@
 namespace tex
 {
 
+class GlyphRun;
+class Hyphenator;
+class InterwordGlueCache;
 class Kern;
+class NodeArena;
 class TypesetEngine;
 
 class LIBTYPESET_API HListBuilder
@@ -22,14 +26,28 @@ public:
   std::shared_ptr<TypesetEngine> typeset;
   tex::Font font;
   int spacefactor = 1000;
+  std::shared_ptr<NodeArena> arena;
+  std::shared_ptr<InterwordGlueCache> gluecache;
+  bool glyphruns = true;
+  std::shared_ptr<Hyphenator> hyphenator;
+  tex::Character hyphenchar = '-';
 
   explicit HListBuilder(std::shared_ptr<TypesetEngine> e, tex::Font f = tex::Font(0));
 
   void push_back(tex::Character c);
   void push_back_interword_glue();
-  void push_back(std::shared_ptr<tex::Box> b);
-  void push_back(std::shared_ptr<tex::Glue> g);
-  void push_back(std::shared_ptr<tex::Kern> k);
+  void push_back(NodeRef<tex::Box> b);
+  void push_back(NodeRef<tex::Glue> g);
+  void push_back(NodeRef<tex::Kern> k);
+
+  void finish();
+
+protected:
+  void hyphenate();
+  NodeRef<tex::Node> hyphen(tex::Font f);
+
+private:
+  NodeRef<tex::GlyphRun> m_glyphrun;
 };
 
 } // namespace tex
@@ -0,0 +1,85 @@
+// Copyright (C) 2020 Vincent Chambrin
+// This file is part of the 'typeset' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#ifndef LIBTYPESET_HLISTVIEW_H
+#define LIBTYPESET_HLISTVIEW_H
+
+#include "tex/listbox.h"
+
+#include <array>
+#include <vector>
+
+namespace tex
+{
+
+/*!
+ * \class HListView
+ * \brief A flat, read-only description of a horizontal list
+ *
+ * The view stores the properties of the nodes that matter for boxing and
+ * linebreaking in contiguous arrays (structure of arrays), so that these
+ * algorithms can work on indices instead of walking the linked list.
+ *
+ * The view does not own the nodes; it must not outlive the list it was
+ * built from, and is invalidated by any modification of that list.
+ *
+ * Paragraph boxes its lines with getBoxingInfo(). HBox::getBoxingInfo()
+ * does not build a view: it returns the totals cached by the box (see
+ * ListBox::totals()), which are computed in a single walk of its contiguous
+ * children, so a view would only add a copy. VBox::getBoxingInfo() stacks
+ * the heights and depths of a vertical list and has no use for this view.
+ */
+class LIBTYPESET_API HListView
+{
+public:
+  explicit HListView(const List& hlist);
+  HListView(List::const_iterator begin, List::const_iterator end);
+  ~HListView() = default;
+
+  size_t size() const { return m_kinds.size(); }
+  bool empty() const { return m_kinds.empty(); }
+
+  NodeKind kind(size_t i) const { return m_kinds[i]; }
+  bool isBox(size_t i) const { return NodeKind::Box <= kind(i) && kind(i) <= NodeKind::VBox; }
+  bool isGlue(size_t i) const { return kind(i) == NodeKind::Glue; }
+  bool isKern(size_t i) const { return kind(i) == NodeKind::Kern; }
+  bool isPenalty(size_t i) const { return kind(i) == NodeKind::Penalty; }
+  bool isDiscretionary(size_t i) const { return kind(i) == NodeKind::Discretionary; }
+
+  float width(size_t i) const { return m_widths[i]; }
+  float height(size_t i) const { return m_heights[i]; }
+  float depth(size_t i) const { return m_depths[i]; }
+  float stretch(size_t i, GlueOrder order) const { return m_stretch[static_cast<size_t>(order)][i]; }
+  float shrink(size_t i, GlueOrder order) const { return m_shrink[static_cast<size_t>(order)][i]; }
+  int penalty(size_t i) const { return m_penalties[i]; }
+
+  const float* widths() const { return m_widths.data(); }
+  const float* stretches(GlueOrder order) const { return m_stretch[static_cast<size_t>(order)].data(); }
+  const float* shrinks(GlueOrder order) const { return m_shrink[static_cast<size_t>(order)].data(); }
+
+  /// Returns the position of the i-th node; \c position(size()) is the end of the viewed range.
+  const List::const_iterator& position(size_t i) const { return m_positions[i]; }
+  const Node& node(size_t i) const { return **m_positions[i]; }
+
+  void accumulate(size_t i, GlueShrink& shrink, GlueStretch& stretch) const;
+
+  void getBoxingInfo(size_t begin, size_t end, BoxingInfo& info) const;
+
+protected:
+  void append(List::const_iterator it);
+
+private:
+  std::vector<NodeKind> m_kinds;
+  std::vector<float> m_widths;
+  std::vector<float> m_heights;
+  std::vector<float> m_depths;
+  std::array<std::vector<float>, 4> m_stretch;
+  std::array<std::vector<float>, 4> m_shrink;
+  std::vector<int> m_penalties;
+  std::vector<List::const_iterator> m_positions;
+};
+
+} // namespace tex
+
+#endif // LIBTYPESET_HLISTVIEW_H
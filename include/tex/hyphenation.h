@@ -0,0 +1,96 @@
+// Copyright (C) 2020 Vincent Chambrin
+// This file is part of the 'typeset' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#ifndef LIBTYPESET_HYPHENATION_H
+#define LIBTYPESET_HYPHENATION_H
+
+#include "tex/defs.h"
+#include "tex/unicode.h"
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace tex
+{
+
+/*!
+ * \class Hyphenator
+ * \brief Finds the hyphenation points of words with Liang's algorithm
+ *
+ * Patterns are given in the format of TeX's \c \\patterns (e.g. \c ".hy3p"
+ * or \c "4m1p"), exceptions in the format of \c \\hyphenation
+ * (e.g. \c "ta-ble").
+ * The patterns are stored in a packed trie: the children of a node are
+ * contiguous and sorted, and the nodes are laid out in breadth-first order
+ * so that a lookup mostly reads neighbouring memory.
+ *
+ * The hyphenation points of a word are cached, so that hyphenate() is
+ * cheap for words that were already seen. hyphenate() may be called
+ * concurrently, but not while patterns or exceptions are being added.
+ */
+class LIBTYPESET_API Hyphenator
+{
+public:
+  int lefthyphenmin = 2;
+  int righthyphenmin = 3;
+
+  Hyphenator();
+  Hyphenator(const Hyphenator&) = delete;
+  ~Hyphenator();
+
+  void load(const std::string& path);
+
+  void addPatterns(const std::string& patterns);
+  void addException(const std::string& word);
+
+  size_t patternCount() const { return m_patterns.size(); }
+  size_t trieSize() const { return m_nodes.size(); }
+
+  std::vector<size_t> hyphenate(const std::u32string& word) const;
+  std::vector<size_t> hyphenate(const std::string& word) const;
+
+  size_t cacheSize() const;
+  void clearCache();
+
+  static bool isLetter(Character c);
+
+  Hyphenator& operator=(const Hyphenator&) = delete;
+
+protected:
+  void parse(const char* begin, const char* end);
+  void addPattern(const char* begin, const char* end);
+  void addException(const char* begin, const char* end);
+  void pack();
+
+  std::vector<size_t> compute(const std::u32string& word) const;
+
+  static char32_t lowercase(char32_t c);
+
+private:
+  struct PackedNode
+  {
+    uint32_t children;
+    uint32_t child_count;
+    uint32_t values;
+    uint32_t value_count;
+  };
+
+  std::map<std::u32string, std::vector<uint8_t>> m_patterns;
+  std::unordered_map<std::u32string, std::vector<size_t>> m_exceptions;
+
+  std::vector<PackedNode> m_nodes;
+  std::vector<char32_t> m_labels;
+  std::vector<uint8_t> m_values;
+
+  mutable std::mutex m_mutex;
+  mutable std::unordered_map<std::u32string, std::vector<size_t>> m_cache;
+};
+
+} // namespace tex
+
+#endif // LIBTYPESET_HYPHENATION_H
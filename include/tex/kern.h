@@ -24,7 +24,7 @@ private:
   float mSpace;
 };
 
-LIBTYPESET_API std::shared_ptr<Kern> kern(float space);
+LIBTYPESET_API NodeRef<Kern> kern(float space);
 
 } // namespace tex
 
@@ -0,0 +1,104 @@
+// Copyright (C) 2020 Vincent Chambrin
+// This file is part of the 'typeset' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#ifndef LIBTYPESET_LAYOUTCACHE_H
+#define LIBTYPESET_LAYOUTCACHE_H
+
+#include "tex/linebreaks.h"
+
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+
+namespace tex
+{
+
+/*!
+ * \class LayoutCache
+ * \brief Memoizes the lines of paragraphs
+ *
+ * Paragraphs are identified by a hash of their horizontal list (the kind,
+ * dimensions, fonts and characters of the nodes, recursively) and of the
+ * parameters of the Paragraph that affect its lines.
+ * When a paragraph is found in the cache, its lines are returned without
+ * running the linebreaker; the boxes are then shared with the cache and
+ * must not be modified.
+ * As keys are 64-bit hashes, a hit is only trusted if the paragraph also
+ * matches a second hash computed with another seed, its number of nodes
+ * and its natural width; otherwise it counts as a collision and a miss.
+ *
+ * The least recently used paragraphs are evicted when the estimated size of
+ * the cached lines exceeds the budget; lines built with a NodeArena keep
+ * its blocks alive, which the estimate does not account for.
+ */
+class LIBTYPESET_API LayoutCache
+{
+public:
+  using Key = uint64_t;
+
+  struct Statistics
+  {
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t evictions = 0;
+    size_t collisions = 0;
+  };
+
+  Statistics statistics;
+
+public:
+  explicit LayoutCache(size_t budget = 16 * 1024 * 1024);
+  LayoutCache(const LayoutCache&) = delete;
+  ~LayoutCache();
+
+  size_t budget() const { return m_budget; }
+  void setBudget(size_t budget);
+
+  size_t size() const { return m_entries.size(); }
+  size_t bytes() const { return m_bytes; }
+
+  List create(Paragraph& paragraph, const List& hlist);
+  List create(Paragraph& paragraph, List&& hlist);
+
+  bool contains(Key key) const;
+  void clear();
+
+  static Key hash(const Paragraph& paragraph, const List& hlist);
+  static size_t footprint(const List& vlist);
+
+  LayoutCache& operator=(const LayoutCache&) = delete;
+
+protected:
+  struct Check
+  {
+    uint64_t hash = 0;
+    size_t nodes = 0;
+    float width = 0.f;
+  };
+
+  static Key hash(const Paragraph& paragraph, const List& hlist, Check& check);
+
+  const List* find(Key key, const Check& check, Paragraph& paragraph);
+  void insert(Key key, const Check& check, const List& lines, const Paragraph& paragraph);
+  void evict();
+
+private:
+  struct Entry
+  {
+    Key key;
+    Check check;
+    List lines;
+    float prevdepth;
+    size_t bytes;
+  };
+
+  std::list<Entry> m_entries;
+  std::unordered_map<Key, std::list<Entry>::iterator> m_index;
+  size_t m_budget;
+  size_t m_bytes = 0;
+};
+
+} // namespace tex
+
+#endif // LIBTYPESET_LAYOUTCACHE_H
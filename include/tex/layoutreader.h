@@ -5,6 +5,7 @@
 #ifndef LIBTYPESET_LAYOUTREADER_H
 #define LIBTYPESET_LAYOUTREADER_H
 
+#include "tex/discretionary.h"
 #include "tex/glue.h"
 #include "tex/hbox.h"
 #include "tex/kern.h"
@@ -29,7 +30,7 @@ struct Pos
 
 struct LIBTYPESET_API LayoutReader 
 { 
-  void operator()(std::shared_ptr<tex::Box> box, const Pos & p);
+  void operator()(NodeRef<tex::Box> box, const Pos & p);
 };
 
 struct LIBTYPESET_API PartialLayoutReader
@@ -37,37 +38,41 @@ struct LIBTYPESET_API PartialLayoutReader
   static const bool Done = true;
   static const bool Continue = false;
 
-  bool operator()(std::shared_ptr<tex::Box> box, const Pos & p);
+  bool operator()(NodeRef<tex::Box> box, const Pos & p);
 };
 
 
-template<typename Reader>
-void read_hbox_full(Reader && reader, const std::shared_ptr<HBox> & layout, Pos pos)
+/*!
+ * \fn Pos read_hlist_full(Reader && reader, const HBox & layout, const Nodes & nodes, Pos pos)
+ * \brief Reads the nodes of a horizontal list set in \a layout and returns the position after them
+ *
+ * The no-break material of discretionaries is read at their position.
+ */
+template<typename Reader, typename Nodes>
+Pos read_hlist_full(Reader && reader, const HBox & layout, const Nodes & nodes, Pos pos)
 {
-  reader(layout, pos);
-
-  for (auto node : layout->list())
+  for (const NodeRef<Node>& node : nodes)
   {
     if (node->isBox())
     {
-      auto box = std::static_pointer_cast<Box>(node);
+      auto box = static_pointer_cast<Box>(node);
 
       if (box->is<Rule>())
       {
-        reader(std::static_pointer_cast<Rule>(box), pos);
+        reader(static_pointer_cast<Rule>(box), pos);
       }
       else if (box->isListBox())
       {
-        auto listbox = std::static_pointer_cast<ListBox>(box);
+        auto listbox = static_pointer_cast<ListBox>(box);
         const float shifted_baseline = pos.y + listbox->shiftAmount();
         if (listbox->isHBox())
         {
-          read_hbox_full(reader, std::static_pointer_cast<HBox>(listbox), Pos{ pos.x, shifted_baseline });
+          read_hbox_full(reader, static_pointer_cast<HBox>(listbox), Pos{ pos.x, shifted_baseline });
         }
         else
         {
           assert(listbox->isVBox());
-          read_vbox_full(reader, std::static_pointer_cast<VBox>(listbox), Pos{ pos.x, shifted_baseline });
+          read_vbox_full(reader, static_pointer_cast<VBox>(listbox), Pos{ pos.x, shifted_baseline });
         }
       }
       else
@@ -79,59 +84,72 @@ void read_hbox_full(Reader && reader, const std::shared_ptr<HBox> & layout, Pos
     }
     else if (node->is<Kern>())
     {
-      pos.x += std::static_pointer_cast<Kern>(node)->space();
+      pos.x += static_pointer_cast<Kern>(node)->space();
     }
     else if (node->is<Glue>())
     {
-      auto glue = std::static_pointer_cast<Glue>(node);
+      auto glue = static_pointer_cast<Glue>(node);
 
       pos.x += glue->space();
 
-      if (layout->glueRatio() < 0.f)
+      if (layout.glueRatio() < 0.f)
       {
-        if (layout->glueOrder() == glue->shrinkOrder())
-          pos.x += layout->glueRatio() * glue->shrink();
+        if (layout.glueOrder() == glue->shrinkOrder())
+          pos.x += layout.glueRatio() * glue->shrink();
       }
       else
       {
-        if (layout->glueOrder() == glue->stretchOrder())
-          pos.x += layout->glueRatio() * glue->stretch();
+        if (layout.glueOrder() == glue->stretchOrder())
+          pos.x += layout.glueRatio() * glue->stretch();
       }
     }
+    else if (node->is<Discretionary>())
+    {
+      pos = read_hlist_full(reader, layout, static_pointer_cast<Discretionary>(node)->nobreak(), pos);
+    }
   }
+
+  return pos;
 }
 
 template<typename Reader>
-void read_vbox_full(Reader && reader, const std::shared_ptr<VBox> & layout, Pos pos)
+void read_hbox_full(Reader && reader, const NodeRef<HBox> & layout, Pos pos)
+{
+  reader(layout, pos);
+  read_hlist_full(reader, *layout, layout->list(), pos);
+}
+
+template<typename Reader>
+void read_vbox_full(Reader && reader, const NodeRef<VBox> & layout, Pos pos)
 {
   reader(layout, pos);
 
   pos.y -= layout->height();
 
-  for (auto node : layout->list())
+  for (const auto& node : layout->list())
   {
     if (node->isBox())
     {
-      auto box = std::static_pointer_cast<Box>(node);
+      auto box = static_pointer_cast<Box>(node);
 
       pos.y += box->height();
 
       if (box->is<Rule>())
       {
-        reader(std::static_pointer_cast<Rule>(box), pos);
+        reader(static_pointer_cast<Rule>(box), pos);
       }
       else if (box->isListBox())
       {
-        auto listbox = std::static_pointer_cast<ListBox>(box);
+        auto listbox = static_pointer_cast<ListBox>(box);
         const float shift = listbox->shiftAmount();
         if (listbox->isHBox())
         {
-          read_hbox_full(reader, std::static_pointer_cast<HBox>(listbox), Pos{ pos.x + shift, pos.y });
+          read_hbox_full(reader, static_pointer_cast<HBox>(listbox), Pos{ pos.x + shift, pos.y });
         }
         else
         {
           assert(listbox->isVBox());
-          read_vbox_full(reader, std::static_pointer_cast<VBox>(listbox), Pos{ pos.x + shift, pos.y });
+          read_vbox_full(reader, static_pointer_cast<VBox>(listbox), Pos{ pos.x + shift, pos.y });
         }
       }
       else
@@ -143,11 +161,11 @@ void read_vbox_full(Reader && reader, const std::shared_ptr<VBox> & layout, Pos
     }
     else if (node->is<Kern>())
     {
-      pos.y += std::static_pointer_cast<Kern>(node)->space();
+      pos.y += static_pointer_cast<Kern>(node)->space();
     }
     else if (node->is<Glue>())
     {
-      auto glue = std::static_pointer_cast<Glue>(node);
+      auto glue = static_pointer_cast<Glue>(node);
 
       pos.y += glue->space();
 
@@ -165,36 +183,40 @@ void read_vbox_full(Reader && reader, const std::shared_ptr<VBox> & layout, Pos
   }
 }
 
-template<typename Reader>
-bool read_hbox_partial(Reader && reader, const std::shared_ptr<HBox> & layout, Pos pos)
+/*!
+ * \fn bool read_hlist_partial(Reader && reader, const HBox & layout, const Nodes & nodes, Pos & pos)
+ * \brief Reads the nodes of a horizontal list set in \a layout until the reader is done
+ *
+ * \a pos is advanced past the nodes that were read.
+ * The no-break material of discretionaries is read at their position.
+ */
+template<typename Reader, typename Nodes>
+bool read_hlist_partial(Reader && reader, const HBox & layout, const Nodes & nodes, Pos & pos)
 {
-  if(reader(layout, pos))
-    return PartialLayoutReader::Done;
-
-  for (auto node : layout->list())
+  for (const NodeRef<Node>& node : nodes)
   {
     if (node->isBox())
     {
-      auto box = std::static_pointer_cast<Box>(node);
+      auto box = static_pointer_cast<Box>(node);
 
       if (box->is<Rule>())
       {
-        if (reader(std::static_pointer_cast<Rule>(box), pos))
+        if (reader(static_pointer_cast<Rule>(box), pos))
           return PartialLayoutReader::Done;
       }
       else if (box->isListBox())
       {
-        auto listbox = std::static_pointer_cast<ListBox>(box);
+        auto listbox = static_pointer_cast<ListBox>(box);
         const float shifted_baseline = pos.y + listbox->shiftAmount();
         if (listbox->isHBox())
         {
-          if(read_hbox_partial(reader, std::static_pointer_cast<HBox>(listbox), Pos{ pos.x, shifted_baseline }))
+          if(read_hbox_partial(reader, static_pointer_cast<HBox>(listbox), Pos{ pos.x, shifted_baseline }))
             return PartialLayoutReader::Done;
         }
         else
         {
           assert(listbox->isVBox());
-          if(read_vbox_partial(reader, std::static_pointer_cast<VBox>(listbox), Pos{ pos.x, shifted_baseline }))
+          if(read_vbox_partial(reader, static_pointer_cast<VBox>(listbox), Pos{ pos.x, shifted_baseline }))
             return PartialLayoutReader::Done;
         }
       }
@@ -208,64 +230,78 @@ bool read_hbox_partial(Reader && reader, const std::shared_ptr<HBox> & layout, P
     }
     else if (node->is<Kern>())
     {
-      pos.x += std::static_pointer_cast<Kern>(node)->space();
+      pos.x += static_pointer_cast<Kern>(node)->space();
     }
     else if (node->is<Glue>())
     {
-      auto glue = std::static_pointer_cast<Glue>(node);
+      auto glue = static_pointer_cast<Glue>(node);
 
       pos.x += glue->space();
 
-      if (layout->glueRatio() < 0.f)
+      if (layout.glueRatio() < 0.f)
       {
-        if (layout->glueOrder() == glue->shrinkOrder())
-          pos.x += layout->glueRatio() * glue->shrink();
+        if (layout.glueOrder() == glue->shrinkOrder())
+          pos.x += layout.glueRatio() * glue->shrink();
       }
       else
       {
-        if (layout->glueOrder() == glue->stretchOrder())
-          pos.x += layout->glueRatio() * glue->stretch();
+        if (layout.glueOrder() == glue->stretchOrder())
+          pos.x += layout.glueRatio() * glue->stretch();
       }
     }
+    else if (node->is<Discretionary>())
+    {
+      if (read_hlist_partial(reader, layout, static_pointer_cast<Discretionary>(node)->nobreak(), pos))
+        return PartialLayoutReader::Done;
+    }
   }
 
   return PartialLayoutReader::Continue;
 }
 
 template<typename Reader>
-bool read_vbox_partial(Reader && reader, const std::shared_ptr<VBox> & layout, Pos pos)
+bool read_hbox_partial(Reader && reader, const NodeRef<HBox> & layout, Pos pos)
+{
+  if(reader(layout, pos))
+    return PartialLayoutReader::Done;
+
+  return read_hlist_partial(reader, *layout, layout->list(), pos);
+}
+
+template<typename Reader>
+bool read_vbox_partial(Reader && reader, const NodeRef<VBox> & layout, Pos pos)
 {
   if (reader(layout, pos))
     return PartialLayoutReader::Done;
 
   pos.y -= layout->height();
 
-  for (auto node : layout->list())
+  for (const auto& node : layout->list())
   {
     if (node->isBox())
     {
-      auto box = std::static_pointer_cast<Box>(node);
+      auto box = static_pointer_cast<Box>(node);
 
       pos.y += box->height();
 
       if (box->is<Rule>())
       {
-        if (reader(std::static_pointer_cast<Rule>(box), pos))
+        if (reader(static_pointer_cast<Rule>(box), pos))
           return PartialLayoutReader::Done;
       }
       else if (box->isListBox())
       {
-        auto listbox = std::static_pointer_cast<ListBox>(box);
+        auto listbox = static_pointer_cast<ListBox>(box);
         const float shift = listbox->shiftAmount();
         if (listbox->is<HBox>())
         {
-          if (read_hbox_partial(reader, std::static_pointer_cast<HBox>(listbox), Pos{ pos.x + shift, pos.y }))
+          if (read_hbox_partial(reader, static_pointer_cast<HBox>(listbox), Pos{ pos.x + shift, pos.y }))
             return PartialLayoutReader::Done;
         }
         else
         {
           assert(listbox->is<VBox>());
-          if(read_vbox_partial(reader, std::static_pointer_cast<VBox>(listbox), Pos{ pos.x + shift, pos.y }))
+          if(read_vbox_partial(reader, static_pointer_cast<VBox>(listbox), Pos{ pos.x + shift, pos.y }))
             return PartialLayoutReader::Done;
         }
       }
@@ -279,11 +315,11 @@ bool read_vbox_partial(Reader && reader, const std::shared_ptr<VBox> & layout, P
     }
     else if (node->is<Kern>())
     {
-      pos.y += std::static_pointer_cast<Kern>(node)->space();
+      pos.y += static_pointer_cast<Kern>(node)->space();
     }
     else if (node->is<Glue>())
     {
-      auto glue = std::static_pointer_cast<Glue>(node);
+      auto glue = static_pointer_cast<Glue>(node);
 
       pos.y += glue->space();
 
@@ -311,23 +347,23 @@ template<>
 struct layout_reader_impl<void>
 {
   template<typename Reader>
-  static void read(Reader && reader, const std::shared_ptr<Box> & layout, Pos pos)
+  static void read(Reader && reader, const NodeRef<Box> & layout, Pos pos)
   {
     if (layout->is<Rule>())
     {
-      reader(std::static_pointer_cast<Rule>(layout), pos);
+      reader(static_pointer_cast<Rule>(layout), pos);
     }
     else if (layout->isListBox())
     {
-      auto listbox = std::static_pointer_cast<ListBox>(layout);
+      auto listbox = static_pointer_cast<ListBox>(layout);
       if (listbox->is<HBox>())
       {
-        read_hbox_full(reader, std::static_pointer_cast<HBox>(listbox), pos);
+        read_hbox_full(reader, static_pointer_cast<HBox>(listbox), pos);
       }
       else
       {
         assert(listbox->is<VBox>());
-        read_vbox_full(reader, std::static_pointer_cast<VBox>(listbox), pos);
+        read_vbox_full(reader, static_pointer_cast<VBox>(listbox), pos);
       }
     }
     else
@@ -341,23 +377,23 @@ template<>
 struct layout_reader_impl<bool>
 {
   template<typename Reader>
-  static void read(Reader && reader, const std::shared_ptr<Box> & layout, Pos pos)
+  static void read(Reader && reader, const NodeRef<Box> & layout, Pos pos)
   {
     if (layout->is<Rule>())
     {
-      reader(std::static_pointer_cast<Rule>(layout), pos);
+      reader(static_pointer_cast<Rule>(layout), pos);
     }
     else if (layout->isListBox())
     {
-      auto listbox = std::static_pointer_cast<ListBox>(layout);
+      auto listbox = static_pointer_cast<ListBox>(layout);
       if (listbox->isHBox())
       {
-        read_hbox_partial(reader, std::static_pointer_cast<HBox>(listbox), pos);
+        read_hbox_partial(reader, static_pointer_cast<HBox>(listbox), pos);
       }
       else
       {
         assert(listbox->isVBox());
-        read_vbox_partial(reader, std::static_pointer_cast<VBox>(listbox), pos);
+        read_vbox_partial(reader, static_pointer_cast<VBox>(listbox), pos);
       }
     }
     else
@@ -368,16 +404,16 @@ struct layout_reader_impl<bool>
 };
 
 template<typename Reader>
-void read(Reader && reader, const std::shared_ptr<Box> & layout)
+void read(Reader && reader, const NodeRef<Box> & layout)
 {
   Pos pos = Pos(0, layout->height());
-  layout_reader_impl< std::result_of_t<Reader(std::shared_ptr<Box>, Pos)> >::read(std::forward<Reader>(reader), layout, pos);
+  layout_reader_impl< std::result_of_t<Reader(NodeRef<Box>, Pos)> >::read(std::forward<Reader>(reader), layout, pos);
 }
 
 template<typename Reader>
-void read(Reader && reader, const std::shared_ptr<Box> & layout, Pos pos)
+void read(Reader && reader, const NodeRef<Box> & layout, Pos pos)
 {
-  layout_reader_impl< std::result_of_t<Reader(std::shared_ptr<Box>, Pos)> >::read(std::forward<Reader>(reader), layout, pos);
+  layout_reader_impl< std::result_of_t<Reader(NodeRef<Box>, Pos)> >::read(std::forward<Reader>(reader), layout, pos);
 }
 
 } // namespace tex
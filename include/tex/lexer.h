@@ -59,6 +59,7 @@ public:
   std::array<CharCategory, 256>& catcodes() { return m_state.catcodes; }
 
   std::vector<Token>& output() { return m_tokens; }
+  const std::vector<Token>& output() const { return m_tokens; }
 
   CharCategory category(char c) const { return catcodes().at(static_cast<unsigned char>(c)); }
 
@@ -8,10 +8,15 @@
 #include "tex/hbox.h"
 
 #include "tex/parshape.h"
+#include "tex/scaled.h"
 
 namespace tex
 {
 
+class HListView;
+class LinebreakCheckpoints;
+class NodeArena;
+
 enum class FitnessClass {
   Tight = 0,
   Decent = 1,
@@ -19,40 +24,74 @@ enum class FitnessClass {
   VeryLoose = 3,
 };
 
+/*!
+ * \struct LinebreakCheckpoint
+ * \brief The state of the linebreaker when it reaches a box
+ */
+struct LinebreakCheckpoint
+{
+  size_t position;
+  size_t nodes;
+  std::vector<size_t> active;
+};
+
 class LIBTYPESET_API Paragraph final
 {
 public:
+  float pretolerance = 1.f;
   float tolerance = /* 200 */ 800;
   int adjdemerits = 10'000;
   int linepenalty = 10;
+  int hyphenpenalty = 50;
+  int exhyphenpenalty = 50;
   float hsize = 800.f;
   float hangindent = 0.f;
   int hangafter = 1;
   Parshape parshape;
-  std::shared_ptr<Glue> leftskip;
-  std::shared_ptr<Glue> rightskip;
-  std::shared_ptr<Glue> parfillskip;
-  std::shared_ptr<Glue> baselineskip;
-  std::shared_ptr<Glue> lineskip;
+  NodeRef<Glue> leftskip;
+  NodeRef<Glue> rightskip;
+  NodeRef<Glue> parfillskip;
+  NodeRef<Glue> baselineskip;
+  NodeRef<Glue> lineskip;
   float lineskiplimit;
   float prevdepth = -10000.f;
+  bool concave = false;
+  size_t maxactive = 0;
+  int64_t demeritscutoff = -1;
+  bool checkpruning = false;
+  std::shared_ptr<NodeArena> arena;
+
+  struct Statistics
+  {
+    size_t firstpass = 0;
+    size_t secondpass = 0;
+    size_t concave = 0;
+    size_t breakpoints = 0;
+    size_t pruned = 0;
+    size_t prunedpasses = 0;
+    size_t prunechanged = 0;
+  };
+
+  Statistics statistics;
 
 public:
   Paragraph();
 
   using Badness = int;
-  using Demerits = int;
+  using Demerits = int64_t;
 
   bool hangindentAppliesToLine(size_t n) const;
+  bool hasConcaveDemerits(float threshold) const;
   float linelength(size_t n) const;
+  float linelength(size_t n, float hsize) const;
 
   struct Totals
   {
     Totals();
 
-    float width;
-    GlueStretch stretch;
-    GlueShrink shrink;
+    Dimension width;
+    Dimension stretch[4];
+    Dimension shrink[4];
   };
 
   struct Breakpoint 
@@ -62,6 +101,7 @@ public:
     size_t line;
     FitnessClass fitness;
     Totals totals;
+    Dimension postbreak = 0;
     std::shared_ptr<Breakpoint> previous;
 
     Breakpoint(const List::const_iterator & pos, std::shared_ptr<Breakpoint> prev = nullptr);
@@ -69,13 +109,25 @@ public:
   };
 
   std::list<std::shared_ptr<Breakpoint>> computeFeasibleBreakpoints(const List& hlist);
+  std::list<std::shared_ptr<Breakpoint>> computeFeasibleBreakpoints(const HListView& hlist);
   std::vector<Breakpoint> computeBreakpoints(const std::list<std::shared_ptr<Breakpoint>>& candidates);
   std::vector<Breakpoint> computeBreakpoints(std::shared_ptr<Breakpoint> breakpoints);
   std::vector<Breakpoint> computeBreakpoints(const List& hlist);
+  std::vector<Breakpoint> computeBreakpoints(const HListView& hlist);
+
+  std::vector<size_t> computeBreaks(const List& hlist);
+  std::vector<size_t> computeBreaks(const HListView& hlist);
+  std::vector<size_t> computeBreaks(const HListView& hlist, LinebreakCheckpoints& checkpoints);
+  std::vector<std::vector<size_t>> computeBreaks(const List& hlist, const std::vector<float>& hsizes);
+  std::vector<std::vector<size_t>> computeBreaks(const HListView& hlist, const std::vector<float>& hsizes);
+  std::vector<size_t> recomputeBreaks(const HListView& hlist, size_t position, size_t removed, size_t inserted, LinebreakCheckpoints& checkpoints);
 
   void prepare(List & hlist);
   List create(const List & hlist);
+  List create(List&& hlist);
   List create(const List& hlist, const std::vector<Breakpoint>& breakpoints);
+  List create(const HListView& hlist, const std::vector<Breakpoint>& breakpoints);
+  List create(const HListView& hlist, const std::vector<size_t>& breaks);
 
   static Badness computeBadness(float glueSetRatio);
   static FitnessClass getFitnessClass(float glueSetRatio);
@@ -87,20 +139,100 @@ public:
 
 protected:
   /// Linebreaking
-  static ShrinkTotals shrinkTotals(const Glue& lskip, const Glue& rskip);
-  static StretchTotals stretchTotals(const Glue& lskip, const Glue& rskip);
-  float computeGlueRatio(const Totals & sum, Breakpoint & active, size_t current_line);
-  Totals squeezeDiscardables(Totals sum, List::const_iterator breakpointpos, List::const_iterator end);
-  void tryBreak(std::list<std::shared_ptr<Breakpoint>> & activeBreakpoints, const List &hlist, List::const_iterator it, Totals sum);
+  static void accumulate(Totals& sum, const HListView& hlist, size_t i);
+  static void accumulate(Totals& sum, const Glue& glue);
+  Totals skipTotals() const;
+  float computeGlueRatio(const Totals & sum, const Totals& from, const Totals& skips, size_t current_line, Badness& badness);
+  float computeGlueRatio(const Totals& sum, const Totals& from, const Totals& skips, Dimension line_length, Badness& badness);
+  size_t lineClass(size_t n) const;
+  Totals squeezeDiscardables(Totals sum, const HListView& hlist, size_t breakpointpos);
+  std::list<std::shared_ptr<Breakpoint>> computeFeasibleBreakpoints(const HListView& hlist, float threshold, bool discretionaries);
+  void tryBreak(std::list<std::shared_ptr<Breakpoint>> & activeBreakpoints, const HListView& hlist, size_t pos, Totals sum, const Totals& skips, float threshold);
+  int breakPenalty(const HListView& hlist, size_t pos) const;
+  static Dimension prebreakWidth(const HListView& hlist, size_t pos);
+  static Dimension postbreakWidth(const HListView& hlist, size_t pos);
+
+  /// Index-based linebreaking
+  struct BreakNode
+  {
+    size_t position;
+    size_t totals;
+    Demerits demerits;
+    Dimension postbreak;
+    size_t line;
+    FitnessClass fitness;
+    size_t previous;
+  };
+
+  struct BreakGraph;
+  struct LinebreakState;
+
+  void initBreaks(LinebreakState& state, const HListView& hlist, size_t from);
+  static void startPass(BreakGraph& graph, float threshold, bool discretionaries);
+  size_t breakLines(LinebreakState& state, const HListView& hlist, size_t i, std::vector<LinebreakCheckpoint>* checkpoints);
+  void tryBreak(LinebreakState& state, const HListView& hlist, size_t pos);
+  void tryBreak(const LinebreakState& state, BreakGraph& graph, const HListView& hlist, size_t pos);
+  void prune(BreakGraph& graph);
+  void resumeBreaks(const HListView& hlist, size_t position, size_t removed, size_t inserted, LinebreakCheckpoints& checkpoints);
+  static std::vector<size_t> bestBreaks(const BreakGraph& state);
+  std::vector<size_t> runPasses(LinebreakState& state, const HListView& hlist);
+  bool runPass(LinebreakState& state, const HListView& hlist, float threshold, bool discretionaries, std::vector<size_t>& breaks);
+  bool concaveBreaks(const LinebreakState& state, const HListView& hlist, std::vector<size_t>& breaks);
 
   /// Paragraph creation
-  std::shared_ptr<HBox> createLine(size_t linenum, List::const_iterator begin, List::const_iterator end);
+  List create(const HListView& hlist, const std::vector<size_t>& breaks, List* source);
+  NodeRef<HBox> createLine(size_t linenum, const HListView& hlist, size_t begin, size_t end, List* source = nullptr, const List* postbreak = nullptr, const List* prebreak = nullptr);
 
 protected:
+  friend class LinebreakCheckpoints;
+  friend class ParagraphBatch;
+
   static bool isDiscardable(const Node & node);
   static bool isForcedLinebreak(const Node & node);
   static bool isForbiddenLinebreak(const Node & node);
-  static void consumeDiscardable(List::const_iterator & it);
+  static bool isForcedLinebreak(const HListView& hlist, size_t i);
+  static bool isForbiddenLinebreak(const HListView& hlist, size_t i);
+  static size_t consumeDiscardable(const HListView& hlist, size_t i);
+  static bool isBreakOpportunity(const HListView& hlist, size_t i);
+};
+
+/*!
+ * \class LinebreakCheckpoints
+ * \brief Saves the state of the linebreaker at the beginning of each line
+ *
+ * This is used by Paragraph::recomputeBreaks() to break an edited paragraph
+ * without processing the lines before the edit, and usually most of the
+ * lines after it.
+ */
+class LIBTYPESET_API LinebreakCheckpoints
+{
+public:
+  LinebreakCheckpoints();
+  LinebreakCheckpoints(const LinebreakCheckpoints&) = delete;
+  ~LinebreakCheckpoints();
+
+  using Checkpoint = LinebreakCheckpoint;
+
+  void clear();
+
+  const std::vector<Checkpoint>& checkpoints() const { return m_checkpoints; }
+  const std::vector<size_t>& breaks() const { return m_breaks; }
+
+  size_t resumedAt() const { return m_resumed_at; }
+  size_t resynchronizedAt() const { return m_resynchronized_at; }
+
+  LinebreakCheckpoints& operator=(const LinebreakCheckpoints&) = delete;
+
+protected:
+  friend class Paragraph;
+  std::vector<size_t> finish(const Paragraph& paragraph, const HListView& hlist);
+
+private:
+  std::unique_ptr<Paragraph::LinebreakState> m_state;
+  std::vector<Checkpoint> m_checkpoints;
+  std::vector<size_t> m_breaks;
+  size_t m_resumed_at = 0;
+  size_t m_resynchronized_at = 0;
 };
 
 } // namespace tex
@@ -8,6 +8,7 @@
 #include "tex/box.h"
 
 #include "tex/glue.h"
+#include "tex/smallvector.h"
 
 #include <list>
 #include <memory>
@@ -15,7 +16,17 @@
 namespace tex
 {
 
-typedef std::list<std::shared_ptr<Node>> List;
+typedef std::list<NodeRef<Node>> List;
+
+/*!
+ * \typedef ChildList
+ * \brief Contiguous storage for the children of a ListBox
+ *
+ * Lists are built as a List and moved into a box once complete;
+ * most boxes produced by the math typesetter have very few children
+ * and do not need any allocation.
+ */
+typedef SmallVector<NodeRef<Node>, 4> ChildList;
 
 enum BoxingResult {
   NormalBox,
@@ -23,6 +34,22 @@ enum BoxingResult {
   UnderfullBox,
 };
 
+/*!
+ * \struct BoxingInfo
+ * \brief Natural dimensions and glue totals of a list
+ *
+ * For a vertical list, \c height is the sum of the heights, depths and glue of
+ * the nodes (the depth of the last box is not removed) and \c depth is unused.
+ */
+struct BoxingInfo
+{
+  float width = 0.f;
+  float height = 0.f;
+  float depth = 0.f;
+  GlueShrink shrink;
+  GlueStretch stretch;
+};
+
 class LIBTYPESET_API ListBox : public Box
 {
 public:
@@ -32,42 +59,73 @@ public:
   inline void setShiftAmount(float sa) { mShiftAmount = sa; }
   inline void shift(float amount) { mShiftAmount += amount; }
 
-  inline const List & list() const { return mList; }
+  inline const ChildList & list() const { return mList; }
 
   inline float glueRatio() const { return mGlueSettings.ratio; }
   inline GlueOrder glueOrder() const { return mGlueSettings.order; }
 
+  const BoxingInfo& totals() const;
+
 protected:
   friend class ListBoxEditor;
 
-  ListBox(List && list);
-  ListBox(const BoxMetrics& metrics);
+  ListBox(NodeKind k, List && list);
+  ListBox(NodeKind k, ChildList && list);
+  ListBox(NodeKind k, const BoxMetrics& metrics);
 
-  inline List & mutableList() { return mList; }
+  inline ChildList & mutableList() { invalidateTotals(); return mList; }
 
   void setGlue(float ratio, GlueOrder order);
   float setGlue(float x, float desired, const GlueShrink & shrink, const GlueStretch & stretch);
 
+  void setTotals(const BoxingInfo& info);
+  inline void invalidateTotals() { mTotalsValid = false; }
+  void addToTotals(const Node& node);
+  void removeFromTotals(const Node& node);
+
 private:
-  List mList;
+  void accumulate(BoxingInfo& info, const Node& node) const;
+
+private:
+  ChildList mList;
   float mShiftAmount;
   GlueSettings mGlueSettings;
+  mutable BoxingInfo mTotals;
+  mutable bool mTotalsValid = false;
 };
 
+/*!
+ * \class ListBoxEditor
+ * \brief Modifies the content or the dimensions of a list box
+ *
+ * Nodes inserted or removed with push_back(), push_front(), insert() and erase()
+ * update the box's cached totals, so that a subsequent rebox only pays for
+ * the nodes that changed.
+ * Modifying the list returned by list() invalidates the totals.
+ */
 class LIBTYPESET_API ListBoxEditor
 {
 private:
   ListBox* mListBox;
+  bool mListExposed = false;
 public:
   ListBoxEditor(ListBox & box);
   ~ListBoxEditor();
 
-  List & list();
+  ChildList & list();
+
+  void push_back(NodeRef<Node> node);
+  void push_front(NodeRef<Node> node);
+  ChildList::iterator insert(ChildList::const_iterator pos, NodeRef<Node> node);
+  ChildList::iterator erase(ChildList::const_iterator pos);
 
   void enlarge(float amount);
   void increaseDepth(float amount);
   void setHeight(float h);
   void setDepth(float d);
+
+protected:
+  void sync();
 };
 
 } // namespace tex
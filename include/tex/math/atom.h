@@ -43,47 +43,45 @@ public:
     DisplayLimits,
   };
 
-  bool isAtom() const override;
-
   inline Type type() const { return mType; }
   void changeType(Type newtype);
 
-  inline const std::shared_ptr<Node> & nucleus() const { return mNucleus; }
-  inline const std::shared_ptr<Node> & subscript() const { return mSubscript; }
-  inline const std::shared_ptr<Node> & superscript() const { return mSuperscript; }
-  inline const std::shared_ptr<Symbol> & accent() const { return mAccent; }
+  inline const NodeRef<Node> & nucleus() const { return mNucleus; }
+  inline const NodeRef<Node> & subscript() const { return mSubscript; }
+  inline const NodeRef<Node> & superscript() const { return mSuperscript; }
+  inline const NodeRef<Symbol> & accent() const { return mAccent; }
   inline LimitsFlag limits() const { return mLimits; }
 
-  void changeNucleus(const std::shared_ptr<Node> & nuc);
+  void changeNucleus(const NodeRef<Node> & nuc);
   void clearSubSupscripts();
 
   template<Atom::Type T, typename = std::enable_if_t<T == Atom::Op>>
-  static std::shared_ptr<Atom> create(std::shared_ptr<Node> nucleus, std::shared_ptr<Node> subscript = nullptr, std::shared_ptr<Node> superscript = nullptr, LimitsFlag limits = NoLimits)
+  static NodeRef<Atom> create(NodeRef<Node> nucleus, NodeRef<Node> subscript = nullptr, NodeRef<Node> superscript = nullptr, LimitsFlag limits = NoLimits)
   {
-    return std::make_shared<Atom>(T, nucleus, subscript, superscript, nullptr, limits);
+    return make_node<Atom>(T, nucleus, subscript, superscript, nullptr, limits);
   }
 
   template<Atom::Type T, typename = std::enable_if_t<T == Atom::Acc>>
-  static std::shared_ptr<Atom> create(std::shared_ptr<Node> nucleus, std::shared_ptr<Symbol> accent, std::shared_ptr<Node> subscript = nullptr, std::shared_ptr<Node> superscript = nullptr)
+  static NodeRef<Atom> create(NodeRef<Node> nucleus, NodeRef<Symbol> accent, NodeRef<Node> subscript = nullptr, NodeRef<Node> superscript = nullptr)
   {
-    return std::make_shared<Atom>(T, nucleus, subscript, superscript, accent, NoLimits);
+    return make_node<Atom>(T, nucleus, subscript, superscript, accent, NoLimits);
   }
 
   template<Atom::Type T, typename = std::enable_if_t<T != Atom::Acc && T != Atom::Op>>
-  static std::shared_ptr<Atom> create(std::shared_ptr<Node> nucleus, std::shared_ptr<Node> subscript = nullptr, std::shared_ptr<Node> superscript = nullptr)
+  static NodeRef<Atom> create(NodeRef<Node> nucleus, NodeRef<Node> subscript = nullptr, NodeRef<Node> superscript = nullptr)
   {
-    return std::make_shared<Atom>(T, nucleus, subscript, superscript, nullptr, NoLimits);
+    return make_node<Atom>(T, nucleus, subscript, superscript, nullptr, NoLimits);
   }
 
 public:
-  Atom(Type t, std::shared_ptr<Node> nucleus, std::shared_ptr<Node> subscript, std::shared_ptr<Node> superscript, std::shared_ptr<Symbol> accent, LimitsFlag limits);
+  Atom(Type t, NodeRef<Node> nucleus, NodeRef<Node> subscript, NodeRef<Node> superscript, NodeRef<Symbol> accent, LimitsFlag limits);
 
 private:
   Type mType;
-  std::shared_ptr<Node> mNucleus;
-  std::shared_ptr<Node> mSubscript;
-  std::shared_ptr<Node> mSuperscript;
-  std::shared_ptr<Symbol> mAccent; // accent of a Acc atom
+  NodeRef<Node> mNucleus;
+  NodeRef<Node> mSubscript;
+  NodeRef<Node> mSuperscript;
+  NodeRef<Symbol> mAccent; // accent of a Acc atom
   LimitsFlag mLimits;
 };
 
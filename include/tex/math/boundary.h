@@ -18,15 +18,13 @@ namespace math
 class LIBTYPESET_API Boundary : public Node
 {
 public:
-  explicit Boundary(const std::shared_ptr<Symbol> & symbol) : mSymbol(symbol) { }
+  explicit Boundary(const NodeRef<Symbol> & symbol) : Node(NodeKind::Boundary), mSymbol(symbol) { }
   ~Boundary() = default;
 
-  bool isBoundary() const;
-
-  inline const std::shared_ptr<Symbol> & symbol() const { return mSymbol; }
+  inline const NodeRef<Symbol> & symbol() const { return mSymbol; }
 
 private:
-  std::shared_ptr<Symbol> mSymbol;
+  NodeRef<Symbol> mSymbol;
 };
 
 } // namespace math
@@ -19,19 +19,17 @@ public:
   ~Fraction() = default;
 
   explicit Fraction(bool bar = true)
-    : mBar(bar)
+    : Node(NodeKind::Fraction), mBar(bar)
   {
 
   }
 
   Fraction(MathList && n, MathList && d, bool bar = true)
-    : mNumer(std::move(n)), mDenom(std::move(d)), mBar(bar)
+    : Node(NodeKind::Fraction), mNumer(std::move(n)), mDenom(std::move(d)), mBar(bar)
   {
 
   }
 
-  bool isFraction() const override;
-
   inline const MathList & numer() const { return mNumer; }
   inline const MathList & denom() const { return mDenom; }
   inline bool hasBar() const { return mBar; }
@@ -5,6 +5,7 @@
 #ifndef LIBTYPESET_MATH_TYPESET_H
 #define LIBTYPESET_MATH_TYPESET_H
 
+#include "tex/nodearena.h"
 #include "tex/typeset.h"
 #include "tex/math/mathlist.h"
 #include "tex/math/style.h"
@@ -18,6 +19,7 @@ class Atom;
 } // namespace math
 
 class Kern;
+class Rule;
 
 class HBox;
 class VBox;
@@ -37,10 +39,11 @@ private:
   int m_relpenalty = 500;
   int m_binoppenalty = 700;
   bool m_insert_penalties = true;
-  std::shared_ptr<Glue> m_baselineskip;
-  std::shared_ptr<Glue> m_lineskip;
+  NodeRef<Glue> m_baselineskip;
+  NodeRef<Glue> m_lineskip;
   math::Style m_current_style = math::Style::D;
-  std::shared_ptr<math::Atom> m_most_recent_atom;
+  NodeRef<math::Atom> m_most_recent_atom;
+  std::shared_ptr<NodeArena> m_arena;
 
 public:
   explicit MathTypesetter(std::shared_ptr<TypesetEngine> engine);
@@ -59,6 +62,9 @@ public:
   bool insertPenalties() const;
   void setInsertPenalties(bool on = true);
 
+  const std::shared_ptr<NodeArena>& arena() const;
+  void setArena(std::shared_ptr<NodeArena> arena);
+
   List mlist2hlist(MathList mlist, math::Style style = math::Style::D);
 
 private:
@@ -80,18 +86,30 @@ private:
   template<size_t I>
   float sigma(math::Style style) const;
 
-  static std::shared_ptr<Box> nullbox();
+  static NodeRef<Box> nullbox();
+
+  template<typename T, typename...Args>
+  NodeRef<T> make(Args&&... args)
+  {
+    return make_node<T>(m_arena.get(), std::forward<Args>(args)...);
+  }
+
+  NodeRef<Kern> kern(float space);
+  NodeRef<Rule> hrule(float width, float height, float depth = 0.f);
+  NodeRef<HBox> hbox(List&& hlist);
+  NodeRef<HBox> hbox(List&& hlist, float width);
+  NodeRef<VBox> vbox(List&& vlist);
   
-  std::shared_ptr<Box> typeset(std::shared_ptr<MathSymbol> symbol);
-  std::shared_ptr<Box> typesetDelimiter(const std::shared_ptr<Symbol>& ms, float minTotalHeight);
-  std::shared_ptr<VBox> radicalSignBox(float minTotalHeight);
-  std::shared_ptr<Box> boxit(std::shared_ptr<Node> node);
-  std::shared_ptr<Box> boxit(std::shared_ptr<Node> node, math::Style s);
-  std::shared_ptr<HBox> boxit(MathList mlist);
-  std::shared_ptr<HBox> boxit(MathList mlist, math::Style s);
-  std::shared_ptr<HBox> hboxit(std::shared_ptr<Node> node);
-  std::shared_ptr<Box> mathstrut();
-  std::shared_ptr<Kern> quad();
+  NodeRef<Box> typeset(NodeRef<MathSymbol> symbol);
+  NodeRef<Box> typesetDelimiter(const NodeRef<Symbol>& ms, float minTotalHeight);
+  NodeRef<VBox> radicalSignBox(float minTotalHeight);
+  NodeRef<Box> boxit(NodeRef<Node> node);
+  NodeRef<Box> boxit(NodeRef<Node> node, math::Style s);
+  NodeRef<HBox> boxit(MathList mlist);
+  NodeRef<HBox> boxit(MathList mlist, math::Style s);
+  NodeRef<HBox> hboxit(NodeRef<Node> node);
+  NodeRef<Box> mathstrut();
+  NodeRef<Kern> quad();
 
   void preprocess(MathList& mlist);
 
@@ -106,17 +124,17 @@ private:
   void rule16_changeToOrd(MathList& mlist, MathList::iterator& current);
   void rule14(MathList& mlist, MathList::iterator& current);
   void rule17_processatom(MathList& mlist, MathList::iterator& current);
-  bool isCharacterBox(const std::shared_ptr<Node>& node, float* w = nullptr, float* h = nullptr, float* d = nullptr);
+  bool isCharacterBox(const NodeRef<Node>& node, float* w = nullptr, float* h = nullptr, float* d = nullptr);
   void attachSubSup(MathList& mlist, MathList::iterator& current);
   void rule15_fraction(MathList& mlist, MathList::iterator& current);
   void processRoot(MathList& mlist, MathList::iterator& current);
   void processMatrix(MathList& mlist, MathList::iterator& current);
   void processBoundary(MathList& mlist);
 
-  void insertSpace(List& list, const std::shared_ptr<math::Atom>& preceding, const std::shared_ptr<math::Atom>& next);
-  std::shared_ptr<Glue> thinmuskip();
-  std::shared_ptr<Glue> medmuskip();
-  std::shared_ptr<Glue> thickmuskip();
+  void insertSpace(List& list, const NodeRef<math::Atom>& preceding, const NodeRef<math::Atom>& next);
+  NodeRef<Glue> thinmuskip();
+  NodeRef<Glue> medmuskip();
+  NodeRef<Glue> thickmuskip();
 };
 
 } // namespace tex
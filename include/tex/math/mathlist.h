@@ -18,12 +18,10 @@ class LIBTYPESET_API MathList : public List
 class LIBTYPESET_API MathListNode : public Node
 {
 public:
-  MathListNode() = default;
-  MathListNode(MathList && list) : mList(std::move(list)) { }
+  MathListNode() : Node(NodeKind::MathList) { }
+  MathListNode(MathList && list) : Node(NodeKind::MathList), mList(std::move(list)) { }
   ~MathListNode() = default;
 
-  bool isMathList() const override { return true; }
-
   inline MathList & list() { return mList; }
   inline const MathList & list() const { return mList; }
 
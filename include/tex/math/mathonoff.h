@@ -13,14 +13,14 @@ namespace tex
 class LIBTYPESET_API MathOn : public Node
 {
 public:
-  MathOn() = default;
+  MathOn() : Node(NodeKind::MathOn) { }
   ~MathOn() = default;
 };
 
 class LIBTYPESET_API MathOff : public Node
 {
 public:
-  MathOff() = default;
+  MathOff() : Node(NodeKind::MathOff) { }
   ~MathOff() = default;
 };
 
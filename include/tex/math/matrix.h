@@ -20,8 +20,6 @@ class LIBTYPESET_API Matrix : public Node
 public:
   Matrix(std::vector<MathList> elems, size_t cols);
 
-  bool isMatrix() const override;
-
   size_t cols() const;
   size_t rows() const;
 
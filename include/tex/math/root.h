@@ -16,17 +16,15 @@ namespace math
 class LIBTYPESET_API Root : public Node
 {
 public:
-  Root() = default;
+  Root() : Node(NodeKind::Root) { }
   ~Root() = default;
 
   Root(MathList && deg, MathList && rad)
-    : mDegree(std::move(deg)), mRadicand(std::move(rad))
+    : Node(NodeKind::Root), mDegree(std::move(deg)), mRadicand(std::move(rad))
   {
 
   }
 
-  bool isRoot() const override { return true; }
-
   inline const MathList & degree() const { return mDegree; }
   inline const MathList & radicand() const { return mRadicand; }
 
@@ -21,7 +21,8 @@ private:
 
 public:
   StyleChange(math::Style s)
-    : m_style(s)
+    : Node(NodeKind::StyleChange),
+      m_style(s)
   {
 
   }
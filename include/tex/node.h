@@ -5,14 +5,60 @@
 #ifndef LIBTYPESET_NODE_H
 #define LIBTYPESET_NODE_H
 
-#include "tex/defs.h"
+#include "tex/noderef.h"
 
 #include <memory>
+#include <type_traits>
 #include <typeinfo>
 
 namespace tex
 {
 
+struct NodeArenaStorage;
+
+/*!
+ * \enum NodeKind
+ * \brief Identifies the concrete type of a node
+ *
+ * Kinds belonging to a same class hierarchy are contiguous so that
+ * a test against a base class reduces to a range check.
+ */
+enum class NodeKind : unsigned char
+{
+  Node,
+  Glue,
+  Kern,
+  Penalty,
+  Discretionary,
+  /* Box kinds */
+  Box,
+  CharacterBox,
+  GlyphRun,
+  Rule,
+  HBox,
+  VBox,
+  /* Symbol kinds */
+  Symbol,
+  TextSymbol,
+  MathSymbol,
+  /* Math kinds */
+  Atom,
+  Boundary,
+  MathList,
+  Fraction,
+  Root,
+  Matrix,
+  MathOn,
+  MathOff,
+  StyleChange,
+};
+
+template<typename T>
+struct node_kind_traits
+{
+  static constexpr bool tagged = false;
+};
+
 class LIBTYPESET_API Node
 {
 public:
@@ -20,10 +66,12 @@ public:
   Node(const Node &) = delete;
   virtual ~Node() = default;
 
+  NodeKind kind() const { return m_kind; }
+
   template<typename T>
   bool is() const
   {
-    return typeid(T).hash_code() == typeid(*this).hash_code();
+    return is_impl<T>(std::integral_constant<bool, node_kind_traits<T>::tagged>());
   }
 
   template<typename T>
@@ -38,30 +86,159 @@ public:
     return *static_cast<const T*>(this);
   }
 
-  virtual bool isBox() const;
-  bool isGlue() const;
-  bool isKern() const;
-  bool isPenalty() const;
-  bool isGlueOrKern() const;
-  virtual bool isCharacterBox() const;
-  virtual bool isHBox() const;
-  virtual bool isVBox() const;
-  bool isListBox() const;
-  virtual bool isMathSymbol() const;
-  virtual bool isAtom() const;
-  virtual bool isBoundary() const;
-  virtual bool isMathList() const;
-  virtual bool isFraction() const;
-  virtual bool isRoot() const;
-  virtual bool isMatrix() const;
+  bool isBox() const { return is_in(NodeKind::Box, NodeKind::VBox); }
+  bool isGlue() const { return m_kind == NodeKind::Glue; }
+  bool isKern() const { return m_kind == NodeKind::Kern; }
+  bool isPenalty() const { return m_kind == NodeKind::Penalty; }
+  bool isDiscretionary() const { return m_kind == NodeKind::Discretionary; }
+  bool isGlueOrKern() const { return is_in(NodeKind::Glue, NodeKind::Kern); }
+  bool isDiscardable() const { return is_in(NodeKind::Glue, NodeKind::Penalty); }
+  bool isCharacterBox() const { return m_kind == NodeKind::CharacterBox; }
+  bool isGlyphRun() const { return m_kind == NodeKind::GlyphRun; }
+  bool isHBox() const { return m_kind == NodeKind::HBox; }
+  bool isVBox() const { return m_kind == NodeKind::VBox; }
+  bool isListBox() const { return is_in(NodeKind::HBox, NodeKind::VBox); }
+  bool isMathSymbol() const { return m_kind == NodeKind::MathSymbol; }
+  bool isAtom() const { return m_kind == NodeKind::Atom; }
+  bool isBoundary() const { return m_kind == NodeKind::Boundary; }
+  bool isMathList() const { return m_kind == NodeKind::MathList; }
+  bool isFraction() const { return m_kind == NodeKind::Fraction; }
+  bool isRoot() const { return m_kind == NodeKind::Root; }
+  bool isMatrix() const { return m_kind == NodeKind::Matrix; }
+
+protected:
+  explicit Node(NodeKind k) : m_kind(k) { }
+
+private:
+  bool is_in(NodeKind first, NodeKind last) const
+  {
+    return first <= m_kind && m_kind <= last;
+  }
+
+  template<typename T>
+  bool is_impl(std::true_type) const
+  {
+    return is_in(node_kind_traits<T>::first, node_kind_traits<T>::last);
+  }
+
+  template<typename T>
+  bool is_impl(std::false_type) const
+  {
+    return typeid(T).hash_code() == typeid(*this).hash_code();
+  }
+
+private:
+#if defined(LIBTYPESET_INTRUSIVE_REFCOUNT)
+  template<typename T>
+  friend class NodeRef;
+  friend class NodeArena;
+
+  void retain() const { ++m_refcount; }
+  void release() const { if (--m_refcount == 0) destroy(); }
+  void destroy() const;
+
+  mutable unsigned int m_refcount = 0;
+#endif // defined(LIBTYPESET_INTRUSIVE_REFCOUNT)
+  NodeKind m_kind = NodeKind::Node;
+#if defined(LIBTYPESET_INTRUSIVE_REFCOUNT)
+  NodeArenaStorage* m_arena = nullptr;
+#endif // defined(LIBTYPESET_INTRUSIVE_REFCOUNT)
 };
 
+#if defined(LIBTYPESET_INTRUSIVE_REFCOUNT)
+
+template<typename T>
+inline long NodeRef<T>::use_count() const noexcept
+{
+  return m_node ? static_cast<long>(m_node->m_refcount) : 0;
+}
+
+template<typename T>
+inline void NodeRef<T>::retain() noexcept
+{
+  if (m_node)
+    m_node->retain();
+}
+
+template<typename T>
+inline void NodeRef<T>::release() noexcept
+{
+  if (m_node)
+    m_node->release();
+}
+
+#endif // defined(LIBTYPESET_INTRUSIVE_REFCOUNT)
+
 template<typename T, typename U = Node>
-std::shared_ptr<T> cast(const std::shared_ptr<U> & node)
+NodeRef<T> cast(const NodeRef<U> & node)
 {
-  return std::static_pointer_cast<T>(node);
+  return static_pointer_cast<T>(node);
 }
 
+class Glue;
+class Kern;
+class Penalty;
+class Discretionary;
+class Box;
+class CharacterBox;
+class GlyphRun;
+class Rule;
+class ListBox;
+class HBox;
+class VBox;
+class Symbol;
+class TextSymbol;
+class MathSymbol;
+class MathListNode;
+class MathOn;
+class MathOff;
+
+namespace math
+{
+class Atom;
+class Boundary;
+class Fraction;
+class Root;
+class Matrix;
+class StyleChange;
+} // namespace math
+
+#define LIBTYPESET_NODE_KIND_RANGE(T, First, Last) \
+  template<> struct node_kind_traits<T> { \
+    static constexpr bool tagged = true; \
+    static constexpr NodeKind first = NodeKind::First; \
+    static constexpr NodeKind last = NodeKind::Last; \
+  }
+
+#define LIBTYPESET_NODE_KIND(T, K) LIBTYPESET_NODE_KIND_RANGE(T, K, K)
+
+LIBTYPESET_NODE_KIND(Glue, Glue);
+LIBTYPESET_NODE_KIND(Kern, Kern);
+LIBTYPESET_NODE_KIND(Penalty, Penalty);
+LIBTYPESET_NODE_KIND(Discretionary, Discretionary);
+LIBTYPESET_NODE_KIND_RANGE(Box, Box, VBox);
+LIBTYPESET_NODE_KIND(CharacterBox, CharacterBox);
+LIBTYPESET_NODE_KIND(GlyphRun, GlyphRun);
+LIBTYPESET_NODE_KIND(Rule, Rule);
+LIBTYPESET_NODE_KIND_RANGE(ListBox, HBox, VBox);
+LIBTYPESET_NODE_KIND(HBox, HBox);
+LIBTYPESET_NODE_KIND(VBox, VBox);
+LIBTYPESET_NODE_KIND_RANGE(Symbol, Symbol, MathSymbol);
+LIBTYPESET_NODE_KIND(TextSymbol, TextSymbol);
+LIBTYPESET_NODE_KIND(MathSymbol, MathSymbol);
+LIBTYPESET_NODE_KIND(MathListNode, MathList);
+LIBTYPESET_NODE_KIND(MathOn, MathOn);
+LIBTYPESET_NODE_KIND(MathOff, MathOff);
+LIBTYPESET_NODE_KIND(math::Atom, Atom);
+LIBTYPESET_NODE_KIND(math::Boundary, Boundary);
+LIBTYPESET_NODE_KIND(math::Fraction, Fraction);
+LIBTYPESET_NODE_KIND(math::Root, Root);
+LIBTYPESET_NODE_KIND(math::Matrix, Matrix);
+LIBTYPESET_NODE_KIND(math::StyleChange, StyleChange);
+
+#undef LIBTYPESET_NODE_KIND
+#undef LIBTYPESET_NODE_KIND_RANGE
+
 } // namespace tex
 
 #endif // LIBTYPESET_NODE_H
@@ -0,0 +1,133 @@
+// Copyright (C) 2020 Vincent Chambrin
+// This file is part of the 'typeset' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#ifndef LIBTYPESET_NODEARENA_H
+#define LIBTYPESET_NODEARENA_H
+
+#include "tex/noderef.h"
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace tex
+{
+
+class Node;
+struct NodeArenaStorage;
+
+/*!
+ * \class NodeArena
+ * \brief Bump allocator for nodes
+ *
+ * Nodes created through an arena share a few large memory blocks instead of
+ * each having their own heap allocation (the shared_ptr control block lives
+ * next to the node in the same block).
+ * Memory is never reused: it is released all at once when both the arena and
+ * every node allocated from it have been destroyed.
+ *
+ * An arena is not thread-safe; it is meant to be owned by a single document or
+ * paragraph being typeset.
+ *
+ * With \c LIBTYPESET_INTRUSIVE_REFCOUNT, nodes are constructed directly in the
+ * arena's blocks and keep a pointer to the arena's storage instead of an
+ * allocator.
+ */
+class LIBTYPESET_API NodeArena
+{
+public:
+  static constexpr size_t DefaultBlockSize = 64 * 1024;
+
+  explicit NodeArena(size_t blocksize = DefaultBlockSize);
+  NodeArena(const NodeArena &) = delete;
+  ~NodeArena();
+
+  size_t blockCount() const;
+  size_t bytesUsed() const;
+
+  typedef NodeArenaStorage Storage;
+
+  template<typename T>
+  class Allocator
+  {
+  public:
+    typedef T value_type;
+
+    explicit Allocator(std::shared_ptr<Storage> s) : m_storage(std::move(s)) { }
+
+    template<typename U>
+    Allocator(const Allocator<U>& other) : m_storage(other.storage()) { }
+
+    T* allocate(size_t n)
+    {
+      return static_cast<T*>(NodeArena::allocate(*m_storage, n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T*, size_t) { }
+
+    const std::shared_ptr<Storage>& storage() const { return m_storage; }
+
+  private:
+    std::shared_ptr<Storage> m_storage;
+  };
+
+#if defined(LIBTYPESET_INTRUSIVE_REFCOUNT)
+  template<typename T, typename...Args>
+  NodeRef<T> make(Args&&... args)
+  {
+    T* node = new (allocate(*m_storage, sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    attach(*node);
+    return NodeRef<T>(node);
+  }
+#else
+  template<typename T, typename...Args>
+  NodeRef<T> make(Args&&... args)
+  {
+    return std::allocate_shared<T>(Allocator<T>(m_storage), std::forward<Args>(args)...);
+  }
+#endif // defined(LIBTYPESET_INTRUSIVE_REFCOUNT)
+
+  NodeArena & operator=(const NodeArena &) = delete;
+
+private:
+  static void* allocate(Storage& storage, size_t size, size_t alignment);
+  static void release(Storage* storage);
+
+#if defined(LIBTYPESET_INTRUSIVE_REFCOUNT)
+  friend class Node;
+  void attach(Node& node);
+#endif // defined(LIBTYPESET_INTRUSIVE_REFCOUNT)
+
+private:
+  std::shared_ptr<Storage> m_storage;
+};
+
+template<typename T, typename U>
+bool operator==(const NodeArena::Allocator<T>& lhs, const NodeArena::Allocator<U>& rhs)
+{
+  return lhs.storage() == rhs.storage();
+}
+
+template<typename T, typename U>
+bool operator!=(const NodeArena::Allocator<T>& lhs, const NodeArena::Allocator<U>& rhs)
+{
+  return lhs.storage() != rhs.storage();
+}
+
+/*!
+ * \fn NodeRef<T> make_node(NodeArena* arena, Args&&... args)
+ * \brief Creates a node in \a arena, or on the heap if \a arena is null
+ */
+template<typename T, typename...Args>
+NodeRef<T> make_node(NodeArena* arena, Args&&... args)
+{
+  if (arena)
+    return arena->make<T>(std::forward<Args>(args)...);
+  return make_node<T>(std::forward<Args>(args)...);
+}
+
+} // namespace tex
+
+#endif // LIBTYPESET_NODEARENA_H
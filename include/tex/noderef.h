@@ -0,0 +1,204 @@
+// Copyright (C) 2020 Vincent Chambrin
+// This file is part of the 'typeset' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#ifndef LIBTYPESET_NODEREF_H
+#define LIBTYPESET_NODEREF_H
+
+#include "tex/defs.h"
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace tex
+{
+
+class Node;
+
+#if defined(LIBTYPESET_INTRUSIVE_REFCOUNT)
+
+/*!
+ * \class NodeRef
+ * \brief Owning handle to a node
+ *
+ * When the library is built with \c LIBTYPESET_INTRUSIVE_REFCOUNT, nodes carry
+ * their own (non-atomic) reference count and NodeRef is a minimal replacement
+ * for \c std::shared_ptr with the same interface.
+ * Nodes, and the lists that contain them, must then not be shared between threads.
+ *
+ * Otherwise, NodeRef is an alias for \c std::shared_ptr.
+ */
+template<typename T>
+class NodeRef
+{
+public:
+  typedef T element_type;
+
+  constexpr NodeRef() noexcept = default;
+  constexpr NodeRef(std::nullptr_t) noexcept { }
+
+  explicit NodeRef(T* ptr) noexcept
+    : m_node(const_cast<std::remove_const_t<T>*>(ptr))
+  {
+    retain();
+  }
+
+  NodeRef(const NodeRef& other) noexcept
+    : m_node(other.m_node)
+  {
+    retain();
+  }
+
+  NodeRef(NodeRef&& other) noexcept
+    : m_node(other.m_node)
+  {
+    other.m_node = nullptr;
+  }
+
+  template<typename U, typename = std::enable_if_t<std::is_convertible<U*, T*>::value>>
+  NodeRef(const NodeRef<U>& other) noexcept
+    : m_node(other.m_node)
+  {
+    retain();
+  }
+
+  template<typename U, typename = std::enable_if_t<std::is_convertible<U*, T*>::value>>
+  NodeRef(NodeRef<U>&& other) noexcept
+    : m_node(other.m_node)
+  {
+    other.m_node = nullptr;
+  }
+
+  ~NodeRef()
+  {
+    release();
+  }
+
+  T* get() const noexcept { return static_cast<T*>(m_node); }
+  T& operator*() const noexcept { return *get(); }
+  T* operator->() const noexcept { return get(); }
+  explicit operator bool() const noexcept { return m_node != nullptr; }
+
+  long use_count() const noexcept;
+
+  void reset() noexcept
+  {
+    NodeRef().swap(*this);
+  }
+
+  void reset(T* ptr) noexcept
+  {
+    NodeRef(ptr).swap(*this);
+  }
+
+  void swap(NodeRef& other) noexcept
+  {
+    std::swap(m_node, other.m_node);
+  }
+
+  NodeRef& operator=(const NodeRef& other) noexcept
+  {
+    NodeRef(other).swap(*this);
+    return *this;
+  }
+
+  NodeRef& operator=(NodeRef&& other) noexcept
+  {
+    NodeRef(std::move(other)).swap(*this);
+    return *this;
+  }
+
+  template<typename U>
+  NodeRef& operator=(const NodeRef<U>& other) noexcept
+  {
+    NodeRef(other).swap(*this);
+    return *this;
+  }
+
+  template<typename U>
+  NodeRef& operator=(NodeRef<U>&& other) noexcept
+  {
+    NodeRef(std::move(other)).swap(*this);
+    return *this;
+  }
+
+  NodeRef& operator=(std::nullptr_t) noexcept
+  {
+    reset();
+    return *this;
+  }
+
+private:
+  template<typename U>
+  friend class NodeRef;
+
+  void retain() noexcept;
+  void release() noexcept;
+
+private:
+  Node* m_node = nullptr;
+};
+
+template<typename T, typename U>
+bool operator==(const NodeRef<T>& lhs, const NodeRef<U>& rhs) noexcept { return lhs.get() == rhs.get(); }
+template<typename T, typename U>
+bool operator!=(const NodeRef<T>& lhs, const NodeRef<U>& rhs) noexcept { return lhs.get() != rhs.get(); }
+template<typename T>
+bool operator==(const NodeRef<T>& lhs, std::nullptr_t) noexcept { return !lhs; }
+template<typename T>
+bool operator==(std::nullptr_t, const NodeRef<T>& rhs) noexcept { return !rhs; }
+template<typename T>
+bool operator!=(const NodeRef<T>& lhs, std::nullptr_t) noexcept { return static_cast<bool>(lhs); }
+template<typename T>
+bool operator!=(std::nullptr_t, const NodeRef<T>& rhs) noexcept { return static_cast<bool>(rhs); }
+
+template<typename T, typename U>
+NodeRef<T> static_pointer_cast(const NodeRef<U>& node) noexcept
+{
+  return NodeRef<T>(static_cast<T*>(node.get()));
+}
+
+template<typename T, typename U>
+NodeRef<T> dynamic_pointer_cast(const NodeRef<U>& node) noexcept
+{
+  return NodeRef<T>(dynamic_cast<T*>(node.get()));
+}
+
+template<typename T, typename U>
+NodeRef<T> const_pointer_cast(const NodeRef<U>& node) noexcept
+{
+  return NodeRef<T>(const_cast<T*>(node.get()));
+}
+
+/*!
+ * \fn NodeRef<T> make_node(Args&&... args)
+ * \brief Creates a node on the heap
+ */
+template<typename T, typename...Args>
+NodeRef<T> make_node(Args&&... args)
+{
+  return NodeRef<T>(new T(std::forward<Args>(args)...));
+}
+
+#else
+
+template<typename T>
+using NodeRef = std::shared_ptr<T>;
+
+template<typename T, typename...Args>
+NodeRef<T> make_node(Args&&... args)
+{
+  return std::make_shared<T>(std::forward<Args>(args)...);
+}
+
+#endif // defined(LIBTYPESET_INTRUSIVE_REFCOUNT)
+
+using std::static_pointer_cast;
+using std::dynamic_pointer_cast;
+using std::const_pointer_cast;
+
+} // namespace tex
+
+#endif // LIBTYPESET_NODEREF_H
@@ -0,0 +1,89 @@
+// Copyright (C) 2020 Vincent Chambrin
+// This file is part of the 'typeset' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#ifndef LIBTYPESET_PAGEBUILDER_H
+#define LIBTYPESET_PAGEBUILDER_H
+
+#include "tex/glue.h"
+#include "tex/scaled.h"
+#include "tex/vbox.h"
+
+#include <functional>
+
+namespace tex
+{
+
+class NodeArena;
+
+/*!
+ * \class PageBuilder
+ * \brief Breaks a vertical list into pages as it is being built
+ *
+ * Nodes are contributed one at a time with push_back(); as in TeX, each
+ * legal breakpoint is given a cost from the badness of the page and the
+ * penalty of the break, and a page is emitted to \c output as soon as
+ * it cannot get any better (the page is overfull or a break is forced).
+ * The page is broken at its cheapest breakpoint and the nodes that follow
+ * are contributed again to the next page.
+ *
+ * Only the current page and the nodes contributed after its best breakpoint
+ * are kept, so memory does not grow with the length of the document.
+ * Discardable nodes at the top of a page are removed, and \c topskip is
+ * inserted before the first box of each page.
+ */
+class LIBTYPESET_API PageBuilder
+{
+public:
+  float vsize = 800.f;
+  float maxdepth = 4.f;
+  NodeRef<Glue> topskip;
+  std::shared_ptr<NodeArena> arena;
+  std::function<void(NodeRef<VBox>)> output;
+
+  struct Statistics
+  {
+    size_t pages = 0;
+    size_t peak = 0;
+  };
+
+  Statistics statistics;
+
+public:
+  PageBuilder();
+  explicit PageBuilder(std::function<void(NodeRef<VBox>)> output_);
+  PageBuilder(const PageBuilder&) = delete;
+  ~PageBuilder();
+
+  using Cost = int64_t;
+
+  void push_back(const NodeRef<Node>& node);
+  void push_back(const List& vlist);
+  void finish();
+
+  const List& page() const { return m_page; }
+  const List& contributions() const { return m_contributions; }
+
+  PageBuilder& operator=(const PageBuilder&) = delete;
+
+protected:
+  void build();
+  bool tryBreak(List::iterator p, int pi);
+  void fireUp();
+  void resetPage();
+
+private:
+  List m_page;
+  List m_contributions;
+  bool m_has_box = false;
+  Dimension m_total = 0;
+  Dimension m_depth = 0;
+  Dimension m_stretch[4];
+  Dimension m_shrink = 0;
+  List::iterator m_best;
+  Cost m_least_cost;
+};
+
+} // namespace tex
+
+#endif // LIBTYPESET_PAGEBUILDER_H
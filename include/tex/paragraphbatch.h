@@ -0,0 +1,67 @@
+// Copyright (C) 2020 Vincent Chambrin
+// This file is part of the 'typeset' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#ifndef LIBTYPESET_PARAGRAPHBATCH_H
+#define LIBTYPESET_PARAGRAPHBATCH_H
+
+#include "tex/linebreaks.h"
+
+#include <exception>
+#include <memory>
+#include <vector>
+
+namespace tex
+{
+
+class HListView;
+
+/*!
+ * \class ParagraphBatch
+ * \brief Breaks many paragraphs concurrently
+ *
+ * The breakpoints of the paragraphs are computed on a pool of threads that
+ * steal work from each other; this only reads the nodes of the lists.
+ * The lines are then created on the calling thread, in input order, so that
+ * the batch is usable when nodes are shared between paragraphs (e.g. interword
+ * glue) and have a non-atomic reference count.
+ *
+ * As with Paragraph::create(), the lists must have been prepared.
+ */
+class LIBTYPESET_API ParagraphBatch
+{
+public:
+  explicit ParagraphBatch(size_t threads = 0);
+  ParagraphBatch(const ParagraphBatch&) = delete;
+  ~ParagraphBatch();
+
+  size_t threads() const { return m_threads; }
+
+  size_t add(Paragraph paragraph, List hlist);
+  size_t size() const { return m_items.size(); }
+  bool empty() const { return m_items.empty(); }
+
+  std::vector<List> run();
+
+  ParagraphBatch& operator=(const ParagraphBatch&) = delete;
+
+protected:
+  void computeBreaks(size_t i);
+
+private:
+  struct Item
+  {
+    Paragraph paragraph;
+    List hlist;
+    std::unique_ptr<HListView> view;
+    std::vector<size_t> breaks;
+    std::exception_ptr error;
+  };
+
+  size_t m_threads;
+  std::vector<Item> m_items;
+};
+
+} // namespace tex
+
+#endif // LIBTYPESET_PARAGRAPHBATCH_H
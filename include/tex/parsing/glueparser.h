@@ -53,7 +53,7 @@ public:
 
   void write(char c);
 
-  std::shared_ptr<Glue> finish();
+  NodeRef<Glue> finish();
 
 protected:
 
@@ -42,7 +42,7 @@ public:
   void write(char c);
 
   bool isFinished();
-  std::shared_ptr<Kern> finish();
+  NodeRef<Kern> finish();
 
 protected:
 };
@@ -27,30 +27,30 @@ class LIBTYPESET_API AtomBuilder
 public:
   math::Atom::Type type = math::Atom::Ord;
   math::Atom::LimitsFlag limits = math::Atom::NoLimits;
-  std::shared_ptr<Node> nucleus_;
-  std::shared_ptr<Node> superscript_;
-  std::shared_ptr<Node> subscript_;
+  NodeRef<Node> nucleus_;
+  NodeRef<Node> superscript_;
+  NodeRef<Node> subscript_;
 
 public:
   AtomBuilder();
   explicit AtomBuilder(math::Atom::Type t);
 
-  const std::shared_ptr<Node>& nucleus() const { return nucleus_; }
-  const std::shared_ptr<Node>& superscript() const { return superscript_; }
-  const std::shared_ptr<Node>& subscript() const { return subscript_; }
+  const NodeRef<Node>& nucleus() const { return nucleus_; }
+  const NodeRef<Node>& superscript() const { return superscript_; }
+  const NodeRef<Node>& subscript() const { return subscript_; }
 
-  AtomBuilder& setNucleus(const std::shared_ptr<Node>& node);
-  AtomBuilder& setSuperscript(const std::shared_ptr<Node>& node);
-  AtomBuilder& setSubscript(const std::shared_ptr<Node>& node);
+  AtomBuilder& setNucleus(const NodeRef<Node>& node);
+  AtomBuilder& setSuperscript(const NodeRef<Node>& node);
+  AtomBuilder& setSubscript(const NodeRef<Node>& node);
 
-  std::shared_ptr<math::Atom> build() const;
+  NodeRef<math::Atom> build() const;
 };
 
 struct LIBTYPESET_API MatrixBuilder
 {
   struct Row
   {
-    std::vector<std::shared_ptr<MathListNode>> cells;
+    std::vector<NodeRef<MathListNode>> cells;
 
     MathList& newCell();
   };
@@ -60,7 +60,7 @@ struct LIBTYPESET_API MatrixBuilder
   Row& newRow();
   Row& lastRow();
 
-  std::shared_ptr<Node> build() const;
+  NodeRef<Node> build() const;
 };
 
 class LIBTYPESET_API MathParser
@@ -102,9 +102,9 @@ public:
   State state() const;
   const std::vector<State>& states() const;
 
-  void writeSymbol(std::shared_ptr<MathSymbol> mathsym);
+  void writeSymbol(NodeRef<MathSymbol> mathsym);
 
-  void writeBox(const std::shared_ptr<tex::Box>& box);
+  void writeBox(const NodeRef<tex::Box>& box);
 
   void beginSuperscript();
   void beginSubscript();
@@ -142,25 +142,25 @@ protected:
 
   void pushList(MathList& l);
   void popList();
-  std::shared_ptr<MathListNode> pushMathList();
+  NodeRef<MathListNode> pushMathList();
 
   bool isParsingMList() const;
 
   /* Parsing procedures */
-  void parse_mlist(std::shared_ptr<MathSymbol> mathsym);
+  void parse_mlist(NodeRef<MathSymbol> mathsym);
 
-  void parse_atom(std::shared_ptr<MathSymbol> mathsym);
-  void parse_subsupscript(std::shared_ptr<MathSymbol> mathsym);
+  void parse_atom(NodeRef<MathSymbol> mathsym);
+  void parse_subsupscript(NodeRef<MathSymbol> mathsym);
 
-  void parse_left(std::shared_ptr<MathSymbol> mathsym);
-  void parse_right(std::shared_ptr<MathSymbol> mathsym);
+  void parse_left(NodeRef<MathSymbol> mathsym);
+  void parse_right(NodeRef<MathSymbol> mathsym);
 
-  void parse_sqrt(std::shared_ptr<MathSymbol> mathsym);
-  void parse_sqrt_degree(std::shared_ptr<MathSymbol> mathsym);
-  void parse_sqrt_radicand(std::shared_ptr<MathSymbol> mathsym);
+  void parse_sqrt(NodeRef<MathSymbol> mathsym);
+  void parse_sqrt_degree(NodeRef<MathSymbol> mathsym);
+  void parse_sqrt_radicand(NodeRef<MathSymbol> mathsym);
 
-  void parse_frac_numer(std::shared_ptr<MathSymbol> mathsym);
-  void parse_frac_denom(std::shared_ptr<MathSymbol> mathsym);
+  void parse_frac_numer(NodeRef<MathSymbol> mathsym);
+  void parse_frac_denom(NodeRef<MathSymbol> mathsym);
 
 private:
   std::vector<State> m_states;
@@ -51,9 +51,9 @@ public:
   void writeSymbol(Character c);
   void writeMathChar(Character c, MathCode mc);
 
-  void writeSymbol(std::shared_ptr<MathSymbol> mathsym);
+  void writeSymbol(NodeRef<MathSymbol> mathsym);
 
-  void writeBox(const std::shared_ptr<tex::Box>& box);
+  void writeBox(const NodeRef<tex::Box>& box);
 
   void beginSuperscript();
   void beginSubscript();
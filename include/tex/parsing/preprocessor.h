@@ -125,9 +125,33 @@ public:
   Preprocessor(Preprocessor&&) = delete;
   ~Preprocessor() = default;
 
+  struct SavedMacro
+  {
+    std::string csname;
+    bool defined;
+    Macro macro;
+    size_t level;
+  };
+
+  /*!
+   * \struct Definitions
+   * \brief The macros currently defined and the save stack of the enclosing groups
+   *
+   * As in TeX, a definition made inside a group saves the previous meaning
+   * of the control sequence, once per group, and endGroup() restores the
+   * saved meanings; entering and leaving a group therefore costs only the
+   * number of definitions made inside it.
+   * Like TeX's eqtb, \a levels records the group level at which each
+   * control sequence was last defined (control sequences defined outside
+   * of any group are omitted), so that whether a meaning was already saved
+   * in the current group is a single lookup.
+   */
   struct Definitions
   {
     std::map<std::string, Macro> macros;
+    std::map<std::string, size_t> levels;
+    std::vector<SavedMacro> savestack;
+    std::vector<size_t> groups;
   };
 
   typedef std::array<std::vector<Token>, 9> Arguments;
@@ -201,7 +225,9 @@ public:
   const Macro* find(const std::string& cs) const;
   void define(Macro m);
 
-  const std::list<Definitions>& macros() const;
+  const std::map<std::string, Macro>& macros() const;
+  const Definitions& definitions() const;
+  void reset(Definitions defs);
 
   Preprocessor& operator=(const Preprocessor&) = delete;
 
@@ -228,7 +254,7 @@ protected:
   void expandafter(Token& tok);
 
 private:
-  std::list<Definitions> m_defs;
+  Definitions m_defs;
   State m_state;
 };
 
@@ -274,12 +300,7 @@ inline const std::vector<Token>& Macro::replacementText() const
 
 inline void Preprocessor::beginGroup()
 {
-  m_defs.push_front(Definitions{});
-}
-
-inline void Preprocessor::endGroup()
-{
-  m_defs.pop_front();
+  m_defs.groups.push_back(m_defs.savestack.size());
 }
 
 inline void Preprocessor::write(Token t)
@@ -295,7 +316,12 @@ inline const Preprocessor::State& Preprocessor::state() const
   return m_state;
 }
 
-inline const std::list<Preprocessor::Definitions>& Preprocessor::macros() const
+inline const std::map<std::string, Macro>& Preprocessor::macros() const
+{
+  return m_defs.macros;
+}
+
+inline const Preprocessor::Definitions& Preprocessor::definitions() const
 {
   return m_defs;
 }
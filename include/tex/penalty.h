@@ -26,8 +26,8 @@ protected:
   int mValue;
 };
 
-LIBTYPESET_API std::shared_ptr<Penalty> penalty(int p);
-LIBTYPESET_API std::shared_ptr<Penalty> infinitePenalty();
+LIBTYPESET_API NodeRef<Penalty> penalty(int p);
+LIBTYPESET_API NodeRef<Penalty> infinitePenalty();
 
 } // namespace tex
 
@@ -16,7 +16,7 @@ public:
   Rule(float w, float h, float d);
 };
 
-LIBTYPESET_API std::shared_ptr<Rule> hrule(float width, float height, float depth = 0.f);
+LIBTYPESET_API NodeRef<Rule> hrule(float width, float height, float depth = 0.f);
 
 } // namespace tex
 
@@ -0,0 +1,85 @@
+// Copyright (C) 2020 Vincent Chambrin
+// This file is part of the 'typeset' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#ifndef LIBTYPESET_SCALED_H
+#define LIBTYPESET_SCALED_H
+
+#include "tex/defs.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace tex
+{
+
+/*!
+ * \typedef Scaled
+ * \brief A dimension expressed in scaled points (sp), 65536sp = 1pt
+ */
+typedef int32_t Scaled;
+
+constexpr Scaled ScaledUnity = 65536;
+constexpr Scaled MaxDimen = 07777777777;
+constexpr int InfBad = 10'000;
+
+/*!
+ * \fn Scaled to_scaled(float pt)
+ * \brief Converts a dimension in points to the nearest number of scaled points
+ *
+ * The result is clamped to [-MaxDimen, MaxDimen].
+ */
+inline Scaled to_scaled(float pt)
+{
+  const float sp = std::round(pt * static_cast<float>(ScaledUnity));
+  return static_cast<Scaled>(std::max(-static_cast<float>(MaxDimen), std::min(sp, static_cast<float>(MaxDimen))));
+}
+
+inline float from_scaled(Scaled sp)
+{
+  return static_cast<float>(sp) / static_cast<float>(ScaledUnity);
+}
+
+LIBTYPESET_API int badness(Scaled t, Scaled s);
+
+/*!
+ * \typedef Dimension
+ * \brief The type used by the linebreaker to add up dimensions
+ *
+ * When the library is built with \c LIBTYPESET_SCALED_POINTS, this is Scaled
+ * and linebreaking only uses integer arithmetic, making the layout of a
+ * paragraph independent of the compiler and of the floating-point environment.
+ * Otherwise, this is \c float.
+ */
+#if defined(LIBTYPESET_SCALED_POINTS)
+typedef Scaled Dimension;
+
+inline Dimension to_dimension(float pt)
+{
+  return to_scaled(pt);
+}
+
+inline float from_dimension(Dimension d)
+{
+  return from_scaled(d);
+}
+
+#else
+typedef float Dimension;
+
+inline Dimension to_dimension(float pt)
+{
+  return pt;
+}
+
+inline float from_dimension(Dimension d)
+{
+  return d;
+}
+
+#endif // defined(LIBTYPESET_SCALED_POINTS)
+
+} // namespace tex
+
+#endif // LIBTYPESET_SCALED_H
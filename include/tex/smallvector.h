@@ -0,0 +1,301 @@
+// Copyright (C) 2020 Vincent Chambrin
+// This file is part of the 'typeset' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#ifndef LIBTYPESET_SMALLVECTOR_H
+#define LIBTYPESET_SMALLVECTOR_H
+
+#include "tex/defs.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace tex
+{
+
+/*!
+ * \class SmallVector
+ * \brief A vector that stores up to \a N elements without allocating
+ *
+ * Elements are contiguous. Like with \c std::vector, any insertion or removal
+ * invalidates iterators to the elements that follow, or to all elements if
+ * the vector has to grow.
+ */
+template<typename T, size_t N>
+class SmallVector
+{
+public:
+  typedef T value_type;
+  typedef size_t size_type;
+  typedef std::ptrdiff_t difference_type;
+  typedef T& reference;
+  typedef const T& const_reference;
+  typedef T* pointer;
+  typedef const T* const_pointer;
+  typedef T* iterator;
+  typedef const T* const_iterator;
+  typedef std::reverse_iterator<iterator> reverse_iterator;
+  typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+  static constexpr size_t InlineCapacity = N;
+
+  SmallVector() noexcept
+    : m_data(inlineData())
+  {
+
+  }
+
+  SmallVector(std::initializer_list<T> elems)
+    : SmallVector(elems.begin(), elems.end())
+  {
+
+  }
+
+  template<typename InputIt, typename = typename std::iterator_traits<InputIt>::iterator_category>
+  SmallVector(InputIt first, InputIt last)
+    : SmallVector()
+  {
+    insert(end(), first, last);
+  }
+
+  SmallVector(const SmallVector& other)
+    : SmallVector(other.begin(), other.end())
+  {
+
+  }
+
+  SmallVector(SmallVector&& other) noexcept
+    : SmallVector()
+  {
+    steal(other);
+  }
+
+  ~SmallVector()
+  {
+    clear();
+    deallocate();
+  }
+
+  iterator begin() noexcept { return m_data; }
+  const_iterator begin() const noexcept { return m_data; }
+  const_iterator cbegin() const noexcept { return m_data; }
+  iterator end() noexcept { return m_data + m_size; }
+  const_iterator end() const noexcept { return m_data + m_size; }
+  const_iterator cend() const noexcept { return m_data + m_size; }
+
+  reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+  const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+  reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+  const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+
+  bool empty() const noexcept { return m_size == 0; }
+  size_t size() const noexcept { return m_size; }
+  size_t capacity() const noexcept { return m_capacity; }
+  bool isInline() const noexcept { return m_data == inlineData(); }
+
+  T* data() noexcept { return m_data; }
+  const T* data() const noexcept { return m_data; }
+
+  T& operator[](size_t i) { return m_data[i]; }
+  const T& operator[](size_t i) const { return m_data[i]; }
+
+  T& front() { return m_data[0]; }
+  const T& front() const { return m_data[0]; }
+  T& back() { return m_data[m_size - 1]; }
+  const T& back() const { return m_data[m_size - 1]; }
+
+  void reserve(size_t n)
+  {
+    if (n > m_capacity)
+      reallocate(n);
+  }
+
+  void clear() noexcept
+  {
+    destroy(begin(), end());
+    m_size = 0;
+  }
+
+  template<typename...Args>
+  T& emplace_back(Args&&... args)
+  {
+    if (m_size == m_capacity)
+    {
+      T value(std::forward<Args>(args)...);
+      reallocate(m_capacity * 2);
+      new (end()) T(std::move(value));
+    }
+    else
+    {
+      new (end()) T(std::forward<Args>(args)...);
+    }
+
+    return m_data[m_size++];
+  }
+
+  void push_back(const T& value) { emplace_back(value); }
+  void push_back(T&& value) { emplace_back(std::move(value)); }
+
+  void pop_back()
+  {
+    m_data[--m_size].~T();
+  }
+
+  void push_front(const T& value) { insert(begin(), value); }
+  void push_front(T&& value) { insert(begin(), std::move(value)); }
+
+  iterator insert(const_iterator pos, const T& value)
+  {
+    const size_t index = pos - begin();
+    emplace_back(value);
+    std::rotate(begin() + index, end() - 1, end());
+    return begin() + index;
+  }
+
+  iterator insert(const_iterator pos, T&& value)
+  {
+    const size_t index = pos - begin();
+    emplace_back(std::move(value));
+    std::rotate(begin() + index, end() - 1, end());
+    return begin() + index;
+  }
+
+  template<typename InputIt, typename = typename std::iterator_traits<InputIt>::iterator_category>
+  iterator insert(const_iterator pos, InputIt first, InputIt last)
+  {
+    const size_t index = pos - begin();
+    const size_t old_size = m_size;
+
+    reserve_for(first, last, typename std::iterator_traits<InputIt>::iterator_category());
+
+    for (; first != last; ++first)
+      emplace_back(*first);
+
+    std::rotate(begin() + index, begin() + old_size, end());
+    return begin() + index;
+  }
+
+  iterator erase(const_iterator pos)
+  {
+    return erase(pos, pos + 1);
+  }
+
+  iterator erase(const_iterator first, const_iterator last)
+  {
+    iterator f = begin() + (first - begin());
+    iterator l = begin() + (last - begin());
+    iterator new_end = std::move(l, end(), f);
+    destroy(new_end, end());
+    m_size -= (l - f);
+    return f;
+  }
+
+  SmallVector& operator=(const SmallVector& other)
+  {
+    if (this != &other)
+    {
+      clear();
+      insert(end(), other.begin(), other.end());
+    }
+
+    return *this;
+  }
+
+  SmallVector& operator=(SmallVector&& other) noexcept
+  {
+    if (this != &other)
+    {
+      clear();
+      deallocate();
+      steal(other);
+    }
+
+    return *this;
+  }
+
+private:
+  T* inlineData() noexcept { return reinterpret_cast<T*>(&m_inline); }
+  const T* inlineData() const noexcept { return reinterpret_cast<const T*>(&m_inline); }
+
+  static void destroy(T* first, T* last) noexcept
+  {
+    for (; first != last; ++first)
+      first->~T();
+  }
+
+  void deallocate() noexcept
+  {
+    if (!isInline())
+      std::allocator<T>().deallocate(m_data, m_capacity);
+
+    m_data = inlineData();
+    m_capacity = N;
+  }
+
+  void reallocate(size_t n)
+  {
+    n = std::max(n, N + 1);
+    T* data = std::allocator<T>().allocate(n);
+
+    for (size_t i(0); i < m_size; ++i)
+    {
+      new (data + i) T(std::move(m_data[i]));
+      m_data[i].~T();
+    }
+
+    const size_t size = m_size;
+    deallocate();
+    m_data = data;
+    m_size = size;
+    m_capacity = n;
+  }
+
+  void steal(SmallVector& other) noexcept
+  {
+    if (other.isInline())
+    {
+      for (size_t i(0); i < other.m_size; ++i)
+        new (m_data + i) T(std::move(other.m_data[i]));
+
+      m_size = other.m_size;
+      other.clear();
+    }
+    else
+    {
+      m_data = other.m_data;
+      m_size = other.m_size;
+      m_capacity = other.m_capacity;
+      other.m_data = other.inlineData();
+      other.m_size = 0;
+      other.m_capacity = N;
+    }
+  }
+
+  template<typename InputIt>
+  void reserve_for(InputIt first, InputIt last, std::forward_iterator_tag)
+  {
+    reserve(m_size + static_cast<size_t>(std::distance(first, last)));
+  }
+
+  template<typename InputIt>
+  void reserve_for(InputIt, InputIt, std::input_iterator_tag)
+  {
+
+  }
+
+private:
+  T* m_data;
+  size_t m_size = 0;
+  size_t m_capacity = N;
+  typename std::aligned_storage<sizeof(T) * N, alignof(T)>::type m_inline;
+};
+
+} // namespace tex
+
+#endif // LIBTYPESET_SMALLVECTOR_H
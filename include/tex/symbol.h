@@ -15,15 +15,19 @@ namespace tex
 
 class LIBTYPESET_API Symbol : public Node
 {
+public:
+  Symbol() : Node(NodeKind::Symbol) { }
 
+protected:
+  explicit Symbol(NodeKind k) : Node(k) { }
 };
 
 class LIBTYPESET_API TextSymbol : public Symbol
 {
   std::string m_text;
 public:
-  explicit TextSymbol(const std::string& str) : m_text{str} { }
-  explicit TextSymbol(std::string&& str) : m_text{std::move(str)} {}
+  explicit TextSymbol(const std::string& str) : Symbol(NodeKind::TextSymbol), m_text{str} { }
+  explicit TextSymbol(std::string&& str) : Symbol(NodeKind::TextSymbol), m_text{std::move(str)} {}
   ~TextSymbol() = default;
 
   const std::string& text() const { return m_text; }
@@ -37,13 +41,11 @@ private:
   int m_family;
 
 public:
-  MathSymbol(Character c, int class_num, int f) : m_char(c), m_class(class_num), m_family(f) { }
+  MathSymbol(Character c, int class_num, int f) : Symbol(NodeKind::MathSymbol), m_char(c), m_class(class_num), m_family(f) { }
 
   Character character() const { return m_char;  }
   int classNumber() const { return m_class; }
   int family() const { return m_family; }
-
-  bool isMathSymbol() const override { return true; }
 };
 
 } // namespace tex
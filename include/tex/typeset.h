@@ -16,6 +16,9 @@ namespace math
 class Style;
 } // namespace math
 
+class InterwordGlueCache;
+class NodeArena;
+
 class LIBTYPESET_API TypesetEngine
 {
 public:
@@ -24,14 +27,20 @@ public:
 
   virtual std::shared_ptr<tex::FontMetricsProvider> metrics() const = 0;
 
-  virtual std::shared_ptr<tex::Box> typeset(tex::Character c, tex::Font font) = 0;
-  virtual std::shared_ptr<tex::Box> typeset(const std::string& text, tex::Font font) = 0;
-  virtual std::shared_ptr<tex::Box> typeset(const std::shared_ptr<tex::Symbol> & symbol, tex::Font font) = 0;
-  virtual std::shared_ptr<tex::Box> typesetRadicalSign(float minTotalHeight) = 0;
-  virtual std::shared_ptr<tex::Box> typesetDelimiter(const std::shared_ptr<tex::Symbol> & symbol, float minTotalHeight) = 0;
-  virtual std::shared_ptr<tex::Box> typesetLargeOp(const std::shared_ptr<tex::Symbol> & symbol) = 0;
+  virtual NodeRef<tex::Box> typeset(tex::Character c, tex::Font font) = 0;
+  virtual NodeRef<tex::Box> typeset(tex::Character c, tex::Font font, NodeArena& arena);
+  virtual NodeRef<tex::Box> typeset(const std::string& text, tex::Font font) = 0;
+  virtual NodeRef<tex::Box> typeset(const NodeRef<tex::Symbol> & symbol, tex::Font font) = 0;
+  virtual NodeRef<tex::Box> typesetRadicalSign(float minTotalHeight) = 0;
+  virtual NodeRef<tex::Box> typesetDelimiter(const NodeRef<tex::Symbol> & symbol, float minTotalHeight) = 0;
+  virtual NodeRef<tex::Box> typesetLargeOp(const NodeRef<tex::Symbol> & symbol) = 0;
+
+  const std::shared_ptr<InterwordGlueCache>& interwordGlueCache();
 
   FontMetricsProvider & operator=(const FontMetricsProvider &) = delete;
+
+private:
+  std::shared_ptr<InterwordGlueCache> m_gluecache;
 };
 
 class LIBTYPESET_API Options
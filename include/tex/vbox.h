@@ -10,22 +10,25 @@
 namespace tex
 {
 
+class NodeArena;
+
 class LIBTYPESET_API VListBuilder
 {
 public:
   List result;
-  std::shared_ptr<Glue> baselineskip;
-  std::shared_ptr<Glue> lineskip;
+  NodeRef<Glue> baselineskip;
+  NodeRef<Glue> lineskip;
   float lineskiplimit = 0.f;
   float prevdepth = -10000.f;
+  std::shared_ptr<NodeArena> arena;
 
-  VListBuilder(std::shared_ptr<Glue> baselineskip_, std::shared_ptr<Glue> lineskip_);
+  VListBuilder(NodeRef<Glue> baselineskip_, NodeRef<Glue> lineskip_);
   
-  void push_back(const std::shared_ptr<Box>& box);
+  void push_back(const NodeRef<Box>& box);
 
-  static void push_back(List& vlist, const std::shared_ptr<Box>& box, float& prevdepth, const std::shared_ptr<Glue>& baselineskip, const std::shared_ptr<Glue>& lineskip, float lineskiplimit = 0.f);
+  static void push_back(List& vlist, const NodeRef<Box>& box, float& prevdepth, const NodeRef<Glue>& baselineskip, const NodeRef<Glue>& lineskip, float lineskiplimit = 0.f, NodeArena* arena = nullptr);
 
-  void push_back_node(const std::shared_ptr<Node>& node);
+  void push_back_node(const NodeRef<Node>& node);
 };
 
 class LIBTYPESET_API VBox final : public ListBox
@@ -38,12 +41,12 @@ public:
 
   void getBoxingInfo(float *width, float *height, float *depth, GlueShrink *shrink, GlueStretch *stretch) const;
 
-  bool isVBox() const override;
+  static void accumulate(BoxingInfo& info, const Node& node);
 
 protected:
   friend class VBoxEditor;
-  friend LIBTYPESET_API std::shared_ptr<VBox> vtop(List && list);
-  friend LIBTYPESET_API std::shared_ptr<VBox> vtop(List && list, float h);
+  friend LIBTYPESET_API NodeRef<VBox> vtop(List && list);
+  friend LIBTYPESET_API NodeRef<VBox> vtop(List && list, float h);
 
   void rebox_vbox();
   BoxingResult rebox_vbox(float desiredHeight);
@@ -52,12 +55,12 @@ protected:
   void make_vtop();
 };
 
-LIBTYPESET_API std::shared_ptr<VBox> vbox(List && list);
-LIBTYPESET_API std::shared_ptr<VBox> vbox(List && list, float h);
-LIBTYPESET_API std::shared_ptr<VBox> vtop(List && list);
-LIBTYPESET_API std::shared_ptr<VBox> vtop(List && list, float h);
+LIBTYPESET_API NodeRef<VBox> vbox(List && list);
+LIBTYPESET_API NodeRef<VBox> vbox(List && list, float h);
+LIBTYPESET_API NodeRef<VBox> vtop(List && list);
+LIBTYPESET_API NodeRef<VBox> vtop(List && list, float h);
 
-class LIBTYPESET_API VBoxEditor final
+class LIBTYPESET_API VBoxEditor final : public ListBoxEditor
 {
 private:
   bool mReboxDone;
@@ -66,8 +69,6 @@ public:
   VBoxEditor(VBox & box);
   ~VBoxEditor();
 
-  List & list();
-
   void rebox();
   BoxingResult rebox(float desiredHeight);
   void rebox_vtop();
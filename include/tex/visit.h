@@ -0,0 +1,124 @@
+// Copyright (C) 2020 Vincent Chambrin
+// This file is part of the 'typeset' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#ifndef LIBTYPESET_VISIT_H
+#define LIBTYPESET_VISIT_H
+
+#include "tex/charbox.h"
+#include "tex/discretionary.h"
+#include "tex/glue.h"
+#include "tex/glyphrun.h"
+#include "tex/hbox.h"
+#include "tex/kern.h"
+#include "tex/penalty.h"
+#include "tex/rule.h"
+#include "tex/vbox.h"
+
+#include <type_traits>
+#include <utility>
+
+namespace tex
+{
+
+template<typename... Fs>
+struct overloaded_t;
+
+template<typename F>
+struct overloaded_t<F> : F
+{
+  explicit overloaded_t(F f) : F(std::move(f)) { }
+
+  using F::operator();
+};
+
+template<typename F, typename... Fs>
+struct overloaded_t<F, Fs...> : F, overloaded_t<Fs...>
+{
+  explicit overloaded_t(F f, Fs... fs) : F(std::move(f)), overloaded_t<Fs...>(std::move(fs)...) { }
+
+  using F::operator();
+  using overloaded_t<Fs...>::operator();
+};
+
+/*!
+ * \fn overloaded(Fs&&... fs)
+ * \brief Builds a function object whose call operator is the overload set of \a fs
+ */
+template<typename... Fs>
+overloaded_t<std::decay_t<Fs>...> overloaded(Fs&&... fs)
+{
+  return overloaded_t<std::decay_t<Fs>...>(std::forward<Fs>(fs)...);
+}
+
+/*!
+ * \fn visit(Node& node, F&& f)
+ * \brief Calls \a f with \a node downcast to its concrete type
+ *
+ * Dispatch is a switch on the node's kind.
+ * Nodes whose kind has no dedicated case are passed as a \c Box or as a \c Node,
+ * so that \a f may provide overloads for these base classes as fallbacks.
+ */
+template<typename F>
+decltype(auto) visit(Node& node, F&& f)
+{
+  switch (node.kind())
+  {
+  case NodeKind::Glue:
+    return f(static_cast<Glue&>(node));
+  case NodeKind::Kern:
+    return f(static_cast<Kern&>(node));
+  case NodeKind::Penalty:
+    return f(static_cast<Penalty&>(node));
+  case NodeKind::Discretionary:
+    return f(static_cast<Discretionary&>(node));
+  case NodeKind::Box:
+    return f(static_cast<Box&>(node));
+  case NodeKind::CharacterBox:
+    return f(static_cast<CharacterBox&>(node));
+  case NodeKind::GlyphRun:
+    return f(static_cast<GlyphRun&>(node));
+  case NodeKind::Rule:
+    return f(static_cast<Rule&>(node));
+  case NodeKind::HBox:
+    return f(static_cast<HBox&>(node));
+  case NodeKind::VBox:
+    return f(static_cast<VBox&>(node));
+  default:
+    return f(node);
+  }
+}
+
+template<typename F>
+decltype(auto) visit(const Node& node, F&& f)
+{
+  switch (node.kind())
+  {
+  case NodeKind::Glue:
+    return f(static_cast<const Glue&>(node));
+  case NodeKind::Kern:
+    return f(static_cast<const Kern&>(node));
+  case NodeKind::Penalty:
+    return f(static_cast<const Penalty&>(node));
+  case NodeKind::Discretionary:
+    return f(static_cast<const Discretionary&>(node));
+  case NodeKind::Box:
+    return f(static_cast<const Box&>(node));
+  case NodeKind::CharacterBox:
+    return f(static_cast<const CharacterBox&>(node));
+  case NodeKind::GlyphRun:
+    return f(static_cast<const GlyphRun&>(node));
+  case NodeKind::Rule:
+    return f(static_cast<const Rule&>(node));
+  case NodeKind::HBox:
+    return f(static_cast<const HBox&>(node));
+  case NodeKind::VBox:
+    return f(static_cast<const VBox&>(node));
+  default:
+    return f(node);
+  }
+}
+
+} // namespace tex
+
+#endif // LIBTYPESET_VISIT_H
@@ -8,34 +8,50 @@ namespace tex
 {
 
 Box::Box()
-  : m_height(0.f),
+  : Box(NodeKind::Box)
+{
+
+}
+
+Box::Box(const BoxMetrics& metrics)
+  : Box(NodeKind::Box, metrics)
+{
+
+}
+
+Box::Box(float h, float d, float w)
+  : Box(NodeKind::Box, h, d, w)
+{
+
+}
+
+Box::Box(NodeKind k)
+  : Node(k),
+  m_height(0.f),
   m_depth(0.f),
   m_width(0.f)
 {
 
 }
 
-Box::Box(const BoxMetrics& metrics)
-  : m_height(metrics.height),
+Box::Box(NodeKind k, const BoxMetrics& metrics)
+  : Node(k),
+  m_height(metrics.height),
   m_depth(metrics.depth),
   m_width(metrics.width)
 {
 
 }
 
-Box::Box(float h, float d, float w)
-  : m_height(h),
+Box::Box(NodeKind k, float h, float d, float w)
+  : Node(k),
+  m_height(h),
   m_depth(d),
   m_width(w)
 {
 
 }
 
-bool Box::isBox() const
-{
-  return true;
-}
-
 void Box::setHeight(float h)
 {
   m_height = h;
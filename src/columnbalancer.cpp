@@ -0,0 +1,297 @@
+// Copyright (C) 2020 Vincent Chambrin
+// This file is part of the 'typeset' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "tex/columnbalancer.h"
+
+#include "tex/glue.h"
+#include "tex/kern.h"
+#include "tex/nodearena.h"
+#include "tex/penalty.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+namespace tex
+{
+
+ColumnBalancer::ColumnBalancer(const List& vlist)
+  : m_nodes(vlist.begin(), vlist.end())
+{
+  const size_t n = m_nodes.size();
+
+  // m_heights[i] is the total height of the first i nodes, including the
+  // depth of boxes; m_depths[i] is the depth of the last of these nodes
+  // if it is a box that is not followed by glue or kern.
+  m_heights.assign(n + 1, Dimension(0));
+  m_depths.assign(n + 1, Dimension(0));
+
+  for (size_t i(0); i < n; ++i)
+  {
+    const Node& node = *m_nodes[i];
+
+    m_heights[i + 1] = m_heights[i];
+    m_depths[i + 1] = m_depths[i];
+
+    if (node.isBox())
+    {
+      m_heights[i + 1] += to_dimension(node.as<Box>().totalHeight());
+      m_depths[i + 1] = to_dimension(node.as<Box>().depth());
+    }
+    else if (node.isGlue())
+    {
+      m_heights[i + 1] += to_dimension(node.as<Glue>().space());
+      m_depths[i + 1] = 0;
+    }
+    else if (node.isKern())
+    {
+      m_heights[i + 1] += to_dimension(node.as<Kern>().space());
+      m_depths[i + 1] = 0;
+    }
+
+    bool legal = false;
+
+    if (node.isGlue())
+      legal = i > 0 && !m_nodes[i - 1]->isDiscardable();
+    else if (node.isKern())
+      legal = i + 1 < n && m_nodes[i + 1]->isGlue();
+    else if (node.isPenalty())
+      legal = node.as<Penalty>().value() < Penalty::Infinity;
+
+    if (legal)
+      m_breaks.push_back(i);
+
+    if (node.isPenalty() && node.as<Penalty>().value() <= -Penalty::Infinity)
+      m_forced.push_back(i);
+  }
+
+  m_breaks.push_back(n);
+
+  // The height up to a breakpoint, made non-decreasing so that it can be
+  // binary searched even with negative glue or kerns
+  m_reach.reserve(m_breaks.size());
+
+  for (size_t b : m_breaks)
+  {
+    const Dimension h = m_heights[b] - m_depths[b];
+    m_reach.push_back(m_reach.empty() ? h : std::max(m_reach.back(), h));
+  }
+
+  // A column starts at the first node after a break that is not discardable
+  m_starts.resize(n + 1);
+  m_starts[n] = n;
+
+  for (size_t i(n); i-- > 0; )
+    m_starts[i] = m_nodes[i]->isDiscardable() ? m_starts[i + 1] : i;
+}
+
+ColumnBalancer::~ColumnBalancer()
+{
+
+}
+
+/*!
+ * \fn float columnHeight(size_t begin, size_t end) const
+ * \brief Returns the natural height of a column made of the nodes in [begin, end)
+ *
+ * As for a VBox, the depth of the last box is not part of the height.
+ */
+float ColumnBalancer::columnHeight(size_t begin, size_t end) const
+{
+  return from_dimension(m_heights[end] - m_heights[begin] - m_depths[end]);
+}
+
+/*!
+ * \fn float computeHeight(size_t columns) const
+ * \brief Returns the smallest height for which the list fits in the given number of columns
+ *
+ * Throws if the list has more forced breaks than can fit in the columns.
+ */
+float ColumnBalancer::computeHeight(size_t columns) const
+{
+  return from_dimension(minimalHeight(columns));
+}
+
+/*!
+ * \fn std::vector<size_t> computeBreaks(size_t columns, float height) const
+ * \brief Returns where the columns end when they are filled up to \a height
+ *
+ * Each column ends at the last breakpoint for which its natural height
+ * does not exceed \a height, or at the first forced break.
+ * The last index is the size of the list; there may be fewer than
+ * \a columns breaks if the list fits in fewer columns.
+ * Throws if the list does not fit.
+ */
+std::vector<size_t> ColumnBalancer::computeBreaks(size_t columns, float height) const
+{
+  std::vector<size_t> breaks;
+
+  if (!fill(columns, to_dimension(height), &breaks))
+    throw std::runtime_error{ "The list does not fit in the columns" };
+
+  return breaks;
+}
+
+/*!
+ * \fn std::vector<NodeRef<VBox>> balance(size_t columns)
+ * \brief Splits the list into columns of the smallest equal height
+ *
+ * All columns are boxed to the same height, so their glue is set as needed;
+ * columns that are left empty are empty boxes.
+ * The nodes at which columns are broken are discarded.
+ */
+std::vector<NodeRef<VBox>> ColumnBalancer::balance(size_t columns)
+{
+  const Dimension height = minimalHeight(columns);
+
+  std::vector<size_t> breaks;
+  fill(columns, height, &breaks);
+
+  std::vector<NodeRef<VBox>> result;
+  result.reserve(columns);
+
+  size_t begin = m_starts[0];
+
+  for (size_t end : breaks)
+  {
+    List column{ m_nodes.begin() + begin, m_nodes.begin() + end };
+    result.push_back(make_node<VBox>(arena.get(), std::move(column), from_dimension(height)));
+    begin = m_starts[end];
+  }
+
+  while (result.size() < columns)
+    result.push_back(make_node<VBox>(arena.get(), List{}, from_dimension(height)));
+
+  return result;
+}
+
+/*!
+ * \fn Dimension minimalHeight(size_t columns) const
+ * \brief Returns the smallest height for which fill() succeeds
+ *
+ * fill() only changes its result at the heights at which a column reaches
+ * a breakpoint, so the search runs on these heights rather than on
+ * dimensions.
+ * The greedy filling is simulated for the unknown minimal height, which
+ * lies in (lo, hi]: for each column, the heights of the breakpoints that
+ * fall strictly between lo and hi are bisected with fill(), after which
+ * the column ends at the same breakpoint for all heights in the interval.
+ * The result is hi, the only height of the interval at which fill() can
+ * succeed. This takes O(columns log n) calls to fill().
+ */
+Dimension ColumnBalancer::minimalHeight(size_t columns) const
+{
+  if (columns == 0)
+    throw std::runtime_error{ "No columns" };
+
+  if (m_starts[0] == size())
+    return 0;
+
+  // fill() fails for lo and succeeds for hi
+  Dimension lo = std::numeric_limits<Dimension>::lowest();
+  Dimension hi = m_reach.back() - *std::min_element(m_heights.begin(), m_heights.end());
+
+  if (!fill(columns, hi, nullptr))
+    throw std::runtime_error{ "The list has too many forced breaks" };
+
+  size_t begin = m_starts[0];
+
+  for (size_t c(0); c < columns && begin < size(); ++c)
+  {
+    size_t first = 0, last = 0;
+    candidates(begin, first, last);
+
+    auto height = [&](size_t b) -> Dimension {
+      return m_reach[b] - m_heights[begin];
+    };
+
+    auto bound = [&](Dimension h, bool inclusive) -> size_t {
+      return std::partition_point(m_reach.begin() + first, m_reach.begin() + last, [&](Dimension reach) {
+        return inclusive ? reach - m_heights[begin] <= h : reach - m_heights[begin] < h;
+      }) - m_reach.begin();
+    };
+
+    // The breakpoints in [low, high) are strictly between lo and hi
+    size_t low = bound(lo, true);
+    size_t high = std::max(low, bound(hi, false));
+
+    while (low < high)
+    {
+      const size_t mid = low + (high - low) / 2;
+
+      if (fill(columns, height(mid), nullptr))
+      {
+        hi = height(mid);
+        high = mid;
+      }
+      else
+      {
+        lo = height(mid);
+        low = mid + 1;
+      }
+    }
+
+    // The column ends at the last breakpoint that is not higher than lo
+    if (low == first)
+      break;
+
+    begin = m_starts[m_breaks[low - 1]];
+  }
+
+  return hi;
+}
+
+/*!
+ * \fn void candidates(size_t begin, size_t& first, size_t& last) const
+ * \brief Returns the range of m_breaks at which a column that starts at \a begin may end
+ *
+ * These are the breakpoints after \a begin, up to the first forced break.
+ */
+void ColumnBalancer::candidates(size_t begin, size_t& first, size_t& last) const
+{
+  auto forced = std::lower_bound(m_forced.begin(), m_forced.end(), begin);
+  const size_t limit = forced == m_forced.end() ? size() : *forced;
+
+  first = std::upper_bound(m_breaks.begin(), m_breaks.end(), begin) - m_breaks.begin();
+  last = std::upper_bound(m_breaks.begin() + first, m_breaks.end(), limit) - m_breaks.begin();
+}
+
+/*!
+ * \fn bool fill(size_t columns, Dimension height, std::vector<size_t>* breaks) const
+ * \brief Fills the columns greedily up to \a height
+ *
+ * Each column takes the longest run of nodes that fits, which is found with
+ * a binary search on the breakpoints; this takes O(columns log n) time.
+ * Returns whether all the nodes fit, and appends the end of each column
+ * to \a breaks if it is not null.
+ */
+bool ColumnBalancer::fill(size_t columns, Dimension height, std::vector<size_t>* breaks) const
+{
+  size_t begin = m_starts[0];
+
+  for (size_t c(0); c < columns && begin < size(); ++c)
+  {
+    size_t first = 0, last = 0;
+    candidates(begin, first, last);
+
+    // The height is computed as in minimalHeight(), so that its results fit
+    auto it = std::partition_point(m_reach.begin() + first, m_reach.begin() + last, [&](Dimension reach) {
+      return reach - m_heights[begin] <= height;
+    });
+
+    if (it == m_reach.begin() + first)
+      return false;
+
+    const size_t end = m_breaks[(it - m_reach.begin()) - 1];
+
+    if (breaks)
+      breaks->push_back(end);
+
+    begin = m_starts[end];
+  }
+
+  return begin >= size();
+}
+
+} // namespace tex
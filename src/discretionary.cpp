@@ -0,0 +1,42 @@
+// Copyright (C) 2020 Vincent Chambrin
+// This file is part of the 'typeset' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "tex/discretionary.h"
+
+#include "tex/hbox.h"
+
+namespace tex
+{
+
+static BoxingInfo boxing_info(const List& list)
+{
+  BoxingInfo info;
+
+  for (const auto& node : list)
+    HBox::accumulate(info, *node);
+
+  return info;
+}
+
+Discretionary::Discretionary(List prebreak, List postbreak, List nobreak)
+  : Node(NodeKind::Discretionary),
+    m_prebreak(std::move(prebreak)),
+    m_postbreak(std::move(postbreak)),
+    m_nobreak(std::move(nobreak))
+{
+  m_prebreak_width = boxing_info(m_prebreak).width;
+  m_postbreak_width = boxing_info(m_postbreak).width;
+
+  BoxingInfo info = boxing_info(m_nobreak);
+  m_nobreak_width = info.width;
+  m_nobreak_height = info.height;
+  m_nobreak_depth = info.depth;
+}
+
+NodeRef<Discretionary> discretionary(List prebreak, List postbreak, List nobreak)
+{
+  return make_node<Discretionary>(std::move(prebreak), std::move(postbreak), std::move(nobreak));
+}
+
+} // namespace tex
@@ -165,12 +165,12 @@ BoxMetrics FontMetrics::metrics(tex::Character c) const
   return metricsProvider()->metrics(c, font());
 }
 
-BoxMetrics FontMetrics::metrics(const std::shared_ptr<tex::Symbol> & symbol) const
+BoxMetrics FontMetrics::metrics(const NodeRef<tex::Symbol> & symbol) const
 {
   return metricsProvider()->metrics(symbol, font());
 }
 
-float FontMetrics::italicCorrection(const std::shared_ptr<tex::Symbol> & symbol) const
+float FontMetrics::italicCorrection(const NodeRef<tex::Symbol> & symbol) const
 {
   return metricsProvider()->italicCorrection(symbol, font());
 }
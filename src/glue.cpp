@@ -48,14 +48,16 @@ GlueShrinkStretch operator-(const GlueShrinkStretch & lhs, const GlueShrinkStret
 }
 
 Glue::Glue(float spc, float shrnk, float strtch, GlueOrder shrnkOrder, GlueOrder strtchOrder)
-  : m_origin(GlueOrigin::normal),
+  : Node(NodeKind::Glue),
+    m_origin(GlueOrigin::normal),
     m_spec(GlueSpec{ spc, shrnk, strtch, shrnkOrder, strtchOrder })
 {
 
 }
 
 Glue::Glue(GlueSpec spec, GlueOrigin orig)
-  : m_origin(orig),
+  : Node(NodeKind::Glue),
+    m_origin(orig),
     m_spec(spec)
 {
 
@@ -99,34 +101,34 @@ void Glue::accumulate(GlueShrink & shrink, GlueStretch & stretch) const
   }
 }
 
-std::shared_ptr<Glue> glue(float space)
+NodeRef<Glue> glue(float space)
 {
-  return std::make_shared<Glue>(space, 0.f, 0.f);
+  return make_node<Glue>(space, 0.f, 0.f);
 }
 
-std::shared_ptr<Glue> glue(float space, const Shrink & shrink)
+NodeRef<Glue> glue(float space, const Shrink & shrink)
 {
-  return std::make_shared<Glue>(space, shrink.amount, 0.f, shrink.order, GlueOrder::Normal);
+  return make_node<Glue>(space, shrink.amount, 0.f, shrink.order, GlueOrder::Normal);
 }
 
-std::shared_ptr<Glue> glue(float space, const Stretch & stretch)
+NodeRef<Glue> glue(float space, const Stretch & stretch)
 {
-  return std::make_shared<Glue>(space, 0.f, stretch.amount, GlueOrder::Normal, stretch.order);
+  return make_node<Glue>(space, 0.f, stretch.amount, GlueOrder::Normal, stretch.order);
 }
 
-std::shared_ptr<Glue> glue(float space, const Stretch & stretch, const Shrink & shrink)
+NodeRef<Glue> glue(float space, const Stretch & stretch, const Shrink & shrink)
 {
-  return std::make_shared<Glue>(space, shrink.amount, stretch.amount, shrink.order, stretch.order);
+  return make_node<Glue>(space, shrink.amount, stretch.amount, shrink.order, stretch.order);
 }
 
-std::shared_ptr<Glue> glue(float space, const Shrink & shrink, const Stretch & stretch)
+NodeRef<Glue> glue(float space, const Shrink & shrink, const Stretch & stretch)
 {
-  return std::make_shared<Glue>(space, shrink.amount, stretch.amount, shrink.order, stretch.order);
+  return make_node<Glue>(space, shrink.amount, stretch.amount, shrink.order, stretch.order);
 }
 
-std::shared_ptr<Glue> glue(GlueSpec spec, GlueOrigin origin)
+NodeRef<Glue> glue(GlueSpec spec, GlueOrigin origin)
 {
-  return std::make_shared<Glue>(spec, origin);
+  return make_node<Glue>(spec, origin);
 }
 
 } // namespace tex
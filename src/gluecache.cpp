@@ -0,0 +1,130 @@
+// Copyright (C) 2020 Vincent Chambrin
+// This file is part of the 'typeset' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "tex/gluecache.h"
+
+#include "tex/fontmetrics.h"
+#include "tex/glue.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace tex
+{
+
+struct InterwordGlueCache::FontEntry
+{
+  Font font;
+  float interword_space = 0.f;
+  float interword_stretch = 0.f;
+  float interword_shrink = 0.f;
+  float extra_space = 0.f;
+  std::vector<std::pair<int, NodeRef<const Glue>>> glues;
+
+  bool matches(const FontDimen& fd) const
+  {
+    return fd.interword_space == interword_space
+      && fd.interword_stretch == interword_stretch
+      && fd.interword_shrink == interword_shrink
+      && fd.extra_space == extra_space;
+  }
+
+  void reset(const FontDimen& fd)
+  {
+    interword_space = fd.interword_space;
+    interword_stretch = fd.interword_stretch;
+    interword_shrink = fd.interword_shrink;
+    extra_space = fd.extra_space;
+    glues.clear();
+  }
+};
+
+InterwordGlueCache::InterwordGlueCache(std::shared_ptr<FontMetricsProvider> metrics)
+  : m_metrics(std::move(metrics))
+{
+
+}
+
+InterwordGlueCache::~InterwordGlueCache()
+{
+
+}
+
+InterwordGlueCache::FontEntry& InterwordGlueCache::fontEntry(Font font)
+{
+  if (m_last < m_fonts.size() && m_fonts[m_last].font == font)
+    return m_fonts[m_last];
+
+  auto it = std::find_if(m_fonts.begin(), m_fonts.end(), [font](const FontEntry& e) {
+    return e.font == font;
+  });
+
+  if (it == m_fonts.end())
+  {
+    m_fonts.emplace_back();
+    m_fonts.back().font = font;
+    m_fonts.back().reset(m_metrics->fontdimen(font));
+    it = m_fonts.end() - 1;
+  }
+
+  m_last = std::distance(m_fonts.begin(), it);
+  return *it;
+}
+
+NodeRef<const Glue> InterwordGlueCache::get(Font font, int spacefactor)
+{
+  FontEntry& entry = fontEntry(font);
+
+  const FontDimen& fd = m_metrics->fontdimen(font);
+
+  if (!entry.matches(fd))
+    entry.reset(fd);
+
+  for (const auto& g : entry.glues)
+  {
+    if (g.first == spacefactor)
+      return g.second;
+  }
+
+  float space = m_metrics->interwordSpace(font);
+  float stretch = m_metrics->interwordStretch(font);
+  float shrink = m_metrics->interwordShrink(font);
+
+  if (spacefactor >= 2000)
+    space += m_metrics->extraSpace(font);
+
+  stretch *= (spacefactor / 1000.f);
+  shrink *= (1000.f / spacefactor);
+
+  entry.glues.emplace_back(spacefactor, make_node<Glue>(space, shrink, stretch));
+  return entry.glues.back().second;
+}
+
+void InterwordGlueCache::invalidate(Font font)
+{
+  auto it = std::find_if(m_fonts.begin(), m_fonts.end(), [font](const FontEntry& e) {
+    return e.font == font;
+  });
+
+  if (it != m_fonts.end())
+    it->glues.clear();
+}
+
+void InterwordGlueCache::clear()
+{
+  m_fonts.clear();
+  m_last = 0;
+}
+
+size_t InterwordGlueCache::size() const
+{
+  size_t n = 0;
+
+  for (const auto& e : m_fonts)
+    n += e.glues.size();
+
+  return n;
+}
+
+} // namespace tex
@@ -0,0 +1,58 @@
+// Copyright (C) 2020 Vincent Chambrin
+// This file is part of the 'typeset' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "tex/glyphrun.h"
+
+#include "tex/nodearena.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace tex
+{
+
+GlyphRun::GlyphRun(Font f)
+  : Box(NodeKind::GlyphRun, 0.f, 0.f, 0.f),
+    m_font(f)
+{
+
+}
+
+/*!
+ * \fn void push_back(Character c, const BoxMetrics& metrics)
+ * \brief Appends a glyph to the run
+ *
+ * The width of the glyph is used as its advance.
+ */
+void GlyphRun::push_back(Character c, const BoxMetrics& metrics)
+{
+  m_codepoints.push_back(c);
+  m_advances.push_back(metrics.width);
+  m_heights.push_back(metrics.height);
+  m_depths.push_back(metrics.depth);
+
+  setHeight(std::max(height(), metrics.height));
+  setDepth(std::max(depth(), metrics.depth));
+  setWidth(width() + metrics.width);
+}
+
+/*!
+ * \fn NodeRef<GlyphRun> slice(size_t begin, size_t end, NodeArena* arena) const
+ * \brief Creates a run made of the glyphs in [begin, end)
+ *
+ * This is used to split a run at a discretionary point.
+ */
+NodeRef<GlyphRun> GlyphRun::slice(size_t begin, size_t end, NodeArena* arena) const
+{
+  assert(begin <= end && end <= size());
+
+  auto result = make_node<GlyphRun>(arena, font());
+
+  for (size_t i(begin); i < end; ++i)
+    result->push_back(character(i), BoxMetrics{ height(i), depth(i), advance(i) });
+
+  return result;
+}
+
+} // namespace tex
@@ -4,7 +4,9 @@
 
 #include "tex/hbox.h"
 
+#include "tex/discretionary.h"
 #include "tex/kern.h"
+#include "tex/visit.h"
 
 #include <algorithm>
 #include <cassert>
@@ -13,94 +15,102 @@ namespace tex
 {
 
 HBox::HBox(List && list)
-  : ListBox(std::move(list))
+  : ListBox(NodeKind::HBox, std::move(list))
 {
   rebox();
 }
 
 HBox::HBox(List && list, float desiredWidth)
-  : ListBox(std::move(list))
+  : ListBox(NodeKind::HBox, std::move(list))
 {
   rebox(desiredWidth);
 }
 
 
-void HBox::getBoxingInfo(float *width, float *height, float *depth, GlueShrink *shrink, GlueStretch *stretch) const
+HBox::HBox(List && list, float desiredWidth, const BoxingInfo& info)
+  : ListBox(NodeKind::HBox, std::move(list))
 {
-  float h = 0;
-  float d = 0;
-  float w = 0;
+  setTotals(info);
+  rebox(desiredWidth, info);
+}
 
-  for (auto it = list().begin(); it != list().end(); ++it)
-  {
-    if ((*it)->isBox())
-    {
-      auto box = std::static_pointer_cast<Box>(*it);
-
-      if ((*it)->isListBox())
-      {
-        auto listbox = std::static_pointer_cast<ListBox>(box);
-
-        h = std::max(h, listbox->height() - listbox->shiftAmount());
-        d = std::max(d, listbox->depth() + listbox->shiftAmount());
-      }
-      else
-      {
-        h = std::max(h, box->height());
-        d = std::max(d, box->depth());
-      }
-      w += box->width();
-    }
-    else if ((*it)->isKern())
-    {
-      w += std::static_pointer_cast<Kern>(*it)->space();
-    }
-    else if ((*it)->isGlue())
-    {
-      auto glue = std::static_pointer_cast<Glue>(*it);
-      w += glue->space();
-      glue->accumulate(*shrink, *stretch);
-    }
-  }
+HBox::HBox(ChildList && list, float desiredWidth, const BoxingInfo& info)
+  : ListBox(NodeKind::HBox, std::move(list))
+{
+  setTotals(info);
+  rebox(desiredWidth, info);
+}
 
-  if (height)
-    *height = h;
-  if (depth)
-    *depth = d;
-  if (width)
-    *width = w;
+void HBox::accumulate(BoxingInfo& info, const Node& node)
+{
+  visit(node, overloaded(
+    [&](const ListBox& listbox) {
+      info.height = std::max(info.height, listbox.height() - listbox.shiftAmount());
+      info.depth = std::max(info.depth, listbox.depth() + listbox.shiftAmount());
+      info.width += listbox.width();
+    },
+    [&](const Box& box) {
+      info.height = std::max(info.height, box.height());
+      info.depth = std::max(info.depth, box.depth());
+      info.width += box.width();
+    },
+    [&](const Kern& kern) {
+      info.width += kern.space();
+    },
+    [&](const Glue& glue) {
+      info.width += glue.space();
+      glue.accumulate(info.shrink, info.stretch);
+    },
+    [&](const Discretionary& disc) {
+      info.height = std::max(info.height, disc.nobreakHeight());
+      info.depth = std::max(info.depth, disc.nobreakDepth());
+      info.width += disc.nobreakWidth();
+    },
+    [](const Node&) { }
+  ));
 }
 
-bool HBox::isHBox() const
+BoxingInfo HBox::getBoxingInfo() const
 {
-  return true;
+  return totals();
 }
 
-void HBox::rebox()
+void HBox::getBoxingInfo(float *width, float *height, float *depth, GlueShrink *shrink, GlueStretch *stretch) const
 {
-  float natural_width, height, depth;
-  GlueShrink shrink;
-  GlueStretch stretch;
+  BoxingInfo info = getBoxingInfo();
+
+  if (height)
+    *height = info.height;
+  if (depth)
+    *depth = info.depth;
+  if (width)
+    *width = info.width;
+  if (shrink)
+    static_cast<GlueShrinkStretch&>(*shrink) = *shrink + info.shrink;
+  if (stretch)
+    static_cast<GlueShrinkStretch&>(*stretch) = *stretch + info.stretch;
+}
 
-  getBoxingInfo(&natural_width, &height, &depth, &shrink, &stretch);
+void HBox::rebox()
+{
+  const BoxingInfo& info = totals();
 
-  setHeight(height);
-  setDepth(depth);
-  setWidth(natural_width);
+  setHeight(info.height);
+  setDepth(info.depth);
+  setWidth(info.width);
 }
 
 BoxingResult HBox::rebox(float desiredWidth)
 {
-  float natural_width, height, depth;
-  GlueShrink shrink;
-  GlueStretch stretch;
+  return rebox(desiredWidth, totals());
+}
 
-  getBoxingInfo(&natural_width, &height, &depth, &shrink, &stretch);
+BoxingResult HBox::rebox(float desiredWidth, const BoxingInfo& info)
+{
+  setHeight(info.height);
+  setDepth(info.depth);
 
-  setHeight(height);
-  setDepth(depth);
- 
-  float final_width = setGlue(natural_width, desiredWidth, shrink, stretch);
+  float final_width = setGlue(info.width, desiredWidth, info.shrink, info.stretch);
   setWidth(final_width);
 
   if (final_width < desiredWidth)
@@ -110,33 +120,34 @@ BoxingResult HBox::rebox(float desiredWidth)
   return BoxingResult::NormalBox;
 }
 
-std::shared_ptr<HBox> hbox(List && hlist)
+NodeRef<HBox> hbox(List && hlist)
 {
-  return std::make_shared<HBox>(std::move(hlist));
+  return make_node<HBox>(std::move(hlist));
 }
 
-std::shared_ptr<HBox> hbox(std::initializer_list<std::shared_ptr<Node>> && nodes)
+NodeRef<HBox> hbox(std::initializer_list<NodeRef<Node>> && nodes)
 {
   return hbox(List{ nodes });
 }
 
-std::shared_ptr<HBox> hbox(List && hlist, float w)
+NodeRef<HBox> hbox(List && hlist, float w)
 {
-  return std::make_shared<HBox>(std::move(hlist), w);
+  return make_node<HBox>(std::move(hlist), w);
 }
 
-void raise(std::shared_ptr<HBox> box, float amount)
+void raise(NodeRef<HBox> box, float amount)
 {
   box->setShiftAmount(-amount);
 }
 
-void lower(std::shared_ptr<HBox> box, float amount)
+void lower(NodeRef<HBox> box, float amount)
 {
   box->setShiftAmount(amount);
 }
 
 HBoxEditor::HBoxEditor(HBox & box)
-  : mReboxDone(false)
+  : ListBoxEditor(box)
+  , mReboxDone(false)
   , mHbox(&box)
 {
 
@@ -145,23 +156,23 @@ HBoxEditor::HBoxEditor(HBox & box)
 HBoxEditor::~HBoxEditor()
 {
   if (!mReboxDone)
+  {
+    sync();
     mHbox->rebox();
-}
-
-List & HBoxEditor::list()
-{
-  return mHbox->mutableList();
+  }
 }
 
 void HBoxEditor::rebox()
 {
   mReboxDone = true;
+  sync();
   mHbox->rebox();
 }
 
 BoxingResult HBoxEditor::rebox(float desiredWidth)
 {
   mReboxDone = true;
+  sync();
   return mHbox->rebox(desiredWidth);
 }
 
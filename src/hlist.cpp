@@ -4,8 +4,14 @@
 
 #include "tex/hlist.h"
 
+#include "tex/charbox.h"
+#include "tex/discretionary.h"
 #include "tex/glue.h"
+#include "tex/gluecache.h"
+#include "tex/glyphrun.h"
+#include "tex/hyphenation.h"
 #include "tex/kern.h"
+#include "tex/nodearena.h"
 #include "tex/typeset.h"
 
 #include <algorithm>
@@ -16,15 +22,38 @@ namespace tex
 
 HListBuilder::HListBuilder(std::shared_ptr<TypesetEngine> e, tex::Font f)
   : typeset(e),
-    font(f)
+    font(f),
+    gluecache(e->interwordGlueCache())
 {
 
 }
 
+/*!
+ * \fn void push_back(tex::Character c)
+ * \brief Appends a character to the list
+ *
+ * If \a glyphruns is true, consecutive characters of the same font are
+ * gathered in a GlyphRun instead of getting one box each; the last run
+ * of \a result may then still grow.
+ * Otherwise, the box of the character is created by the typeset engine.
+ */
 void HListBuilder::push_back(tex::Character c)
 {
-  auto box = typeset->typeset(c, font);
-  result.push_back(box);
+  if (glyphruns)
+  {
+    if (!m_glyphrun || result.empty() || result.back() != m_glyphrun || m_glyphrun->font() != font)
+    {
+      m_glyphrun = make_node<GlyphRun>(arena.get(), font);
+      result.push_back(m_glyphrun);
+    }
+
+    m_glyphrun->push_back(c, typeset->metrics()->metrics(c, font));
+  }
+  else
+  {
+    auto box = arena ? typeset->typeset(c, font, *arena) : typeset->typeset(c, font);
+    result.push_back(box);
+  }
 
   int g = typeset->metrics()->sfcode(c);
 
@@ -36,35 +65,154 @@ void HListBuilder::push_back(tex::Character c)
   }
 }
 
+/*!
+ * \fn void push_back_interword_glue()
+ * \brief Appends interword glue to the list
+ *
+ * If there is a \a hyphenator, the word that ends here is hyphenated first.
+ */
 void HListBuilder::push_back_interword_glue()
 {
-  float space = typeset->metrics()->interwordSpace(font);
-  float stretch = typeset->metrics()->interwordStretch(font);
-  float shrink = typeset->metrics()->interwordShrink(font);
-
-  if (spacefactor >= 2000)
-    space += typeset->metrics()->extraSpace(font);
+  if (hyphenator)
+    hyphenate();
 
-  stretch *= (spacefactor / 1000.f);
-  shrink *= (1000.f / spacefactor);
-
-  push_back(tex::glue(space, Stretch(stretch), Shrink(shrink)));
+  // Lists hold non-const nodes, but the interned glue is never modified
+  push_back(const_pointer_cast<Glue>(gluecache->get(font, spacefactor)));
 }
 
-void HListBuilder::push_back(std::shared_ptr<tex::Box> b)
+void HListBuilder::push_back(NodeRef<tex::Box> b)
 {
   result.push_back(b);
   spacefactor = 1000;
 }
 
-void HListBuilder::push_back(std::shared_ptr<tex::Glue> g)
+void HListBuilder::push_back(NodeRef<tex::Glue> g)
 {
   result.push_back(g);
 }
 
-void HListBuilder::push_back(std::shared_ptr<tex::Kern> k)
+void HListBuilder::push_back(NodeRef<tex::Kern> k)
 {
   result.push_back(k);
 }
 
+/*!
+ * \fn void finish()
+ * \brief Ends the list
+ *
+ * If there is a \a hyphenator, the last word, which is not followed by
+ * interword glue, is hyphenated.
+ * This should be called before the list is boxed or broken into lines.
+ */
+void HListBuilder::finish()
+{
+  if (hyphenator)
+    hyphenate();
+}
+
+/*!
+ * \fn void hyphenate()
+ * \brief Inserts discretionaries at the hyphenation points of the last word
+ *
+ * The word is made of the characters at the end of the list, which must all
+ * be in the same font; it starts at the first letter and ends before the first
+ * non-letter that follows (e.g. a punctuation mark).
+ * Each discretionary has a pre-break list made of the hyphen character.
+ * A word that follows a discretionary has already been hyphenated.
+ */
+void HListBuilder::hyphenate()
+{
+  if (result.empty())
+    return;
+
+  std::u32string chars;
+  Font f;
+  auto first = result.end();
+
+  if (result.back()->isGlyphRun())
+  {
+    const GlyphRun& run = result.back()->as<GlyphRun>();
+
+    if (result.size() > 1 && ((*std::prev(result.end(), 2))->isBox() || (*std::prev(result.end(), 2))->isDiscretionary()))
+      return;
+
+    for (Character c : run.characters())
+      chars.push_back(static_cast<char32_t>(c));
+
+    f = run.font();
+    first = std::prev(result.end());
+  }
+  else
+  {
+    while (first != result.begin() && (*std::prev(first))->isCharacterBox())
+      --first;
+
+    if (first == result.end() || (first != result.begin() && ((*std::prev(first))->isBox() || (*std::prev(first))->isDiscretionary())))
+      return;
+
+    f = (*first)->as<CharacterBox>().font();
+
+    for (auto it = first; it != result.end(); ++it)
+    {
+      if ((*it)->as<CharacterBox>().font() != f)
+        return;
+
+      chars.push_back(static_cast<char32_t>((*it)->as<CharacterBox>().character()));
+    }
+  }
+
+  size_t begin = 0;
+
+  while (begin < chars.size() && !Hyphenator::isLetter(static_cast<Character>(chars[begin])))
+    ++begin;
+
+  size_t end = begin;
+
+  while (end < chars.size() && Hyphenator::isLetter(static_cast<Character>(chars[end])))
+    ++end;
+
+  const std::vector<size_t> points = hyphenator->hyphenate(chars.substr(begin, end - begin));
+
+  if (points.empty())
+    return;
+
+  if (result.back()->isGlyphRun())
+  {
+    auto run = static_pointer_cast<GlyphRun>(result.back());
+    result.pop_back();
+
+    size_t from = 0;
+
+    for (size_t p : points)
+    {
+      result.push_back(run->slice(from, begin + p, arena.get()));
+      result.push_back(make_node<Discretionary>(arena.get(), List{ hyphen(f) }, List{}, List{}));
+      from = begin + p;
+    }
+
+    result.push_back(run->slice(from, run->size(), arena.get()));
+    m_glyphrun = nullptr;
+  }
+  else
+  {
+    // Insert from the end so that the offsets from 'first' stay valid
+    for (auto p = points.rbegin(); p != points.rend(); ++p)
+      result.insert(std::next(first, begin + *p), make_node<Discretionary>(arena.get(), List{ hyphen(f) }, List{}, List{}));
+  }
+}
+
+NodeRef<tex::Node> HListBuilder::hyphen(tex::Font f)
+{
+  if (glyphruns)
+  {
+    auto run = make_node<GlyphRun>(arena.get(), f);
+    run->push_back(hyphenchar, typeset->metrics()->metrics(hyphenchar, f));
+    return run;
+  }
+  else
+  {
+    return arena ? typeset->typeset(hyphenchar, f, *arena) : typeset->typeset(hyphenchar, f);
+  }
+}
+
 } // namespace tex
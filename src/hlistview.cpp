@@ -0,0 +1,118 @@
+// Copyright (C) 2020 Vincent Chambrin
+// This file is part of the 'typeset' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "tex/hlistview.h"
+
+#include "tex/visit.h"
+
+#include <algorithm>
+
+namespace tex
+{
+
+HListView::HListView(const List& hlist)
+  : HListView(hlist.begin(), hlist.end())
+{
+
+}
+
+HListView::HListView(List::const_iterator begin, List::const_iterator end)
+{
+  for (auto it = begin; it != end; ++it)
+    append(it);
+
+  m_positions.push_back(end);
+}
+
+void HListView::append(List::const_iterator it)
+{
+  float w = 0.f;
+  float h = 0.f;
+  float d = 0.f;
+  GlueOrder shrinkorder = GlueOrder::Normal;
+  GlueOrder stretchorder = GlueOrder::Normal;
+  float shrink = 0.f;
+  float stretch = 0.f;
+  int p = 0;
+
+  visit(**it, overloaded(
+    [&](const ListBox& box) {
+      w = box.width();
+      h = box.height() - box.shiftAmount();
+      d = box.depth() + box.shiftAmount();
+    },
+    [&](const Box& box) {
+      w = box.width();
+      h = box.height();
+      d = box.depth();
+    },
+    [&](const Kern& kern) {
+      w = kern.space();
+    },
+    [&](const Glue& glue) {
+      w = glue.space();
+      shrink = glue.shrink();
+      shrinkorder = glue.shrinkOrder();
+      stretch = glue.stretch();
+      stretchorder = glue.stretchOrder();
+    },
+    [&](const Penalty& penalty) {
+      p = penalty.value();
+    },
+    [&](const Discretionary& disc) {
+      w = disc.nobreakWidth();
+      h = disc.nobreakHeight();
+      d = disc.nobreakDepth();
+    },
+    [](const Node&) { }
+  ));
+
+  m_kinds.push_back((*it)->kind());
+  m_widths.push_back(w);
+  m_heights.push_back(h);
+  m_depths.push_back(d);
+
+  for (size_t i(0); i < 4; ++i)
+  {
+    m_shrink[i].push_back(i == static_cast<size_t>(shrinkorder) ? shrink : 0.f);
+    m_stretch[i].push_back(i == static_cast<size_t>(stretchorder) ? stretch : 0.f);
+  }
+
+  m_penalties.push_back(p);
+  m_positions.push_back(it);
+}
+
+void HListView::accumulate(size_t i, GlueShrink& shrink, GlueStretch& stretch) const
+{
+  shrink.normal += m_shrink[0][i];
+  shrink.fil += m_shrink[1][i];
+  shrink.fill += m_shrink[2][i];
+  shrink.filll += m_shrink[3][i];
+
+  stretch.normal += m_stretch[0][i];
+  stretch.fil += m_stretch[1][i];
+  stretch.fill += m_stretch[2][i];
+  stretch.filll += m_stretch[3][i];
+}
+
+/*!
+ * \fn void getBoxingInfo(size_t begin, size_t end, BoxingInfo& info) const
+ * \brief Adds the nodes in the range [begin, end) to \a info
+ *
+ * The result is the same as calling HBox::accumulate() on each node in order.
+ */
+void HListView::getBoxingInfo(size_t begin, size_t end, BoxingInfo& info) const
+{
+  for (size_t i(begin); i < end; ++i)
+  {
+    info.width += m_widths[i];
+    info.height = std::max(info.height, m_heights[i]);
+    info.depth = std::max(info.depth, m_depths[i]);
+
+    if (isGlue(i))
+      accumulate(i, info.shrink, info.stretch);
+  }
+}
+
+} // namespace tex
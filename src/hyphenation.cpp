@@ -0,0 +1,514 @@
+// Copyright (C) 2020 Vincent Chambrin
+// This file is part of the 'typeset' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "tex/hyphenation.h"
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // defined(_WIN32)
+
+namespace tex
+{
+
+namespace
+{
+
+/*!
+ * \class MappedFile
+ * \brief A read-only memory mapping of a whole file
+ */
+class MappedFile
+{
+public:
+  explicit MappedFile(const std::string& path);
+  MappedFile(const MappedFile&) = delete;
+  ~MappedFile();
+
+  const char* data() const { return m_data; }
+  size_t size() const { return m_size; }
+
+  MappedFile& operator=(const MappedFile&) = delete;
+
+private:
+  const char* m_data = nullptr;
+  size_t m_size = 0;
+#if defined(_WIN32)
+  HANDLE m_file = INVALID_HANDLE_VALUE;
+  HANDLE m_mapping = nullptr;
+#endif // defined(_WIN32)
+};
+
+#if defined(_WIN32)
+
+MappedFile::MappedFile(const std::string& path)
+{
+  m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+  if (m_file == INVALID_HANDLE_VALUE)
+    throw std::runtime_error{ "Could not open " + path };
+
+  LARGE_INTEGER size;
+
+  if (!GetFileSizeEx(m_file, &size))
+  {
+    CloseHandle(m_file);
+    throw std::runtime_error{ "Could not read the size of " + path };
+  }
+
+  m_size = static_cast<size_t>(size.QuadPart);
+
+  if (m_size == 0)
+    return;
+
+  m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  m_data = m_mapping ? static_cast<const char*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0)) : nullptr;
+
+  if (!m_data)
+  {
+    if (m_mapping)
+      CloseHandle(m_mapping);
+
+    CloseHandle(m_file);
+    throw std::runtime_error{ "Could not map " + path };
+  }
+}
+
+MappedFile::~MappedFile()
+{
+  if (m_data)
+    UnmapViewOfFile(m_data);
+
+  if (m_mapping)
+    CloseHandle(m_mapping);
+
+  CloseHandle(m_file);
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& path)
+{
+  int fd = ::open(path.c_str(), O_RDONLY);
+
+  if (fd == -1)
+    throw std::runtime_error{ "Could not open " + path };
+
+  struct stat st;
+
+  if (::fstat(fd, &st) == -1)
+  {
+    ::close(fd);
+    throw std::runtime_error{ "Could not read the size of " + path };
+  }
+
+  m_size = static_cast<size_t>(st.st_size);
+
+  if (m_size > 0)
+  {
+    void* addr = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    if (addr == MAP_FAILED)
+    {
+      ::close(fd);
+      throw std::runtime_error{ "Could not map " + path };
+    }
+
+    m_data = static_cast<const char*>(addr);
+  }
+
+  // The mapping stays valid once the descriptor is closed
+  ::close(fd);
+}
+
+MappedFile::~MappedFile()
+{
+  if (m_data)
+    ::munmap(const_cast<char*>(m_data), m_size);
+}
+
+#endif // defined(_WIN32)
+
+bool is_space(char c)
+{
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+
+} // namespace
+
+Hyphenator::Hyphenator()
+{
+  pack();
+}
+
+Hyphenator::~Hyphenator()
+{
+
+}
+
+/*!
+ * \fn void load(const std::string& path)
+ * \brief Adds the patterns and exceptions of a file
+ *
+ * The file is memory-mapped and parsed in place; see addPatterns() for
+ * its format.
+ * Throws std::runtime_error if the file cannot be read.
+ */
+void Hyphenator::load(const std::string& path)
+{
+  MappedFile file{ path };
+  parse(file.data(), file.data() + file.size());
+  pack();
+}
+
+/*!
+ * \fn void addPatterns(const std::string& patterns)
+ * \brief Adds whitespace-separated patterns
+ *
+ * The text may also contain \c \\patterns{...} and \c \\hyphenation{...}
+ * groups, as in the hyphenation files of TeX, and \c % comments.
+ * Words outside of a \c \\hyphenation group are patterns.
+ */
+void Hyphenator::addPatterns(const std::string& patterns)
+{
+  parse(patterns.data(), patterns.data() + patterns.size());
+  pack();
+}
+
+/*!
+ * \fn void addException(const std::string& word)
+ * \brief Adds a word whose hyphenation points are given by hyphens, e.g. \c "ta-ble"
+ */
+void Hyphenator::addException(const std::string& word)
+{
+  addException(word.data(), word.data() + word.size());
+
+  std::lock_guard<std::mutex> lock{ m_mutex };
+  m_cache.clear();
+}
+
+/*!
+ * \fn std::vector<size_t> hyphenate(const std::u32string& word) const
+ * \brief Returns the hyphenation points of a word
+ *
+ * A hyphenation point \c i means that the word may be broken between its
+ * characters \c i-1 and \c i.
+ * There are at least \a lefthyphenmin characters before and
+ * \a righthyphenmin characters after each point.
+ */
+std::vector<size_t> Hyphenator::hyphenate(const std::u32string& word) const
+{
+  {
+    std::lock_guard<std::mutex> lock{ m_mutex };
+    auto it = m_cache.find(word);
+
+    if (it != m_cache.end())
+      return it->second;
+  }
+
+  std::vector<size_t> result = compute(word);
+
+  std::lock_guard<std::mutex> lock{ m_mutex };
+  m_cache.emplace(word, result);
+
+  return result;
+}
+
+std::vector<size_t> Hyphenator::hyphenate(const std::string& word) const
+{
+  std::u32string str;
+
+  for (auto it = word.cbegin(); it != word.cend();)
+    str.push_back(static_cast<char32_t>(read_utf8_char(it)));
+
+  return hyphenate(str);
+}
+
+size_t Hyphenator::cacheSize() const
+{
+  std::lock_guard<std::mutex> lock{ m_mutex };
+  return m_cache.size();
+}
+
+void Hyphenator::clearCache()
+{
+  std::lock_guard<std::mutex> lock{ m_mutex };
+  m_cache.clear();
+}
+
+void Hyphenator::parse(const char* begin, const char* end)
+{
+  bool exceptions = false;
+
+  while (begin != end)
+  {
+    if (is_space(*begin) || *begin == '{')
+    {
+      ++begin;
+    }
+    else if (*begin == '}')
+    {
+      exceptions = false;
+      ++begin;
+    }
+    else if (*begin == '%')
+    {
+      begin = std::find(begin, end, '\n');
+    }
+    else
+    {
+      const char* word_end = std::find_if(begin, end, [](char c) {
+        return is_space(c) || c == '{' || c == '}' || c == '%';
+        });
+
+      const size_t len = static_cast<size_t>(word_end - begin);
+
+      if (len == 9 && std::strncmp(begin, "\\patterns", len) == 0)
+        exceptions = false;
+      else if (len == 12 && std::strncmp(begin, "\\hyphenation", len) == 0)
+        exceptions = true;
+      else if (exceptions)
+        addException(begin, word_end);
+      else
+        addPattern(begin, word_end);
+
+      begin = word_end;
+    }
+  }
+}
+
+void Hyphenator::addPattern(const char* begin, const char* end)
+{
+  const std::string str{ begin, end };
+  std::u32string letters;
+  std::vector<uint8_t> values{ 0 };
+
+  for (auto it = str.cbegin(); it != str.cend();)
+  {
+    if ('0' <= *it && *it <= '9')
+    {
+      values.back() = static_cast<uint8_t>(*(it++) - '0');
+    }
+    else
+    {
+      letters.push_back(lowercase(static_cast<char32_t>(read_utf8_char(it))));
+      values.push_back(0);
+    }
+  }
+
+  m_patterns[letters] = std::move(values);
+}
+
+void Hyphenator::addException(const char* begin, const char* end)
+{
+  const std::string str{ begin, end };
+  std::u32string letters;
+  std::vector<size_t> points;
+
+  for (auto it = str.cbegin(); it != str.cend();)
+  {
+    if (*it == '-')
+    {
+      points.push_back(letters.size());
+      ++it;
+    }
+    else
+    {
+      letters.push_back(lowercase(static_cast<char32_t>(read_utf8_char(it))));
+    }
+  }
+
+  m_exceptions[letters] = std::move(points);
+}
+
+/*!
+ * \fn void pack()
+ * \brief Builds the packed trie of the patterns
+ *
+ * The nodes are created in breadth-first order: the sorted patterns that
+ * share the prefix of a node form a range, which is split by the next
+ * letter to give the children of the node.
+ */
+void Hyphenator::pack()
+{
+  struct Range
+  {
+    size_t node;
+    size_t begin;
+    size_t end;
+    size_t depth;
+  };
+
+  std::vector<const std::pair<const std::u32string, std::vector<uint8_t>>*> patterns;
+  patterns.reserve(m_patterns.size());
+
+  for (const auto& p : m_patterns)
+    patterns.push_back(&p);
+
+  m_nodes.assign(1, PackedNode{ 0, 0, 0, 0 });
+  m_labels.assign(1, 0);
+  m_values.clear();
+
+  std::deque<Range> queue;
+  queue.push_back(Range{ 0, 0, patterns.size(), 0 });
+
+  while (!queue.empty())
+  {
+    const Range r = queue.front();
+    queue.pop_front();
+
+    size_t i = r.begin;
+
+    // A pattern equal to the prefix of the node sorts first
+    if (i < r.end && patterns[i]->first.size() == r.depth)
+    {
+      const std::vector<uint8_t>& values = patterns[i]->second;
+      m_nodes[r.node].values = static_cast<uint32_t>(m_values.size());
+      m_nodes[r.node].value_count = static_cast<uint32_t>(values.size());
+      m_values.insert(m_values.end(), values.begin(), values.end());
+      ++i;
+    }
+
+    m_nodes[r.node].children = static_cast<uint32_t>(m_nodes.size());
+
+    while (i < r.end)
+    {
+      const char32_t c = patterns[i]->first[r.depth];
+      size_t j = i + 1;
+
+      while (j < r.end && patterns[j]->first[r.depth] == c)
+        ++j;
+
+      m_nodes.push_back(PackedNode{ 0, 0, 0, 0 });
+      m_labels.push_back(c);
+      queue.push_back(Range{ m_nodes.size() - 1, i, j, r.depth + 1 });
+
+      i = j;
+    }
+
+    m_nodes[r.node].child_count = static_cast<uint32_t>(m_nodes.size()) - m_nodes[r.node].children;
+  }
+
+  std::lock_guard<std::mutex> lock{ m_mutex };
+  m_cache.clear();
+}
+
+std::vector<size_t> Hyphenator::compute(const std::u32string& word) const
+{
+  std::vector<size_t> result;
+
+  const size_t n = word.size();
+
+  if (lefthyphenmin < 1 || righthyphenmin < 1 || n < static_cast<size_t>(lefthyphenmin + righthyphenmin))
+    return result;
+
+  std::u32string w;
+  w.reserve(n + 2);
+  w.push_back('.');
+
+  for (char32_t c : word)
+    w.push_back(lowercase(c));
+
+  w.push_back('.');
+
+  const size_t first = static_cast<size_t>(lefthyphenmin);
+  const size_t last = n - static_cast<size_t>(righthyphenmin);
+
+  auto exception = m_exceptions.find(w.substr(1, n));
+
+  if (exception != m_exceptions.end())
+  {
+    for (size_t p : exception->second)
+    {
+      if (first <= p && p <= last)
+        result.push_back(p);
+    }
+
+    return result;
+  }
+
+  // values[k] is the value of the position before w[k]
+  std::vector<uint8_t> values(w.size() + 1, 0);
+
+  for (size_t start(0); start < w.size(); ++start)
+  {
+    const PackedNode* node = &m_nodes.front();
+
+    for (size_t k(start); k < w.size() && node->child_count > 0; ++k)
+    {
+      auto labels_begin = m_labels.begin() + node->children;
+      auto labels_end = labels_begin + node->child_count;
+      auto it = std::lower_bound(labels_begin, labels_end, w[k]);
+
+      if (it == labels_end || *it != w[k])
+        break;
+
+      node = &m_nodes[static_cast<size_t>(it - m_labels.begin())];
+
+      for (uint32_t v(0); v < node->value_count; ++v)
+        values[start + v] = std::max(values[start + v], m_values[node->values + v]);
+    }
+  }
+
+  // The position before the i-th character of the word is before w[i+1]
+  for (size_t p(first); p <= last; ++p)
+  {
+    if (values[p + 1] % 2 == 1)
+      result.push_back(p);
+  }
+
+  return result;
+}
+
+/*!
+ * \fn bool isLetter(Character c)
+ * \brief Returns whether a character may be part of a hyphenated word
+ *
+ * These are the letters of the Latin, Greek, Cyrillic, Armenian, Hebrew
+ * and Arabic alphabets, i.e. the characters that TeX's hyphenation
+ * files give a nonzero \c \\lccode. Signs (e.g. the multiplication
+ * sign U+00D7), punctuation and combining marks are not letters.
+ */
+bool Hyphenator::isLetter(Character c)
+{
+  // Sorted ranges of letters, bounds included
+  static const std::pair<Character, Character> letters[] = {
+    { 0x0041, 0x005A }, { 0x0061, 0x007A }, { 0x00AA, 0x00AA }, { 0x00B5, 0x00B5 },
+    { 0x00BA, 0x00BA }, { 0x00C0, 0x00D6 }, { 0x00D8, 0x00F6 }, { 0x00F8, 0x02AF },
+    { 0x0370, 0x0373 }, { 0x0376, 0x0377 }, { 0x037B, 0x037D }, { 0x037F, 0x037F },
+    { 0x0386, 0x0386 }, { 0x0388, 0x038A }, { 0x038C, 0x038C }, { 0x038E, 0x03A1 },
+    { 0x03A3, 0x03F5 }, { 0x03F7, 0x0481 }, { 0x048A, 0x052F }, { 0x0531, 0x0556 },
+    { 0x0561, 0x0587 }, { 0x05D0, 0x05EA }, { 0x0620, 0x064A }, { 0x1E00, 0x1F15 },
+    { 0x1F18, 0x1F1D }, { 0x1F20, 0x1F45 }, { 0x1F48, 0x1F4D }, { 0x1F50, 0x1F57 },
+    { 0x1F59, 0x1F59 }, { 0x1F5B, 0x1F5B }, { 0x1F5D, 0x1F5D }, { 0x1F5F, 0x1F7D },
+    { 0x1F80, 0x1FB4 }, { 0x1FB6, 0x1FBC }, { 0x1FBE, 0x1FBE }, { 0x1FC2, 0x1FC4 },
+    { 0x1FC6, 0x1FCC }, { 0x1FD0, 0x1FD3 }, { 0x1FD6, 0x1FDB }, { 0x1FE0, 0x1FEC },
+    { 0x1FF2, 0x1FF4 }, { 0x1FF6, 0x1FFC },
+  };
+
+  auto it = std::upper_bound(std::begin(letters), std::end(letters), c, [](Character c, const std::pair<Character, Character>& r) {
+    return c < r.first;
+  });
+
+  return it != std::begin(letters) && c <= std::prev(it)->second;
+}
+
+char32_t Hyphenator::lowercase(char32_t c)
+{
+  return ('A' <= c && c <= 'Z') ? c - 'A' + 'a' : c;
+}
+
+} // namespace tex
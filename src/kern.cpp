@@ -8,14 +8,15 @@ namespace tex
 {
 
 Kern::Kern(float s)
-  : mSpace(s)
+  : Node(NodeKind::Kern)
+  , mSpace(s)
 {
 
 }
 
-std::shared_ptr<Kern> kern(float space)
+NodeRef<Kern> kern(float space)
 {
-  return std::make_shared<Kern>(space);
+  return make_node<Kern>(space);
 }
 
 } // namespace tex
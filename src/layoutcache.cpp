@@ -0,0 +1,398 @@
+// Copyright (C) 2020 Vincent Chambrin
+// This file is part of the 'typeset' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "tex/layoutcache.h"
+
+#include "tex/hbox.h"
+#include "tex/visit.h"
+
+#include <cstring>
+
+namespace tex
+{
+
+namespace
+{
+
+// Computes the key and, in the same pass, the hash used to check hits
+struct Hasher
+{
+  static constexpr uint64_t CheckSeed = 0x2545f4914f6cdd1dull;
+
+  uint64_t value = 0;
+  uint64_t check = CheckSeed;
+
+  // Mixes with the finalizer of splitmix64, then combines as boost::hash_combine
+  static uint64_t mix(uint64_t v)
+  {
+    v += 0x9e3779b97f4a7c15ull;
+    v = (v ^ (v >> 30)) * 0xbf58476d1ce4e5b9ull;
+    v = (v ^ (v >> 27)) * 0x94d049bb133111ebull;
+    return v ^ (v >> 31);
+  }
+
+  static void combine(uint64_t& seed, uint64_t v)
+  {
+    seed ^= v + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2);
+  }
+
+  void add(uint64_t v)
+  {
+    combine(value, mix(v));
+    combine(check, mix(v ^ CheckSeed));
+  }
+
+  void add(int v)
+  {
+    add(static_cast<uint64_t>(static_cast<int64_t>(v)));
+  }
+
+  void add(float v)
+  {
+    // -0 and 0 must hash the same
+    if (v == 0.f)
+      v = 0.f;
+
+    uint32_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    add(static_cast<uint64_t>(bits));
+  }
+
+  void add(const Glue* glue)
+  {
+    if (!glue)
+    {
+      add(uint64_t(0));
+      return;
+    }
+
+    add(glue->space());
+    add(glue->stretch());
+    add(glue->shrink());
+    add(static_cast<int>(glue->stretchOrder()));
+    add(static_cast<int>(glue->shrinkOrder()));
+  }
+
+  void add(const Box& box)
+  {
+    add(box.width());
+    add(box.height());
+    add(box.depth());
+  }
+
+  template<typename L>
+  void addList(const L& list)
+  {
+    add(static_cast<uint64_t>(list.size()));
+
+    for (const auto& node : list)
+      add(*node);
+  }
+
+  void add(const Node& node)
+  {
+    add(static_cast<int>(node.kind()));
+
+    visit(node, overloaded(
+      [this](const Glue& glue) { add(&glue); },
+      [this](const Kern& kern) { add(kern.space()); },
+      [this](const Penalty& penalty) { add(penalty.value()); },
+      [this](const Discretionary& disc) {
+        addList(disc.prebreak());
+        addList(disc.postbreak());
+        addList(disc.nobreak());
+      },
+      [this](const CharacterBox& box) {
+        add(static_cast<const Box&>(box));
+        add(box.font().id());
+        add(static_cast<uint64_t>(box.character()));
+      },
+      [this](const GlyphRun& run) {
+        add(static_cast<const Box&>(run));
+        add(run.font().id());
+        addList(run.characters(), run.advances());
+      },
+      [this](const ListBox& box) {
+        add(static_cast<const Box&>(box));
+        add(box.shiftAmount());
+        add(box.glueRatio());
+        add(static_cast<int>(box.glueOrder()));
+        addList(box.list());
+      },
+      [this](const Box& box) { add(box); },
+      [](const Node&) { }
+    ));
+  }
+
+  template<typename C, typename A>
+  void addList(const C& characters, const A& advances)
+  {
+    add(static_cast<uint64_t>(characters.size()));
+
+    for (size_t i(0); i < characters.size(); ++i)
+    {
+      add(static_cast<uint64_t>(characters[i]));
+      add(advances[i]);
+    }
+  }
+};
+
+template<typename L>
+size_t list_footprint(const L& list, size_t overhead)
+{
+  size_t result = 0;
+
+  for (const auto& node : list)
+  {
+    result += overhead;
+
+    result += visit(*node, overloaded(
+      [](const Glue&) { return sizeof(Glue); },
+      [](const Kern&) { return sizeof(Kern); },
+      [](const Penalty&) { return sizeof(Penalty); },
+      [overhead](const Discretionary& disc) {
+        return sizeof(Discretionary) + list_footprint(disc.prebreak(), overhead)
+          + list_footprint(disc.postbreak(), overhead) + list_footprint(disc.nobreak(), overhead);
+      },
+      [](const CharacterBox&) { return sizeof(CharacterBox); },
+      [](const GlyphRun& run) {
+        const size_t heap = run.size() > GlyphRun::InlineCapacity ? run.size() * (sizeof(Character) + 3 * sizeof(float)) : 0;
+        return sizeof(GlyphRun) + heap;
+      },
+      [](const HBox& box) { return sizeof(HBox) + list_footprint(box.list(), sizeof(NodeRef<Node>)); },
+      [](const VBox& box) { return sizeof(VBox) + list_footprint(box.list(), sizeof(NodeRef<Node>)); },
+      [](const Rule&) { return sizeof(Rule); },
+      [](const Box&) { return sizeof(Box); },
+      [](const Node&) { return sizeof(Node); }
+    ));
+  }
+
+  return result;
+}
+
+} // namespace
+
+LayoutCache::LayoutCache(size_t budget)
+  : m_budget(budget)
+{
+
+}
+
+LayoutCache::~LayoutCache()
+{
+
+}
+
+/*!
+ * \fn void setBudget(size_t budget)
+ * \brief Sets the maximum estimated size, in bytes, of the cached lines
+ *
+ * Paragraphs are evicted if the cache no longer fits.
+ */
+void LayoutCache::setBudget(size_t budget)
+{
+  m_budget = budget;
+  evict();
+}
+
+/*!
+ * \fn List create(Paragraph& paragraph, const List& hlist)
+ * \brief Returns the lines of a prepared horizontal list, breaking it only if it is not cached
+ *
+ * As with Paragraph::create(), the \c prevdepth of the paragraph is set to
+ * the depth of the last line.
+ */
+List LayoutCache::create(Paragraph& paragraph, const List& hlist)
+{
+  Check check;
+  const Key key = hash(paragraph, hlist, check);
+
+  if (const List* lines = find(key, check, paragraph))
+    return *lines;
+
+  List lines = paragraph.create(hlist);
+  insert(key, check, lines, paragraph);
+  return lines;
+}
+
+List LayoutCache::create(Paragraph& paragraph, List&& hlist)
+{
+  Check check;
+  const Key key = hash(paragraph, hlist, check);
+
+  if (const List* lines = find(key, check, paragraph))
+  {
+    hlist.clear();
+    return *lines;
+  }
+
+  List lines = paragraph.create(std::move(hlist));
+  insert(key, check, lines, paragraph);
+  return lines;
+}
+
+bool LayoutCache::contains(Key key) const
+{
+  return m_index.find(key) != m_index.end();
+}
+
+void LayoutCache::clear()
+{
+  m_index.clear();
+  m_entries.clear();
+  m_bytes = 0;
+}
+
+/*!
+ * \fn Key hash(const Paragraph& paragraph, const List& hlist)
+ * \brief Computes the key of a horizontal list broken with the given parameters
+ */
+LayoutCache::Key LayoutCache::hash(const Paragraph& paragraph, const List& hlist)
+{
+  Check check;
+  return hash(paragraph, hlist, check);
+}
+
+/*!
+ * \fn Key hash(const Paragraph& paragraph, const List& hlist, Check& check)
+ * \brief Computes the key of a horizontal list and the values that a hit must match
+ */
+LayoutCache::Key LayoutCache::hash(const Paragraph& paragraph, const List& hlist, Check& check)
+{
+  Hasher h;
+
+  h.add(paragraph.pretolerance);
+  h.add(paragraph.tolerance);
+  h.add(paragraph.adjdemerits);
+  h.add(paragraph.linepenalty);
+  h.add(paragraph.hyphenpenalty);
+  h.add(paragraph.exhyphenpenalty);
+  h.add(paragraph.hsize);
+  h.add(paragraph.hangindent);
+  h.add(paragraph.hangafter);
+
+  h.add(static_cast<uint64_t>(paragraph.parshape.size()));
+
+  for (const ParshapeSpec& spec : paragraph.parshape)
+  {
+    h.add(spec.indent);
+    h.add(spec.length);
+  }
+
+  h.add(paragraph.leftskip.get());
+  h.add(paragraph.rightskip.get());
+  h.add(paragraph.parfillskip.get());
+  h.add(paragraph.baselineskip.get());
+  h.add(paragraph.lineskip.get());
+  h.add(paragraph.lineskiplimit);
+  h.add(paragraph.prevdepth);
+  h.add(static_cast<int>(paragraph.concave));
+  h.add(static_cast<uint64_t>(paragraph.maxactive));
+  h.add(static_cast<uint64_t>(paragraph.demeritscutoff));
+
+  h.addList(hlist);
+
+  BoxingInfo info;
+
+  for (const auto& node : hlist)
+    HBox::accumulate(info, *node);
+
+  check.hash = h.check;
+  check.nodes = hlist.size();
+  check.width = info.width;
+
+  return h.value;
+}
+
+/*!
+ * \fn size_t footprint(const List& vlist)
+ * \brief Estimates the memory used by the nodes of a list, in bytes
+ *
+ * Nodes that are shared between lists are counted each time they appear.
+ */
+size_t LayoutCache::footprint(const List& vlist)
+{
+  // The nodes of a std::list hold two pointers besides the value
+  return list_footprint(vlist, sizeof(NodeRef<Node>) + 2 * sizeof(void*));
+}
+
+/*!
+ * \fn const List* find(Key key, const Check& check, Paragraph& paragraph)
+ * \brief Returns the cached lines of a paragraph, or null if they are not cached
+ *
+ * An entry with the same key but another \a check is a collision and is
+ * treated as a miss; it is replaced when the lines are inserted.
+ */
+const List* LayoutCache::find(Key key, const Check& check, Paragraph& paragraph)
+{
+  auto it = m_index.find(key);
+
+  if (it != m_index.end())
+  {
+    const Check& stored = it->second->check;
+
+    if (stored.hash != check.hash || stored.nodes != check.nodes || stored.width != check.width)
+    {
+      ++statistics.collisions;
+      it = m_index.end();
+    }
+  }
+
+  if (it == m_index.end())
+  {
+    ++statistics.misses;
+    return nullptr;
+  }
+
+  ++statistics.hits;
+
+  m_entries.splice(m_entries.begin(), m_entries, it->second);
+  paragraph.prevdepth = it->second->prevdepth;
+
+  return &it->second->lines;
+}
+
+/*!
+ * \fn void insert(Key key, const Check& check, const List& lines, const Paragraph& paragraph)
+ * \brief Adds the lines of a paragraph as the most recently used entry
+ *
+ * An entry with the same key is replaced.
+ * Lines that do not fit in the budget by themselves are not cached.
+ */
+void LayoutCache::insert(Key key, const Check& check, const List& lines, const Paragraph& paragraph)
+{
+  auto it = m_index.find(key);
+
+  if (it != m_index.end())
+  {
+    m_bytes -= it->second->bytes;
+    m_entries.erase(it->second);
+    m_index.erase(it);
+  }
+
+  const size_t bytes = footprint(lines);
+
+  if (bytes > m_budget)
+    return;
+
+  m_entries.push_front(Entry{ key, check, lines, paragraph.prevdepth, bytes });
+  m_index[key] = m_entries.begin();
+  m_bytes += bytes;
+
+  evict();
+}
+
+void LayoutCache::evict()
+{
+  while (m_bytes > m_budget && !m_entries.empty())
+  {
+    const Entry& entry = m_entries.back();
+    m_bytes -= entry.bytes;
+    m_index.erase(entry.key);
+    m_entries.pop_back();
+    ++statistics.evictions;
+  }
+}
+
+} // namespace tex
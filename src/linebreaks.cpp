@@ -4,13 +4,18 @@
 
 #include "tex/linebreaks.h"
 
+#include "tex/discretionary.h"
 #include "tex/glue.h"
+#include "tex/hlistview.h"
 #include "tex/kern.h"
+#include "tex/nodearena.h"
 #include "tex/penalty.h"
 #include "tex/vbox.h"
 
 #include <algorithm>
 #include <cmath>
+#include <deque>
+#include <limits>
 #include <numeric>
 #include <stdexcept>
 #include <utility>
@@ -21,9 +26,9 @@ namespace tex
 {
 
 Paragraph::Totals::Totals()
-  : width(0.f)
-  , stretch(0.f)
-  , shrink(0.f)
+  : width(0)
+  , stretch{ 0, 0, 0, 0 }
+  , shrink{ 0, 0, 0, 0 }
 {
 
 }
@@ -52,12 +57,12 @@ Paragraph::Breakpoint::Breakpoint(const List::const_iterator & pos, Demerits d,
 
 Paragraph::Paragraph()
 {
-  leftskip = std::make_shared<Glue>(0.f, 0.f, 0.f);
+  leftskip = make_node<Glue>(0.f, 0.f, 0.f);
   rightskip = leftskip;
-  baselineskip = std::make_shared<Glue>(12.f, 0.f, 2.f);
-  lineskip = std::make_shared<Glue>(3.f, -1.f, 0.f);
+  baselineskip = make_node<Glue>(12.f, 0.f, 2.f);
+  lineskip = make_node<Glue>(3.f, -1.f, 0.f);
   lineskiplimit = 2.f;
-  parfillskip = std::make_shared<Glue>(0.f, 0.f, 1.f, GlueOrder::Normal, GlueOrder::Fil);
+  parfillskip = make_node<Glue>(0.f, 0.f, 1.f, GlueOrder::Normal, GlueOrder::Fil);
 }
 
 bool Paragraph::hangindentAppliesToLine(size_t n) const
@@ -65,7 +70,58 @@ bool Paragraph::hangindentAppliesToLine(size_t n) const
   return (hangafter < 0 && static_cast<int>(n) < -hangafter) || (hangafter >= 0 && hangafter <= static_cast<int>(n));
 }
 
+/*!
+ * \fn bool hasConcaveDemerits(float threshold) const
+ * \brief Returns whether a pass with the given \a threshold can use the concave mode
+ *
+ * The lines must all have the same length (no parshape nor hangindent)
+ * and fitness classes must not matter (adjdemerits is 0), so that the
+ * demerits of a line only depend on where it starts and ends.
+ * The badness of a feasible line must also stay below InfBad: capped
+ * badnesses would break the quadrangle inequality (see concaveBreaks()).
+ */
+bool Paragraph::hasConcaveDemerits(float threshold) const
+{
+  return parshape.empty() && hangindent == 0.f && adjdemerits == 0 && 100.f * threshold * threshold * threshold < InfBad;
+}
+
+/*!
+ * \fn size_t lineClass(size_t n) const
+ * \brief Returns the class of the n-th line
+ *
+ * Lines have the same length from the last line of the parshape, or from the
+ * first line after the hangindent region (or the first line with a hangindent
+ * if \c hangafter is not negative), up to the end of the paragraph; this is
+ * TeX's \c easy_line.
+ * These lines all have the class of the first of them, and the other lines
+ * are their own class.
+ *
+ * Breakpoints that start lines of the same class are interchangeable for
+ * the rest of the paragraph: only the best of them for each fitness class
+ * needs to be kept when breaking at a given position.
+ */
+size_t Paragraph::lineClass(size_t n) const
+{
+  size_t easyline = 0;
+
+  if (!parshape.empty())
+    easyline = parshape.size() - 1;
+  else if (hangindent != 0.f)
+    easyline = static_cast<size_t>(std::abs(hangafter));
+
+  return std::min(n, easyline);
+}
+
 float Paragraph::linelength(size_t n) const
+{
+  return linelength(n, hsize);
+}
+
+/*!
+ * \fn float linelength(size_t n, float hsize) const
+ * \brief Returns the length of the n-th line if the paragraph had the given \a hsize
+ */
+float Paragraph::linelength(size_t n, float hsize) const
 {
   if (!parshape.empty())
   {
@@ -82,81 +138,927 @@ float Paragraph::linelength(size_t n) const
 }
 
 std::list<std::shared_ptr<Paragraph::Breakpoint>> Paragraph::computeFeasibleBreakpoints(const List& hlist)
+{
+  return computeFeasibleBreakpoints(HListView{ hlist });
+}
+
+/*!
+ * \fn std::list<std::shared_ptr<Breakpoint>> computeFeasibleBreakpoints(const HListView& hlist)
+ * \brief Computes the active breakpoints at the end of the paragraph
+ *
+ * As in TeX, a first pass only accepts lines whose glue ratio does not
+ * exceed pretolerance and does not break at discretionaries; a second pass
+ * with tolerance is only run if the first one fails.
+ * The first pass is skipped if pretolerance is negative.
+ */
+std::list<std::shared_ptr<Paragraph::Breakpoint>> Paragraph::computeFeasibleBreakpoints(const HListView& hlist)
+{
+  if (pretolerance >= 0)
+  {
+    std::list<std::shared_ptr<Breakpoint>> result = computeFeasibleBreakpoints(hlist, pretolerance, false);
+
+    if (!result.empty())
+    {
+      ++statistics.firstpass;
+      return result;
+    }
+  }
+
+  ++statistics.secondpass;
+  return computeFeasibleBreakpoints(hlist, tolerance, true);
+}
+
+std::list<std::shared_ptr<Paragraph::Breakpoint>> Paragraph::computeFeasibleBreakpoints(const HListView& hlist, float threshold, bool discretionaries)
 {
   std::list<std::shared_ptr<Breakpoint>> activeNodes;
   Totals sum;
-  List::const_iterator prevnode = hlist.end();
+  const Totals skips = skipTotals();
+
+  activeNodes.push_back(std::make_shared<Breakpoint>(hlist.position(0), 0, 0, FitnessClass::Tight, Totals{}, nullptr));
+
+  for (size_t i(0); i < hlist.size(); ++i)
+  {
+    if (hlist.isBox(i))
+    {
+      accumulate(sum, hlist, i);
+    }
+    else if (hlist.isGlue(i))
+    {
+      if (i > 0 && hlist.isBox(i - 1))
+        tryBreak(activeNodes, hlist, i, sum, skips, threshold);
+
+      accumulate(sum, hlist, i);
+    }
+    else if (hlist.isKern(i))
+    {
+      accumulate(sum, hlist, i);
+    }
+    else if (hlist.isPenalty(i) && !isForbiddenLinebreak(hlist, i))
+    {
+      tryBreak(activeNodes, hlist, i, sum, skips, threshold);
+    }
+    else if (hlist.isDiscretionary(i))
+    {
+      if (discretionaries)
+        tryBreak(activeNodes, hlist, i, sum, skips, threshold);
+
+      accumulate(sum, hlist, i);
+    }
+
+    if (activeNodes.empty())
+      break;
+  }
+
+  return activeNodes;
+}
+
+std::vector<Paragraph::Breakpoint> Paragraph::computeBreakpoints(const std::list<std::shared_ptr<Breakpoint>>& candidates)
+{
+  auto best_breakpoint = *candidates.begin();
+
+  for (auto it = candidates.begin(); it != candidates.end(); ++it)
+  {
+    if ((*it)->demerits < best_breakpoint->demerits)
+      best_breakpoint = *it;
+  }
+
+  return computeBreakpoints(best_breakpoint);
+}
+
+std::vector<Paragraph::Breakpoint> Paragraph::computeBreakpoints(std::shared_ptr<Breakpoint> breakpoints)
+{
+  std::vector<Breakpoint> result;
+
+  do
+  {
+    result.push_back(*breakpoints);
+    breakpoints = breakpoints->previous;
+  } while (breakpoints != nullptr);
+
+  std::reverse(result.begin(), result.end());
+
+  return result;
+}
+
+std::vector<Paragraph::Breakpoint> Paragraph::computeBreakpoints(const List & hlist)
+{
+  return computeBreakpoints(HListView{ hlist });
+}
+
+std::vector<Paragraph::Breakpoint> Paragraph::computeBreakpoints(const HListView& hlist)
+{
+  std::list<std::shared_ptr<Breakpoint>> activeNodes = computeFeasibleBreakpoints(hlist);
+
+  if (activeNodes.size() == 0) 
+    throw std::runtime_error{ "Failed" };
+  
+  return computeBreakpoints(activeNodes);
+}
+
+struct PruningLimit
+{
+  size_t line;
+  Paragraph::Demerits demerits;
+  size_t ties;
+};
+
+struct Paragraph::BreakGraph
+{
+  float hsize;
+  float threshold;
+  bool discretionaries;
+  std::vector<BreakNode> nodes;
+  std::vector<size_t> active;
+  std::vector<size_t> buffer;
+  std::vector<std::pair<size_t, Demerits>> ranked;
+  std::vector<PruningLimit> limits;
+  bool pruning = true;
+};
+
+struct Paragraph::LinebreakState : BreakGraph
+{
+  Totals skips;
+  std::vector<Totals> totals;
+  std::vector<size_t> after;
+};
+
+std::vector<size_t> Paragraph::computeBreaks(const List& hlist)
+{
+  return computeBreaks(HListView{ hlist });
+}
+
+/*!
+ * \fn std::vector<size_t> computeBreaks(const HListView& hlist)
+ * \brief Computes the indices of the nodes at which the paragraph is broken
+ *
+ * This produces the same breakpoints as computeBreakpoints() but works on
+ * indices: the totals of the list are computed once as prefix sums, and
+ * breakpoints are stored in a single vector and refer to their predecessor
+ * by index.
+ *
+ * If \a concave is true, passes that satisfy hasConcaveDemerits() use
+ * concaveBreaks() instead of the active list; the breakpoints then have the
+ * same total demerits, but may differ when several choices are equally good.
+ * Checkpoints always use the active list.
+ */
+std::vector<size_t> Paragraph::computeBreaks(const HListView& hlist)
+{
+  LinebreakState state;
+  state.hsize = hsize;
+  initBreaks(state, hlist, 0);
+  return runPasses(state, hlist);
+}
+
+/*!
+ * \fn std::vector<size_t> runPasses(LinebreakState& state, const HListView& hlist)
+ * \brief Runs the first and, if needed, the second pass of the linebreaker
+ *
+ * The totals of \a state must have been computed with initBreaks().
+ */
+std::vector<size_t> Paragraph::runPasses(LinebreakState& state, const HListView& hlist)
+{
+  std::vector<size_t> breaks;
+
+  if (pretolerance >= 0 && runPass(state, hlist, pretolerance, false, breaks))
+  {
+    ++statistics.firstpass;
+    return breaks;
+  }
+
+  ++statistics.secondpass;
+
+  if (!runPass(state, hlist, tolerance, true, breaks))
+    throw std::runtime_error{ "Failed" };
+
+  return breaks;
+}
+
+/*!
+ * \fn bool runPass(LinebreakState& state, const HListView& hlist, float threshold, bool discretionaries, std::vector<size_t>& breaks)
+ * \brief Runs a pass of the linebreaker over the whole paragraph
+ *
+ * The concave mode is used if it is enabled and applies to the pass
+ * (see hasConcaveDemerits()); the active list otherwise.
+ * Returns false if the pass failed.
+ *
+ * If \c checkpruning is true and active breakpoints were pruned during
+ * the pass, the pass is run again without pruning and
+ * Statistics::prunechanged is incremented if the result differs.
+ */
+bool Paragraph::runPass(LinebreakState& state, const HListView& hlist, float threshold, bool discretionaries, std::vector<size_t>& breaks)
+{
+  startPass(state, threshold, discretionaries);
+
+  if (concave && hasConcaveDemerits(threshold) && !hlist.empty())
+  {
+    ++statistics.concave;
+    return concaveBreaks(state, hlist, breaks);
+  }
+
+  const size_t pruned = statistics.pruned;
+
+  breakLines(state, hlist, 0, nullptr);
+
+  const bool success = !state.active.empty();
+
+  if (success)
+    breaks = bestBreaks(state);
+
+  if (statistics.pruned != pruned)
+  {
+    ++statistics.prunedpasses;
+
+    if (checkpruning)
+    {
+      BreakGraph graph;
+      graph.hsize = state.hsize;
+      graph.pruning = false;
+      startPass(graph, threshold, discretionaries);
+
+      for (size_t i(0); i < hlist.size() && !graph.active.empty(); ++i)
+      {
+        if (isBreakOpportunity(hlist, i))
+          tryBreak(state, graph, hlist, i);
+      }
+
+      const bool changed = success ? bestBreaks(graph) != breaks : !graph.active.empty();
+
+      if (changed)
+        ++statistics.prunechanged;
+    }
+  }
+
+  return success;
+}
+
+/*!
+ * \fn std::vector<size_t> computeBreaks(const HListView& hlist, LinebreakCheckpoints& checkpoints)
+ * \brief Computes the breakpoints of the paragraph and saves checkpoints for later re-breaking
+ *
+ * \sa recomputeBreaks()
+ */
+std::vector<size_t> Paragraph::computeBreaks(const HListView& hlist, LinebreakCheckpoints& checkpoints)
+{
+  checkpoints.clear();
+
+  LinebreakState& state = *checkpoints.m_state;
+  state.hsize = hsize;
+  initBreaks(state, hlist, 0);
+
+  if (pretolerance >= 0)
+  {
+    startPass(state, pretolerance, false);
+
+    for (size_t i(0); i < hlist.size(); )
+      i = breakLines(state, hlist, i, &checkpoints.m_checkpoints);
+
+    if (!state.active.empty())
+    {
+      ++statistics.firstpass;
+      return checkpoints.finish(*this, hlist);
+    }
+
+    checkpoints.m_checkpoints.clear();
+  }
+
+  startPass(state, tolerance, true);
+
+  for (size_t i(0); i < hlist.size(); )
+    i = breakLines(state, hlist, i, &checkpoints.m_checkpoints);
+
+  ++statistics.secondpass;
+  return checkpoints.finish(*this, hlist);
+}
+
+std::vector<std::vector<size_t>> Paragraph::computeBreaks(const List& hlist, const std::vector<float>& hsizes)
+{
+  return computeBreaks(HListView{ hlist }, hsizes);
+}
+
+/*!
+ * \fn std::vector<std::vector<size_t>> computeBreaks(const HListView& hlist, const std::vector<float>& hsizes)
+ * \brief Computes the breakpoints of the paragraph for several values of hsize
+ *
+ * The result is the same as calling computeBreaks() once for each value
+ * of \a hsizes, but the list is only scanned once per pass: the totals are
+ * shared and only the active breakpoints are specific to each hsize.
+ *
+ * The concave mode and \c checkpruning work on a whole pass; if either
+ * is enabled, the passes are run separately for each hsize with runPass()
+ * (the totals are still shared).
+ *
+ * Note that hsize has no effect if the paragraph has a parshape.
+ */
+std::vector<std::vector<size_t>> Paragraph::computeBreaks(const HListView& hlist, const std::vector<float>& hsizes)
+{
+  LinebreakState state;
+  initBreaks(state, hlist, 0);
+
+  if (concave || checkpruning)
+  {
+    std::vector<std::vector<size_t>> result;
+    result.reserve(hsizes.size());
+
+    for (float w : hsizes)
+    {
+      state.hsize = w;
+      result.push_back(runPasses(state, hlist));
+    }
+
+    return result;
+  }
+
+  std::vector<BreakGraph> graphs{ hsizes.size() };
+  std::vector<BreakGraph*> pending;
+
+  for (size_t k(0); k < hsizes.size(); ++k)
+  {
+    graphs[k].hsize = hsizes[k];
+    startPass(graphs[k], pretolerance >= 0 ? pretolerance : tolerance, pretolerance < 0);
+    pending.push_back(&graphs[k]);
+  }
+
+  auto scan = [&]() {
+    for (size_t i(0); i < hlist.size(); ++i)
+    {
+      if (!isBreakOpportunity(hlist, i))
+        continue;
+
+      for (BreakGraph* g : pending)
+      {
+        if (!g->active.empty())
+          tryBreak(state, *g, hlist, i);
+      }
+    }
+  };
+
+  scan();
+
+  if (pretolerance >= 0)
+  {
+    auto it = pending.begin();
+
+    for (BreakGraph* g : pending)
+    {
+      if (!g->active.empty())
+      {
+        ++statistics.firstpass;
+        continue;
+      }
+
+      startPass(*g, tolerance, true);
+      *(it++) = g;
+    }
+
+    pending.erase(it, pending.end());
+    scan();
+  }
+
+  statistics.secondpass += pending.size();
+
+  std::vector<std::vector<size_t>> result;
+  result.reserve(graphs.size());
+
+  for (const BreakGraph& g : graphs)
+    result.push_back(bestBreaks(g));
+
+  return result;
+}
+
+/*!
+ * \fn std::vector<size_t> recomputeBreaks(const HListView& hlist, size_t position, size_t removed, size_t inserted, LinebreakCheckpoints& checkpoints)
+ * \brief Computes the breakpoints of an edited paragraph
+ *
+ * \a checkpoints must have been filled by a previous call to computeBreaks()
+ * or recomputeBreaks() with the same settings, for the list before the edit.
+ * The edit replaced the \a removed nodes at index \a position by \a inserted nodes.
+ *
+ * Breaking resumes from the beginning of the last line that starts before
+ * \a position, and stops as soon as the state of the linebreaker after the
+ * edit matches the one of the previous run at the beginning of a line, in
+ * which case the remaining breakpoints are those of the previous run.
+ */
+std::vector<size_t> Paragraph::recomputeBreaks(const HListView& hlist, size_t position, size_t removed, size_t inserted, LinebreakCheckpoints& checkpoints)
+{
+  if (checkpoints.m_checkpoints.empty() && checkpoints.m_state->nodes.empty())
+    return computeBreaks(hlist, checkpoints);
+
+  LinebreakState& state = *checkpoints.m_state;
+  const bool firstpass = pretolerance >= 0 && !state.discretionaries;
+
+  if (!firstpass && pretolerance >= 0)
+  {
+    // The edit may have made the first pass successful
+    LinebreakState first;
+    first.hsize = hsize;
+    initBreaks(first, hlist, 0);
+    startPass(first, pretolerance, false);
+    breakLines(first, hlist, 0, nullptr);
+
+    if (!first.active.empty())
+      return computeBreaks(hlist, checkpoints);
+  }
+
+  resumeBreaks(hlist, position, removed, inserted, checkpoints);
+
+  if (state.active.empty() && firstpass)
+    return computeBreaks(hlist, checkpoints);
+
+  if (firstpass)
+    ++statistics.firstpass;
+  else
+    ++statistics.secondpass;
+
+  return checkpoints.finish(*this, hlist);
+}
+
+/*!
+ * \fn void resumeBreaks(const HListView& hlist, size_t position, size_t removed, size_t inserted, LinebreakCheckpoints& checkpoints)
+ * \brief Runs again the pass that produced the checkpoints, from the last checkpoint before the edit
+ */
+void Paragraph::resumeBreaks(const HListView& hlist, size_t position, size_t removed, size_t inserted, LinebreakCheckpoints& checkpoints)
+{
+  using Checkpoint = LinebreakCheckpoints::Checkpoint;
+
+  LinebreakState& state = *checkpoints.m_state;
+
+  // Keeps the previous run for resynchronization
+  std::vector<BreakNode> previous_nodes = state.nodes;
+  std::vector<size_t> previous_active = state.active;
+  std::vector<Checkpoint> previous_checkpoints = checkpoints.m_checkpoints;
+
+  // Restores the last checkpoint before the edit
+  auto it = std::lower_bound(checkpoints.m_checkpoints.begin(), checkpoints.m_checkpoints.end(), position, [](const Checkpoint& c, size_t pos) {
+    return c.position < pos;
+  });
+
+  checkpoints.m_checkpoints.erase(it, checkpoints.m_checkpoints.end());
+
+  size_t i = 0;
+
+  if (checkpoints.m_checkpoints.empty())
+  {
+    startPass(state, state.threshold, state.discretionaries);
+  }
+  else
+  {
+    const Checkpoint& c = checkpoints.m_checkpoints.back();
+    i = c.position;
+    state.nodes.resize(c.nodes);
+    state.active = c.active;
+  }
+
+  initBreaks(state, hlist, i);
+
+  checkpoints.m_resumed_at = i;
+  checkpoints.m_resynchronized_at = hlist.size();
+
+  const size_t old_end = position + removed;
+  const size_t new_end = position + inserted;
+
+  auto map_position = [&](size_t pos, size_t& result) -> bool {
+    if (pos < position)
+      result = pos;
+    else if (pos >= old_end)
+      result = pos - old_end + new_end;
+    else
+      return false;
+
+    return true;
+  };
+
+  while (i < hlist.size())
+  {
+    i = breakLines(state, hlist, i, &checkpoints.m_checkpoints);
+
+    if (i == hlist.size() || i < new_end)
+      continue;
+
+    // Looks for the checkpoint of the previous run at the same place
+    const size_t old_pos = i - new_end + old_end;
+
+    auto oc = std::lower_bound(previous_checkpoints.begin(), previous_checkpoints.end(), old_pos, [](const Checkpoint& c, size_t pos) {
+      return c.position < pos;
+    });
+
+    if (oc == previous_checkpoints.end() || oc->position != old_pos || oc->active.size() != state.active.size())
+      continue;
+
+    bool synchronized = true;
+    Demerits offset = 0;
+
+    for (size_t k(0); k < state.active.size() && synchronized; ++k)
+    {
+      const BreakNode& a = state.nodes[state.active[k]];
+      const BreakNode& b = previous_nodes[oc->active[k]];
+
+      size_t pos = 0, totals = 0;
+      synchronized = map_position(b.position, pos) && map_position(b.totals, totals)
+        && a.position == pos && a.totals == totals && a.line == b.line && a.fitness == b.fitness;
+
+      if (k == 0)
+        offset = a.demerits - b.demerits;
+      else
+        synchronized = synchronized && a.demerits - b.demerits == offset;
+    }
+
+    if (!synchronized)
+      continue;
+
+    // The rest of the previous run applies: copies its breakpoints and checkpoints
+    const size_t base = state.nodes.size();
+
+    auto map_node = [&](size_t n) -> size_t {
+      if (n >= oc->nodes)
+        return n - oc->nodes + base;
+
+      auto k = std::find(oc->active.begin(), oc->active.end(), n) - oc->active.begin();
+      assert(k < static_cast<std::ptrdiff_t>(oc->active.size()));
+      return state.active[k];
+    };
+
+    for (size_t n(oc->nodes); n < previous_nodes.size(); ++n)
+    {
+      BreakNode bp = previous_nodes[n];
+      map_position(bp.position, bp.position);
+      map_position(bp.totals, bp.totals);
+      bp.demerits += offset;
+      bp.previous = map_node(bp.previous);
+      state.nodes.push_back(bp);
+    }
+
+    for (size_t& n : previous_active)
+      n = map_node(n);
+
+    for (auto c = std::next(oc); c != previous_checkpoints.end(); ++c)
+    {
+      Checkpoint cp{ 0, c->nodes - oc->nodes + base, c->active };
+      map_position(c->position, cp.position);
+
+      for (size_t& n : cp.active)
+        n = map_node(n);
+
+      checkpoints.m_checkpoints.push_back(std::move(cp));
+    }
+
+    state.active = std::move(previous_active);
+    checkpoints.m_resynchronized_at = i;
+    break;
+  }
+}
+
+void Paragraph::initBreaks(LinebreakState& state, const HListView& hlist, size_t from)
+{
+  state.totals.resize(hlist.size() + 1);
+
+  if (from == 0)
+    state.totals[0] = Totals{};
+
+  for (size_t i(from); i < hlist.size(); ++i)
+  {
+    state.totals[i + 1] = state.totals[i];
+
+    if (hlist.isBox(i) || hlist.isGlue(i) || hlist.isKern(i) || hlist.isDiscretionary(i))
+      accumulate(state.totals[i + 1], hlist, i);
+  }
+
+  // For a break at i, the totals of the breakpoint are those that
+  // follow the discardable nodes after i, i.e. at the next box, discretionary
+  // or forced break.
+  // After a discretionary with a post-break list, the next line starts
+  // right after the discretionary.
+  state.after.resize(hlist.size());
+
+  for (size_t i(hlist.size()), next(hlist.size()); i-- > 0; )
+  {
+    if (hlist.isBox(i))
+      state.after[i] = i;
+    else if (hlist.isDiscretionary(i) && !hlist.node(i).as<Discretionary>().postbreak().empty())
+      state.after[i] = i + 1;
+    else
+      state.after[i] = next;
+
+    if (hlist.isBox(i) || hlist.isDiscretionary(i) || isForcedLinebreak(hlist, i))
+      next = i;
+  }
+
+  state.skips = skipTotals();
+}
+
+/*!
+ * \fn void startPass(BreakGraph& graph, float threshold, bool discretionaries)
+ * \brief Resets the breakpoints of \a graph before a pass over the paragraph
+ *
+ * During the pass, a line is feasible if its glue ratio does not exceed \a threshold,
+ * and the paragraph is only broken at discretionaries if \a discretionaries is true.
+ */
+void Paragraph::startPass(BreakGraph& graph, float threshold, bool discretionaries)
+{
+  graph.threshold = threshold;
+  graph.discretionaries = discretionaries;
+  graph.nodes.assign(1, BreakNode{ 0, 0, 0, 0, 0, FitnessClass::Tight, 0 });
+  graph.active.assign(1, 0);
+}
+
+/*!
+ * \fn size_t breakLines(LinebreakState& state, const HListView& hlist, size_t i, std::vector<LinebreakCheckpoint>* checkpoints)
+ * \brief Runs the linebreaker from the i-th node
+ *
+ * If \a checkpoints is not null, the function saves a checkpoint and returns
+ * when it reaches a box that follows new breakpoints; the returned value is
+ * then the index of that box, from which breaking can be resumed.
+ * Otherwise, all remaining nodes are processed.
+ */
+size_t Paragraph::breakLines(LinebreakState& state, const HListView& hlist, size_t i, std::vector<LinebreakCheckpoint>* checkpoints)
+{
+  const size_t saved = (checkpoints && !checkpoints->empty()) ? checkpoints->back().nodes : 1;
+
+  for (; i < hlist.size(); ++i)
+  {
+    if (hlist.isBox(i))
+    {
+      if (checkpoints && state.nodes.size() > saved)
+      {
+        checkpoints->push_back(LinebreakCheckpoint{ i, state.nodes.size(), state.active });
+        return i;
+      }
+    }
+    else if (isBreakOpportunity(hlist, i))
+    {
+      tryBreak(state, hlist, i);
+
+      // The pass failed
+      if (state.active.empty())
+        return hlist.size();
+    }
+  }
+
+  return i;
+}
+
+/*!
+ * \fn bool isBreakOpportunity(const HListView& hlist, size_t i)
+ * \brief Returns whether the paragraph may be broken at the i-th node
+ *
+ * This is the case of glue that follows a box, of penalties that
+ * do not forbid breaking, and of discretionaries.
+ */
+bool Paragraph::isBreakOpportunity(const HListView& hlist, size_t i)
+{
+  if (hlist.isGlue(i))
+    return i > 0 && hlist.isBox(i - 1);
+  else if (hlist.isPenalty(i))
+    return !isForbiddenLinebreak(hlist, i);
+
+  return hlist.isDiscretionary(i);
+}
+
+std::vector<size_t> Paragraph::bestBreaks(const BreakGraph& state)
+{
+  if (state.active.empty())
+    throw std::runtime_error{ "Failed" };
+
+  size_t best = state.active.front();
+
+  for (size_t n : state.active)
+  {
+    if (state.nodes[n].demerits < state.nodes[best].demerits)
+      best = n;
+  }
+
+  std::vector<size_t> result;
+  result.reserve(state.nodes[best].line);
+
+  for (size_t n = best; n != 0; n = state.nodes[n].previous)
+    result.push_back(state.nodes[n].position);
+
+  std::reverse(result.begin(), result.end());
+
+  return result;
+}
+
+/*!
+ * \fn bool concaveBreaks(const LinebreakState& state, const HListView& hlist, std::vector<size_t>& breaks)
+ * \brief Computes the breakpoints of a paragraph with uniform lines
+ *
+ * The demerits of a line then only depend on its two ends, and finding the
+ * best breakpoints is a least-weight subsequence problem: the best way to
+ * reach breakpoint j is the best way to reach some earlier breakpoint i, plus
+ * the demerits of the line [i, j).
+ * These demerits are assumed to satisfy the quadrangle inequality
+ * (a long line gets worse faster than a short one), which is the case with
+ * ordinary glue: if breakpoint i is better than breakpoint i' < i for some j,
+ * it stays better for all the breakpoints that follow.
+ *
+ * Each candidate breakpoint is thus the best predecessor for a contiguous
+ * range of the breakpoints that follow; these ranges are kept in a queue and
+ * the first breakpoint of a range is found by binary search (this is the
+ * basic algorithm of Hirschberg and Larmore), which takes O(n log n) time
+ * instead of the O(n a) time of the active list.
+ *
+ * Candidates for which all lines are still too loose are kept aside until
+ * a feasible line starts from them, and the queue is emptied at forced breaks.
+ * Returns false if there is no feasible way to break the paragraph in the
+ * current pass.
+ */
+bool Paragraph::concaveBreaks(const LinebreakState& state, const HListView& hlist, std::vector<size_t>& breaks)
+{
+  struct Candidate
+  {
+    size_t position;
+    size_t totals;
+    Dimension prebreak;
+    Dimension postbreak;
+    int penalty;
+    bool forced;
+    Demerits demerits;
+    size_t previous;
+  };
+
+  struct Range
+  {
+    size_t candidate;
+    size_t begin;
+  };
+
+  enum class Fit
+  {
+    Feasible,
+    TooLoose,
+    TooTight,
+  };
+
+  constexpr Demerits Infinite = std::numeric_limits<Demerits>::max();
+
+  std::vector<Candidate> candidates;
+  candidates.push_back(Candidate{ 0, 0, 0, 0, 0, false, 0, 0 });
+
+  for (size_t i(0); i < hlist.size(); ++i)
+  {
+    if (!isBreakOpportunity(hlist, i) || (hlist.isDiscretionary(i) && !state.discretionaries))
+      continue;
+
+    candidates.push_back(Candidate{ i, state.after[i], prebreakWidth(hlist, i), postbreakWidth(hlist, i),
+      breakPenalty(hlist, i), isForcedLinebreak(hlist, i), Infinite, 0 });
+  }
+
+  const Dimension line_length = to_dimension(linelength(0, state.hsize));
+  const size_t last = candidates.size() - 1;
+
+  auto fit = [&](size_t i, size_t j, Demerits& d) -> Fit {
+    const Candidate& from = candidates[i];
+    const Candidate& to = candidates[j];
+    const Totals& sum = state.totals[to.position];
+    const Dimension length = line_length - to.prebreak - from.postbreak;
+
+    Badness badness;
+    float ratio = computeGlueRatio(sum, state.totals[from.totals], state.skips, length, badness);
+
+    if (-1 <= ratio && ratio <= state.threshold)
+    {
+      d = computeDemerits(linepenalty, badness, to.penalty);
+      return Fit::Feasible;
+    }
+
+    const Dimension width = sum.width - state.totals[from.totals].width - state.skips.width;
+    return width > length ? Fit::TooTight : Fit::TooLoose;
+  };
+
+  // Whether candidate c is a better predecessor than candidate b < c for breakpoint j
+  auto better = [&](size_t c, size_t b, size_t j) -> bool {
+    Demerits db, dc;
+
+    if (fit(b, j, db) != Fit::Feasible)
+      return true;
+    else if (fit(c, j, dc) != Fit::Feasible)
+      return false;
+
+    return candidates[c].demerits + dc < candidates[b].demerits + db;
+  };
+
+  std::deque<Range> queue;
+  std::deque<size_t> pending{ 0 };
+
+  auto insert = [&](size_t c, size_t j) {
+    while (!queue.empty() && better(c, queue.back().candidate, std::max(queue.back().begin, j)))
+      queue.pop_back();
+
+    if (queue.empty())
+    {
+      queue.push_back(Range{ c, j });
+      return;
+    }
+
+    size_t lo = std::max(queue.back().begin, j) + 1;
+    size_t hi = last + 1;
+
+    while (lo < hi)
+    {
+      const size_t mid = lo + (hi - lo) / 2;
+
+      if (better(c, queue.back().candidate, mid))
+        hi = mid;
+      else
+        lo = mid + 1;
+    }
 
-  activeNodes.push_back(std::make_shared<Breakpoint>(hlist.begin(), 0, 0, FitnessClass::Tight, Totals{}, nullptr));
+    if (lo <= last)
+      queue.push_back(Range{ c, lo });
+  };
 
-  for (auto it = hlist.begin(); it != hlist.end(); ++it)
+  for (size_t j(1); j <= last; ++j)
   {
-    std::shared_ptr<Node> node = *it;
+    Demerits d;
 
-    if (node->isBox())
+    while (!pending.empty() && fit(pending.front(), j, d) != Fit::TooLoose)
     {
-      sum.width += node->as<Box>().width();
+      insert(pending.front(), j);
+      pending.pop_front();
     }
-    else if (node->isGlue())
-    {
-      if (prevnode != hlist.end() && (*prevnode)->isBox())
-        tryBreak(activeNodes, hlist, it, sum);
 
-      Glue& g = node->as<Glue>();
-      sum.width += g.space();
-      g.accumulate(sum.shrink, sum.stretch);
-    }
-    else if (node->isKern())
+    while (queue.size() > 1 && queue[1].begin <= j)
+      queue.pop_front();
+
+    Candidate& current = candidates[j];
+
+    if (!queue.empty() && fit(queue.front().candidate, j, d) == Fit::Feasible)
     {
-      sum.width += node->as<Kern>().space();
+      current.demerits = candidates[queue.front().candidate].demerits + d;
+      current.previous = queue.front().candidate;
     }
-    else if (node->isPenalty() && !isForbiddenLinebreak(*node))
+
+    if (current.forced)
     {
-      tryBreak(activeNodes, hlist, it, sum);
+      queue.clear();
+      pending.clear();
     }
 
-    prevnode = it;
+    if (current.demerits != Infinite)
+      pending.push_back(j);
   }
 
-  return activeNodes;
+  if (last == 0 || candidates[last].demerits == Infinite)
+    return false;
+
+  breaks.clear();
+
+  for (size_t j = last; j != 0; j = candidates[j].previous)
+    breaks.push_back(candidates[j].position);
+
+  std::reverse(breaks.begin(), breaks.end());
+
+  return true;
 }
 
-std::vector<Paragraph::Breakpoint> Paragraph::computeBreakpoints(const std::list<std::shared_ptr<Breakpoint>>& candidates)
+LinebreakCheckpoints::LinebreakCheckpoints()
+  : m_state(new Paragraph::LinebreakState)
 {
-  auto best_breakpoint = *candidates.begin();
 
-  for (auto it = candidates.begin(); it != candidates.end(); ++it)
-  {
-    if ((*it)->demerits < best_breakpoint->demerits)
-      best_breakpoint = *it;
-  }
+}
+
+LinebreakCheckpoints::~LinebreakCheckpoints()
+{
 
-  return computeBreakpoints(best_breakpoint);
 }
 
-std::vector<Paragraph::Breakpoint> Paragraph::computeBreakpoints(std::shared_ptr<Breakpoint> breakpoints)
+void LinebreakCheckpoints::clear()
 {
-  std::vector<Breakpoint> result;
+  *m_state = Paragraph::LinebreakState{};
+  m_checkpoints.clear();
+  m_breaks.clear();
+  m_resumed_at = 0;
+  m_resynchronized_at = 0;
+}
 
-  do
+/*!
+ * \fn std::vector<size_t> finish(const Paragraph& paragraph, const HListView& hlist)
+ * \brief Computes the breakpoints once the linebreaker has processed the whole list
+ *
+ * Only the checkpoints saved at the beginning of the lines are kept.
+ */
+std::vector<size_t> LinebreakCheckpoints::finish(const Paragraph& paragraph, const HListView& hlist)
+{
+  std::vector<size_t> breaks = paragraph.bestBreaks(*m_state);
+
+  std::vector<size_t> starts;
+  starts.reserve(breaks.size());
+
+  for (size_t b : breaks)
   {
-    result.push_back(*breakpoints);
-    breakpoints = breakpoints->previous;
-  } while (breakpoints != nullptr);
+    const size_t s = m_state->after[b];
 
-  std::reverse(result.begin(), result.end());
+    if (s < hlist.size() && hlist.isBox(s))
+      starts.push_back(s);
+  }
 
-  return result;
-}
+  auto it = std::remove_if(m_checkpoints.begin(), m_checkpoints.end(), [&starts](const Checkpoint& c) {
+    return !std::binary_search(starts.begin(), starts.end(), c.position);
+  });
 
-std::vector<Paragraph::Breakpoint> Paragraph::computeBreakpoints(const List & hlist)
-{
-  std::list<std::shared_ptr<Breakpoint>> activeNodes = computeFeasibleBreakpoints(hlist);
+  m_checkpoints.erase(it, m_checkpoints.end());
 
-  if (activeNodes.size() == 0) 
-    throw std::runtime_error{ "Failed" };
-  
-  return computeBreakpoints(activeNodes);
+  m_breaks = breaks;
+  return breaks;
 }
 
 void Paragraph::prepare(List & hlist)
@@ -169,7 +1071,7 @@ void Paragraph::prepare(List & hlist)
 
   hlist.push_back(infinitePenalty());
   hlist.push_back(parfillskip);
-  hlist.push_back(penalty(-Penalty::Infinity));
+  hlist.push_back(make_node<Penalty>(arena.get(), -Penalty::Infinity));
 }
 
 List Paragraph::create(const List & hlist)
@@ -177,9 +1079,10 @@ List Paragraph::create(const List & hlist)
   if (hlist.empty())
     return hlist;
 
-  std::vector<Breakpoint> breakpoints = computeBreakpoints(hlist);
+  HListView view{ hlist };
+  std::vector<size_t> breaks = computeBreaks(view);
 
-  return create(hlist, breakpoints);
+  return create(view, breaks);
 }
 
 List Paragraph::create(const List& hlist, const std::vector<Breakpoint>& breakpoints)
@@ -187,24 +1090,85 @@ List Paragraph::create(const List& hlist, const std::vector<Breakpoint>& breakpo
   if (hlist.empty())
     return hlist;
 
-  List::const_iterator it = hlist.begin();
-  List::const_iterator next = std::next(it);
+  return create(HListView{ hlist }, breakpoints);
+}
+
+/*!
+ * \fn List create(List&& hlist)
+ * \brief Breaks a prepared horizontal list into lines, consuming the list
+ *
+ * The nodes are moved into the lines instead of being copied, and the
+ * positions of the list are released as the lines are built.
+ */
+List Paragraph::create(List&& hlist)
+{
+  if (hlist.empty())
+    return {};
+
+  HListView view{ hlist };
+  std::vector<size_t> breaks = computeBreaks(view);
+
+  List result = create(view, breaks, &hlist);
+  hlist.clear();
+  return result;
+}
+
+List Paragraph::create(const HListView& hlist, const std::vector<Breakpoint>& breakpoints)
+{
+  std::vector<size_t> breaks;
+  size_t end = 0;
+
+  for (auto bp = std::next(breakpoints.begin()); bp != breakpoints.end(); ++bp)
+  {
+    while (hlist.position(end) != bp->position)
+      ++end;
+
+    breaks.push_back(end);
+  }
+
+  return create(hlist, breaks);
+}
 
-  auto bp = std::next(breakpoints.begin());
+/*!
+ * \fn List create(const HListView& hlist, const std::vector<size_t>& breaks)
+ * \brief Creates the lines of a paragraph given the indices of its breakpoints
+ */
+List Paragraph::create(const HListView& hlist, const std::vector<size_t>& breaks)
+{
+  return create(hlist, breaks, nullptr);
+}
 
+List Paragraph::create(const HListView& hlist, const std::vector<size_t>& breaks, List* source)
+{
   List result;
 
-  while (bp != breakpoints.end())
+  size_t begin = 0;
+  NodeRef<Discretionary> previous;
+
+  for (size_t i(0); i < breaks.size(); ++i)
   {
-    auto line = createLine(bp->line - 1, it, bp->position);
+    const size_t end = breaks[i];
+
+    NodeRef<Discretionary> disc;
+
+    if (end < hlist.size() && hlist.isDiscretionary(end))
+      disc = static_pointer_cast<Discretionary>(*hlist.position(end));
+
+    auto line = createLine(i, hlist, begin, end, source, previous ? &previous->postbreak() : nullptr, disc ? &disc->prebreak() : nullptr);
 
-    VListBuilder::push_back(result, line, prevdepth, baselineskip, lineskip, lineskiplimit);
+    VListBuilder::push_back(result, line, prevdepth, baselineskip, lineskip, lineskiplimit, arena.get());
 
-    it = bp->position;
-    ++bp;
+    begin = disc ? end + 1 : end;
 
-    if (bp != breakpoints.end())
-      consumeDiscardable(it);
+    // The next break may lie in the discardable nodes that follow this one,
+    // unless the next line starts with a post-break list
+    if (i + 1 < breaks.size() && !(disc && !disc->postbreak().empty()))
+      begin = std::min(consumeDiscardable(hlist, begin), breaks[i + 1]);
+
+    previous = std::move(disc);
+
+    if (source)
+      source->erase(hlist.position(end), hlist.position(begin));
   }
 
   return result;
@@ -249,86 +1213,162 @@ bool Paragraph::checkCompatibility(FitnessClass a, FitnessClass b)
 Paragraph::Demerits Paragraph::computeDemerits(int l, Badness b, int p)
 {
   if (0 <= p && p < 10'000)
-    return Demerits(std::pow(l + b, 2) + std::pow(p, 2));
+    return (l + b) * (l + b) + p * p;
   else if (-10'000 < p && p < 0)
-    return Demerits(std::pow(l + b, 2) - std::pow(p, 2));
+    return (l + b) * (l + b) - p * p;
   else
-    return Demerits(std::pow(l + b, 2));
+    return (l + b) * (l + b);
+}
+
+/*!
+ * \fn void accumulate(Totals& sum, const HListView& hlist, size_t i)
+ * \brief Adds the width, and the stretch and shrink if any, of the i-th node to \a sum
+ */
+void Paragraph::accumulate(Totals& sum, const HListView& hlist, size_t i)
+{
+  sum.width += to_dimension(hlist.width(i));
+
+  if (hlist.isGlue(i))
+  {
+    for (size_t k(0); k < 4; ++k)
+    {
+      sum.shrink[k] += to_dimension(hlist.shrink(i, static_cast<GlueOrder>(k)));
+      sum.stretch[k] += to_dimension(hlist.stretch(i, static_cast<GlueOrder>(k)));
+    }
+  }
+}
+
+void Paragraph::accumulate(Totals& sum, const Glue& glue)
+{
+  sum.width += to_dimension(glue.space());
+  sum.shrink[static_cast<size_t>(glue.shrinkOrder())] += to_dimension(glue.shrink());
+  sum.stretch[static_cast<size_t>(glue.stretchOrder())] += to_dimension(glue.stretch());
+}
+
+/*!
+ * \fn Totals skipTotals() const
+ * \brief Returns the totals of the leftskip and rightskip, that are added to each line
+ */
+Paragraph::Totals Paragraph::skipTotals() const
+{
+  Totals skips;
+  accumulate(skips, *leftskip);
+  accumulate(skips, *rightskip);
+  return skips;
 }
 
-ShrinkTotals Paragraph::shrinkTotals(const Glue& lskip, const Glue& rskip)
+static GlueOrder glue_order(const Dimension(&totals)[4])
 {
-  ShrinkTotals totals;
-  StretchTotals dummy;
-  lskip.accumulate(totals, dummy);
-  rskip.accumulate(totals, dummy);
-  return totals;
+  if (totals[3] != 0)
+    return GlueOrder::Filll;
+  else if (totals[2] != 0)
+    return GlueOrder::Fill;
+  else if (totals[1] != 0)
+    return GlueOrder::Fil;
+  return GlueOrder::Normal;
 }
 
- StretchTotals Paragraph::stretchTotals(const Glue& lskip, const Glue& rskip)
- {
-   ShrinkTotals dummy;
-   StretchTotals totals;
-   lskip.accumulate(dummy, totals);
-   rskip.accumulate(dummy, totals);
-   return totals;
- }
+/*!
+ * \fn float computeGlueRatio(const Totals & sum, const Totals& from, const Totals& skips, size_t current_line, Badness& badness)
+ * \brief Computes the glue ratio and the badness of a line
+ *
+ * \a from and \a sum are the totals at the beginning and at the end of the line,
+ * and \a skips are the totals of the leftskip and rightskip (see skipTotals()).
+ *
+ * When the library is built with \c LIBTYPESET_SCALED_POINTS, the badness
+ * is computed with integer arithmetic only.
+ */
+float Paragraph::computeGlueRatio(const Totals & sum, const Totals& from, const Totals& skips, size_t current_line, Badness& badness)
+{
+  return computeGlueRatio(sum, from, skips, to_dimension(linelength(current_line)), badness);
+}
 
-float Paragraph::computeGlueRatio(const Totals & sum, Breakpoint & active, size_t current_line)
+float Paragraph::computeGlueRatio(const Totals& sum, const Totals& from, const Totals& skips, Dimension line_length, Badness& badness)
 {
-  float width = sum.width - active.totals.width;
+  Dimension width = sum.width - from.width;
 
-  width -= leftskip->space();
-  width -= rightskip->space();
+  width -= skips.width;
 
-  float line_length = linelength(current_line);
+  badness = 0;
 
   if (width < line_length)
   {
-    auto diff = sum.stretch + stretchTotals(*leftskip, *rightskip) - active.totals.stretch;
-    if (diff.order() != GlueOrder::Normal)
+    Dimension diff[4];
+    for (size_t k(0); k < 4; ++k)
+      diff[k] = sum.stretch[k] + skips.stretch[k] - from.stretch[k];
+
+    if (glue_order(diff) != GlueOrder::Normal)
       return 0.f;
 
-    const float stretch = diff.normal;
-    if (stretch > 0.f)
-      return (line_length - width) / stretch;
+    const Dimension stretch = diff[0];
+    if (stretch > 0)
+    {
+      const float ratio = static_cast<float>(line_length - width) / static_cast<float>(stretch);
+#if defined(LIBTYPESET_SCALED_POINTS)
+      badness = tex::badness(line_length - width, stretch);
+#else
+      badness = computeBadness(ratio);
+#endif // defined(LIBTYPESET_SCALED_POINTS)
+      return ratio;
+    }
     else
+    {
+      badness = InfBad;
       return (float) Penalty::Infinity;
+    }
   }
   else if (width > line_length)
   {
-    auto diff = sum.shrink + shrinkTotals(*leftskip, *rightskip) - active.totals.shrink;
-    if (diff.order() != GlueOrder::Normal)
-      return 0;
+    Dimension diff[4];
+    for (size_t k(0); k < 4; ++k)
+      diff[k] = sum.shrink[k] + skips.shrink[k] - from.shrink[k];
+
+    if (glue_order(diff) != GlueOrder::Normal)
+      return 0.f;
 
-    const float shrink = diff.normal;
-    if (shrink > 0.f)
-      return (line_length - width) / shrink;
+    const Dimension shrink = diff[0];
+    if (shrink > 0)
+    {
+      const float ratio = static_cast<float>(line_length - width) / static_cast<float>(shrink);
+#if defined(LIBTYPESET_SCALED_POINTS)
+      badness = tex::badness(width - line_length, shrink);
+#else
+      badness = computeBadness(ratio);
+#endif // defined(LIBTYPESET_SCALED_POINTS)
+      return ratio;
+    }
     else
+    {
+      badness = InfBad;
       return (float) Penalty::Infinity;
+    }
   }
   
   return 0.f;
 }
 
-Paragraph::Totals Paragraph::squeezeDiscardables(Totals sum, List::const_iterator breakpointpos, List::const_iterator end)
+Paragraph::Totals Paragraph::squeezeDiscardables(Totals sum, const HListView& hlist, size_t breakpointpos)
 {
-  /// Computes totals from breakpoint up to next box or forced linebreak
-  for (auto it = breakpointpos; it != end; ++it)
+  size_t i = breakpointpos;
+
+  if (hlist.isDiscretionary(i))
   {
-    std::shared_ptr<Node> node = *it;
+    accumulate(sum, hlist, i);
 
-    if (node->is<Glue>())
-    {
-      Glue & g = node->as<Glue>();
-      sum.width += g.space();
-      g.accumulate(sum.shrink, sum.stretch);
-    }
-    else if (node->isKern())
+    if (!hlist.node(i).as<Discretionary>().postbreak().empty())
+      return sum;
+
+    ++i;
+  }
+
+  /// Computes totals from breakpoint up to next box, discretionary or forced linebreak
+  for (; i < hlist.size(); ++i)
+  {
+    if (hlist.isGlue(i) || hlist.isKern(i))
     {
-      sum.width += node->as<Kern>().space();
+      accumulate(sum, hlist, i);
     }
-    else if (node->isBox() || (it != breakpointpos && isForcedLinebreak(*node)))
+    else if (hlist.isBox(i) || hlist.isDiscretionary(i) || (i != breakpointpos && isForcedLinebreak(hlist, i)))
     {
       break;
     }
@@ -337,6 +1377,33 @@ Paragraph::Totals Paragraph::squeezeDiscardables(Totals sum, List::const_iterato
   return sum;
 }
 
+/*!
+ * \fn int breakPenalty(const HListView& hlist, size_t pos) const
+ * \brief Returns the penalty for breaking the paragraph at \a pos
+ *
+ * This is hyphenpenalty for a discretionary with a pre-break list,
+ * exhyphenpenalty for an empty one.
+ */
+int Paragraph::breakPenalty(const HListView& hlist, size_t pos) const
+{
+  if (hlist.isPenalty(pos))
+    return hlist.penalty(pos);
+  else if (hlist.isDiscretionary(pos))
+    return hlist.node(pos).as<Discretionary>().prebreak().empty() ? exhyphenpenalty : hyphenpenalty;
+
+  return 0;
+}
+
+Dimension Paragraph::prebreakWidth(const HListView& hlist, size_t pos)
+{
+  return hlist.isDiscretionary(pos) ? to_dimension(hlist.node(pos).as<Discretionary>().prebreakWidth()) : 0;
+}
+
+Dimension Paragraph::postbreakWidth(const HListView& hlist, size_t pos)
+{
+  return hlist.isDiscretionary(pos) ? to_dimension(hlist.node(pos).as<Discretionary>().postbreakWidth()) : 0;
+}
+
 struct Candidate
 {
   std::shared_ptr<Paragraph::Breakpoint> active;
@@ -344,16 +1411,17 @@ struct Candidate
 };
 
 /*!
- * \fn void tryBreak(std::list<std::shared_ptr<Breakpoint>> & activeBreakpoints, const List &hlist, List::const_iterator it, const Totals & sum)
+ * \fn void tryBreak(std::list<std::shared_ptr<Breakpoint>> & activeBreakpoints, const HListView& hlist, size_t pos, Totals sum, const Totals& skips)
  * \param list of active breakpoints
- * \param list of all nodes
- * \param place to attempt a breakpoint
- * \param cumulated space and glue from the beginning of the list up to 'it'
+ * \param view of all nodes
+ * \param index of the place to attempt a breakpoint
+ * \param cumulated space and glue from the beginning of the list up to 'pos'
+ * \param totals of the leftskip and rightskip
  * \brief Compute new possible breakpoints
  *
- * This procedure attempts to create new possible breakpoints at the given position \a it.
+ * This procedure attempts to create new possible breakpoints at the given position \a pos.
  * For each breakpoint \c b in the list of active breakpoints, the procedure checks if the line 
- * formed of the nodes in \c{[b, it)} has an acceptable badness. 
+ * formed of the nodes in \c{[b, pos)} has an acceptable badness. 
  * If that is the case, a new active breakpoint is created.
  *
  * This procedure also removes active breakpoints if they are too far from the current position.
@@ -363,43 +1431,48 @@ struct Candidate
  * final breakpoints of a paragraph.
  *
  */
-void Paragraph::tryBreak(std::list<std::shared_ptr<Breakpoint>> & activeBreakpoints, const List &hlist, List::const_iterator it, Totals sum)
+void Paragraph::tryBreak(std::list<std::shared_ptr<Breakpoint>> & activeBreakpoints, const HListView& hlist, size_t pos, Totals sum, const Totals& skips, float threshold)
 {
 
-  const float maxratio = tolerance;
+  const float maxratio = threshold;
 
   auto active = activeBreakpoints.begin();
-  size_t current_line = 0;
+  size_t current_class = 0;
+
+  const bool forced = isForcedLinebreak(hlist, pos);
+  const int penalty = breakPenalty(hlist, pos);
+  const Dimension prebreak = prebreakWidth(hlist, pos);
 
-  const std::shared_ptr<Node> node = *it;
+  Totals local_sum;
+  bool local_sum_computed = false;
 
   while (active != activeBreakpoints.end())
   {
     Candidate candidates[4] = {
-      Candidate{ nullptr, std::numeric_limits<int>::max() },
-      Candidate{ nullptr, std::numeric_limits<int>::max() },
-      Candidate{ nullptr, std::numeric_limits<int>::max() },
-      Candidate{ nullptr, std::numeric_limits<int>::max() },
+      Candidate{ nullptr, std::numeric_limits<Demerits>::max() },
+      Candidate{ nullptr, std::numeric_limits<Demerits>::max() },
+      Candidate{ nullptr, std::numeric_limits<Demerits>::max() },
+      Candidate{ nullptr, std::numeric_limits<Demerits>::max() },
     };
 
-    current_line = (*active)->line;
+    current_class = lineClass((*active)->line);
+    const Dimension line_length = to_dimension(linelength(current_class)) - prebreak;
 
-    while (active != activeBreakpoints.end() && (*active)->line == current_line)
+    while (active != activeBreakpoints.end() && lineClass((*active)->line) == current_class)
     {
       auto next = std::next(active);
-      float ratio = computeGlueRatio(sum, **active, current_line);
+      Badness badness;
+      float ratio = computeGlueRatio(sum, (*active)->totals, skips, line_length - (*active)->postbreak, badness);
       std::shared_ptr<Breakpoint> active_bp = *active;
 
 
       // Deactivate breakpoints if they are too far from the current node.
-      if (ratio < -1 || isForcedLinebreak(*node))
+      if (ratio < -1 || forced)
         activeBreakpoints.erase(active);
 
       if (-1 <= ratio && ratio <= maxratio)
       {
-        Badness badness = computeBadness(ratio);
-
-        Demerits d = computeDemerits(linepenalty, badness, node->isPenalty() ? node->as<Penalty>().value() : 0);
+        Demerits d = computeDemerits(linepenalty, badness, penalty);
 
         FitnessClass fc = getFitnessClass(ratio);
 
@@ -415,73 +1488,321 @@ void Paragraph::tryBreak(std::list<std::shared_ptr<Breakpoint>> & activeBreakpoi
       active = next;
     }
 
-    assert(active == activeBreakpoints.end() || (*active)->line > current_line);
-
-    // Adds the discarded nodes to the current breakpoint
-    Totals local_sum = squeezeDiscardables(sum, it, hlist.cend());
+    assert(active == activeBreakpoints.end() || lineClass((*active)->line) > current_class);
 
     for (size_t i = 0; i < 4; ++i) 
     {
       FitnessClass current_fc = static_cast<FitnessClass>(i);
       Candidate c = candidates[i];
 
-      if (c.demerits < std::numeric_limits<int>::max()) 
+      if (c.demerits < std::numeric_limits<Demerits>::max()) 
       {
-        auto bp = std::make_shared<Breakpoint>(it, c.demerits, c.active->line + 1, current_fc, local_sum, c.active);
+        // Adds the discarded nodes to the current breakpoint
+        if (!local_sum_computed)
+        {
+          local_sum = squeezeDiscardables(sum, hlist, pos);
+          local_sum_computed = true;
+        }
+
+        auto bp = std::make_shared<Breakpoint>(hlist.position(pos), c.demerits, c.active->line + 1, current_fc, local_sum, c.active);
+        bp->postbreak = postbreakWidth(hlist, pos);
         activeBreakpoints.insert(active, bp);
       }
     }
   }
 }
 
-std::shared_ptr<HBox> Paragraph::createLine(size_t linenum, List::const_iterator begin, List::const_iterator end)
+void Paragraph::tryBreak(LinebreakState& state, const HListView& hlist, size_t pos)
+{
+  tryBreak(state, state, hlist, pos);
+}
+
+/*!
+ * \fn void tryBreak(const LinebreakState& state, BreakGraph& graph, const HListView& hlist, size_t pos)
+ * \brief Updates the active breakpoints of \a graph for a break at \a pos
+ *
+ * The totals are those of \a state, and the line lengths and threshold
+ * are those of \a graph.
+ */
+void Paragraph::tryBreak(const LinebreakState& state, BreakGraph& graph, const HListView& hlist, size_t pos)
+{
+  struct IndexCandidate
+  {
+    size_t active;
+    Demerits demerits;
+  };
+
+  if (hlist.isDiscretionary(pos) && !graph.discretionaries)
+    return;
+
+  const float maxratio = graph.threshold;
+
+  const bool forced = isForcedLinebreak(hlist, pos);
+  const int penalty = breakPenalty(hlist, pos);
+
+  const Totals& sum = state.totals[pos];
+
+  graph.buffer.clear();
+
+  size_t a = 0;
+
+  while (a < graph.active.size())
+  {
+    IndexCandidate candidates[4] = {
+      IndexCandidate{ 0, std::numeric_limits<Demerits>::max() },
+      IndexCandidate{ 0, std::numeric_limits<Demerits>::max() },
+      IndexCandidate{ 0, std::numeric_limits<Demerits>::max() },
+      IndexCandidate{ 0, std::numeric_limits<Demerits>::max() },
+    };
+
+    const size_t current_class = lineClass(graph.nodes[graph.active[a]].line);
+    const Dimension line_length = to_dimension(linelength(current_class, graph.hsize)) - prebreakWidth(hlist, pos);
+
+    for (; a < graph.active.size() && lineClass(graph.nodes[graph.active[a]].line) == current_class; ++a)
+    {
+      const size_t n = graph.active[a];
+      const BreakNode& active_bp = graph.nodes[n];
+
+      Badness badness;
+      float ratio = computeGlueRatio(sum, state.totals[active_bp.totals], state.skips, line_length - active_bp.postbreak, badness);
+
+      // Deactivate breakpoints if they are too far from the current node.
+      if (!(ratio < -1 || forced))
+        graph.buffer.push_back(n);
+
+      if (-1 <= ratio && ratio <= maxratio)
+      {
+        Demerits d = computeDemerits(linepenalty, badness, penalty);
+
+        FitnessClass fc = getFitnessClass(ratio);
+
+        if (!checkCompatibility(fc, active_bp.fitness))
+          d += adjdemerits;
+
+        d += active_bp.demerits;
+
+        if (d < candidates[static_cast<int>(fc)].demerits)
+          candidates[static_cast<int>(fc)] = IndexCandidate{ n, d };
+      }
+    }
+
+    for (size_t i = 0; i < 4; ++i)
+    {
+      const IndexCandidate& c = candidates[i];
+
+      if (c.demerits < std::numeric_limits<Demerits>::max())
+      {
+        BreakNode bp{ pos, state.after[pos], c.demerits, postbreakWidth(hlist, pos), graph.nodes[c.active].line + 1, static_cast<FitnessClass>(i), c.active };
+        graph.nodes.push_back(bp);
+        graph.buffer.push_back(graph.nodes.size() - 1);
+        ++statistics.breakpoints;
+      }
+    }
+  }
+
+  std::swap(graph.active, graph.buffer);
+
+  if (graph.pruning)
+    prune(graph);
+}
+
+/*!
+ * \fn void prune(BreakGraph& graph)
+ * \brief Bounds the number of active breakpoints of \a graph
+ *
+ * The active breakpoints are grouped by line number: since every line adds
+ * to the demerits, only breakpoints that end the same number of lines are
+ * compared, even past the point where line classes merge (see lineClass()).
+ * In each group, the breakpoints whose demerits exceed those of the best
+ * one by more than \c demeritscutoff are removed, and only the \c maxactive
+ * best of the others are kept; a negative cutoff and a \c maxactive of 0
+ * mean no limit. The best breakpoint of a group is never removed and the
+ * order of the remaining ones is preserved.
+ *
+ * This bounds the work done by tryBreak() at each break opportunity, but
+ * the removed breakpoints may have led to a better paragraph
+ * (see \c checkpruning). The list-based computeFeasibleBreakpoints() does
+ * not prune.
+ */
+void Paragraph::prune(BreakGraph& graph)
+{
+  if (maxactive == 0 && demeritscutoff < 0)
+    return;
+
+  std::vector<size_t>& active = graph.active;
+
+  // Sorts the demerits by line, then computes the limit of each line
+  graph.ranked.clear();
+
+  for (size_t n : active)
+    graph.ranked.emplace_back(graph.nodes[n].line, graph.nodes[n].demerits);
+
+  std::sort(graph.ranked.begin(), graph.ranked.end());
+
+  graph.limits.clear();
+
+  for (size_t a(0); a < graph.ranked.size(); )
+  {
+    const size_t line = graph.ranked[a].first;
+    const Demerits best = graph.ranked[a].second;
+
+    size_t end = a;
+
+    while (end < graph.ranked.size() && graph.ranked[end].first == line)
+      ++end;
+
+    PruningLimit limit{ line, std::numeric_limits<Demerits>::max(), std::numeric_limits<size_t>::max() };
+
+    if (demeritscutoff >= 0 && best <= limit.demerits - demeritscutoff)
+      limit.demerits = best + demeritscutoff;
+
+    if (maxactive != 0 && end - a > maxactive && graph.ranked[a + maxactive - 1].second <= limit.demerits)
+    {
+      limit.demerits = graph.ranked[a + maxactive - 1].second;
+
+      // Number of breakpoints with demerits equal to the limit that can be kept
+      auto first_tie = std::lower_bound(graph.ranked.begin() + a, graph.ranked.begin() + end, std::make_pair(line, limit.demerits));
+      limit.ties = a + maxactive - static_cast<size_t>(first_tie - graph.ranked.begin());
+    }
+
+    graph.limits.push_back(limit);
+    a = end;
+  }
+
+  size_t out = 0;
+
+  for (size_t n : active)
+  {
+    const BreakNode& node = graph.nodes[n];
+
+    auto limit = std::lower_bound(graph.limits.begin(), graph.limits.end(), node.line, [](const PruningLimit& l, size_t line) {
+      return l.line < line;
+    });
+
+    if (node.demerits < limit->demerits || (node.demerits == limit->demerits && limit->ties != 0))
+    {
+      if (node.demerits == limit->demerits)
+        --limit->ties;
+
+      active[out++] = n;
+    }
+    else
+    {
+      ++statistics.pruned;
+    }
+  }
+
+  active.resize(out);
+}
+
+/*!
+ * \fn NodeRef<HBox> createLine(size_t linenum, const HListView& hlist, size_t begin, size_t end, List* source, const List* postbreak, const List* prebreak)
+ * \brief Creates the box of a line made of the nodes in [begin, end)
+ *
+ * If \a source is not null, it must be the list viewed by \a hlist; the nodes
+ * of the line are then moved out of it and their positions are erased from it.
+ *
+ * \a postbreak and \a prebreak are the lists of the discretionaries the line
+ * starts after and ends at, if any; they are put at the start and at the end
+ * of the line. Discretionaries inside the line are replaced by their
+ * no-break list.
+ */
+NodeRef<HBox> Paragraph::createLine(size_t linenum, const HListView& hlist, size_t begin, size_t end, List* source, const List* postbreak, const List* prebreak)
 {
   float parshape_indent = 0.f;
 
+  ChildList line;
+  line.reserve(end - begin + 3);
+  BoxingInfo info;
+
+  auto append = [&](const NodeRef<Node>& node) {
+    HBox::accumulate(info, *node);
+    line.push_back(node);
+  };
+
+  auto append_range = [&]() {
+    if (postbreak)
+    {
+      for (const auto& node : *postbreak)
+        append(node);
+    }
+
+    hlist.getBoxingInfo(begin, end, info);
+
+    const size_t offset = line.size();
+
+    if (source)
+    {
+      auto first = source->erase(hlist.position(begin), hlist.position(begin));
+      auto last = source->erase(hlist.position(end), hlist.position(end));
+      line.insert(line.end(), std::make_move_iterator(first), std::make_move_iterator(last));
+      source->erase(first, last);
+    }
+    else
+    {
+      line.insert(line.end(), hlist.position(begin), hlist.position(end));
+    }
+
+    // Discretionaries that are not broken at are typeset as their no-break list
+    for (size_t i(offset); i < line.size();)
+    {
+      if (!line[i]->isDiscretionary())
+      {
+        ++i;
+        continue;
+      }
+
+      const List nobreak = line[i]->as<Discretionary>().nobreak();
+      auto it = line.erase(line.begin() + i);
+      line.insert(it, nobreak.begin(), nobreak.end());
+      i += nobreak.size();
+    }
+
+    if (prebreak)
+    {
+      for (const auto& node : *prebreak)
+        append(node);
+    }
+  };
+
   if (!parshape.empty())
   {
-    List hlist;
-
     if (linenum >= parshape.size())
-      hlist.push_back(tex::kern(parshape.back().indent));
+      append(make_node<Kern>(arena.get(), parshape.back().indent));
     else
-      hlist.push_back(tex::kern(parshape.at(linenum).indent));
+      append(make_node<Kern>(arena.get(), parshape.at(linenum).indent));
 
-
-    hlist.push_back(leftskip);
-    hlist.insert(hlist.end(), begin, end);
-    hlist.push_back(rightskip);
-    return hbox(std::move(hlist), linelength(linenum) + parshape_indent);
+    append(leftskip);
+    append_range();
+    append(rightskip);
+    return make_node<HBox>(arena.get(), std::move(line), linelength(linenum) + parshape_indent, info);
   }
   else if (hangindent != 0.f && hangindentAppliesToLine(linenum))
   {
-    List hlist;
-    
     if(hangindent > 0.f)
-      hlist.push_back(tex::kern(hangindent));
+      append(make_node<Kern>(arena.get(), hangindent));
 
-    hlist.push_back(leftskip);
-    hlist.insert(hlist.end(), begin, end);
-    hlist.push_back(rightskip);
+    append(leftskip);
+    append_range();
+    append(rightskip);
 
     if (hangindent < 0.f)
-      hlist.push_back(tex::kern(std::abs(hangindent)));
+      append(make_node<Kern>(arena.get(), std::abs(hangindent)));
 
-    return hbox(std::move(hlist), linelength(linenum) + std::abs(hangindent));
+    return make_node<HBox>(arena.get(), std::move(line), linelength(linenum) + std::abs(hangindent), info);
   }
   else
   {
-    List hlist;
-    hlist.push_back(leftskip);
-    hlist.insert(hlist.end(), begin, end);
-    hlist.push_back(rightskip);
-    return hbox(std::move(hlist), linelength(linenum));
+    append(leftskip);
+    append_range();
+    append(rightskip);
+    return make_node<HBox>(arena.get(), std::move(line), linelength(linenum), info);
   }
 }
 
 bool Paragraph::isDiscardable(const Node & node)
 {
-  return node.isKern() || node.isGlue() || node.isPenalty();
+  return node.isDiscardable();
 }
 
 bool Paragraph::isForcedLinebreak(const Node & node)
@@ -494,10 +1815,22 @@ bool Paragraph::isForbiddenLinebreak(const Node & node)
   return node.isPenalty() && node.as<Penalty>().value() >= Penalty::Infinity;
 }
 
-void Paragraph::consumeDiscardable(List::const_iterator & it)
+bool Paragraph::isForcedLinebreak(const HListView& hlist, size_t i)
+{
+  return hlist.isPenalty(i) && hlist.penalty(i) <= -Penalty::Infinity;
+}
+
+bool Paragraph::isForbiddenLinebreak(const HListView& hlist, size_t i)
 {
-  while (isDiscardable(**it))
-    ++it;
+  return hlist.isPenalty(i) && hlist.penalty(i) >= Penalty::Infinity;
+}
+
+size_t Paragraph::consumeDiscardable(const HListView& hlist, size_t i)
+{
+  while (i < hlist.size() && (hlist.isGlue(i) || hlist.isKern(i) || hlist.isPenalty(i)))
+    ++i;
+
+  return i;
 }
 
 } // namespace tex
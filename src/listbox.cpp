@@ -4,27 +4,113 @@
 
 #include "tex/listbox.h"
 
+#include "tex/hbox.h"
 #include "tex/kern.h"
+#include "tex/vbox.h"
 
 namespace tex
 {
 
-ListBox::ListBox(List && list)
-  : mList(std::move(list))
+ListBox::ListBox(NodeKind k, List && list)
+  : Box(k)
+  , mList(std::make_move_iterator(list.begin()), std::make_move_iterator(list.end()))
   , mShiftAmount(0)
   , mGlueSettings{0.f, GlueOrder::Normal}
 {
 
 }
 
-ListBox::ListBox(const BoxMetrics& metrics)
-  : Box(metrics), 
+ListBox::ListBox(NodeKind k, ChildList && list)
+  : Box(k)
+  , mList(std::move(list))
+  , mShiftAmount(0)
+  , mGlueSettings{0.f, GlueOrder::Normal}
+{
+
+}
+
+ListBox::ListBox(NodeKind k, const BoxMetrics& metrics)
+  : Box(k, metrics), 
     mShiftAmount(0), 
     mGlueSettings{ 0.f, GlueOrder::Normal }
 {
 
 }
 
+/*!
+ * \fn const BoxingInfo& totals() const
+ * \brief Returns the natural dimensions and glue totals of the box's list
+ *
+ * The totals are cached and only recomputed after the list was modified
+ * in a way that could not be tracked.
+ */
+const BoxingInfo& ListBox::totals() const
+{
+  if (!mTotalsValid)
+  {
+    mTotals = BoxingInfo{};
+
+    for (const auto& node : mList)
+      accumulate(mTotals, *node);
+
+    mTotalsValid = true;
+  }
+
+  return mTotals;
+}
+
+void ListBox::setTotals(const BoxingInfo& info)
+{
+  mTotals = info;
+  mTotalsValid = true;
+}
+
+void ListBox::addToTotals(const Node& node)
+{
+  if (mTotalsValid)
+    accumulate(mTotals, node);
+}
+
+void ListBox::removeFromTotals(const Node& node)
+{
+  if (!mTotalsValid)
+    return;
+
+  // glue totals are compared against zero when setting the glue,
+  // they must not carry rounding errors
+  if (node.isGlue())
+  {
+    invalidateTotals();
+    return;
+  }
+
+  BoxingInfo delta;
+  accumulate(delta, node);
+
+  if (isHBox())
+  {
+    mTotals.width -= delta.width;
+
+    if (delta.height >= mTotals.height || delta.depth >= mTotals.depth)
+      invalidateTotals();
+  }
+  else
+  {
+    mTotals.height -= delta.height;
+
+    if (delta.width >= mTotals.width)
+      invalidateTotals();
+  }
+}
+
+void ListBox::accumulate(BoxingInfo& info, const Node& node) const
+{
+  if (isHBox())
+    HBox::accumulate(info, node);
+  else
+    VBox::accumulate(info, node);
+}
+
 void ListBox::setGlue(float ratio, GlueOrder order)
 {
   mGlueSettings.ratio = ratio;
@@ -107,11 +193,36 @@ ListBoxEditor::~ListBoxEditor()
 
 }
 
-List & ListBoxEditor::list()
+ChildList & ListBoxEditor::list()
 {
+  mListExposed = true;
   return mListBox->mutableList();
 }
 
+void ListBoxEditor::push_back(NodeRef<Node> node)
+{
+  mListBox->addToTotals(*node);
+  mListBox->mList.push_back(std::move(node));
+}
+
+void ListBoxEditor::push_front(NodeRef<Node> node)
+{
+  mListBox->addToTotals(*node);
+  mListBox->mList.push_front(std::move(node));
+}
+
+ChildList::iterator ListBoxEditor::insert(ChildList::const_iterator pos, NodeRef<Node> node)
+{
+  mListBox->addToTotals(*node);
+  return mListBox->mList.insert(pos, std::move(node));
+}
+
+ChildList::iterator ListBoxEditor::erase(ChildList::const_iterator pos)
+{
+  mListBox->removeFromTotals(**pos);
+  return mListBox->mList.erase(pos);
+}
+
 void ListBoxEditor::enlarge(float amount)
 {
   mListBox->setWidth(mListBox->width() + amount);
@@ -132,4 +243,17 @@ void ListBoxEditor::setDepth(float d)
   mListBox->setDepth(d);
 }
 
+/*!
+ * \fn void sync()
+ * \brief Ensures the box's totals are up-to-date before a rebox
+ *
+ * The list returned by list() may have been modified after the call,
+ * in which case the totals are invalidated again.
+ */
+void ListBoxEditor::sync()
+{
+  if (mListExposed)
+    mListBox->invalidateTotals();
+}
+
 } // namespace tex
@@ -10,8 +10,9 @@ namespace tex
 namespace math
 {
 
-Atom::Atom(Type t, std::shared_ptr<Node> nucleus, std::shared_ptr<Node> subscript, std::shared_ptr<Node> superscript, std::shared_ptr<Symbol> accent, LimitsFlag limits)
-  : mType(t)
+Atom::Atom(Type t, NodeRef<Node> nucleus, NodeRef<Node> subscript, NodeRef<Node> superscript, NodeRef<Symbol> accent, LimitsFlag limits)
+  : Node(NodeKind::Atom)
+  , mType(t)
   , mNucleus(nucleus)
   , mSubscript(subscript)
   , mSuperscript(superscript)
@@ -21,18 +22,13 @@ Atom::Atom(Type t, std::shared_ptr<Node> nucleus, std::shared_ptr<Node> subscrip
 
 }
 
-bool Atom::isAtom() const
-{
-  return true;
-}
-
 void Atom::changeType(Type newtype)
 {
   /// TODO: check that the type change is allowed !
   mType = newtype;
 }
 
-void Atom::changeNucleus(const std::shared_ptr<Node> & nuc)
+void Atom::changeNucleus(const NodeRef<Node> & nuc)
 {
   /// TODO: check that change is allowed
   mNucleus = nuc;
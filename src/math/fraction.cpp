@@ -1,20 +0,0 @@
-// Copyright (C) 2020 Vincent Chambrin
-// This file is part of the 'typeset' project
-// For conditions of distribution and use, see copyright notice in LICENSE
-
-#include "tex/math/fraction.h"
-
-namespace tex
-{
-
-namespace math
-{
-
-bool Fraction::isFraction() const
-{
-  return true;
-}
-
-} // namespace math
-
-} // namespace tex
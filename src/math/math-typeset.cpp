@@ -155,6 +155,16 @@ void MathTypesetter::setInsertPenalties(bool on)
   m_insert_penalties = on;
 }
 
+const std::shared_ptr<NodeArena>& MathTypesetter::arena() const
+{
+  return m_arena;
+}
+
+void MathTypesetter::setArena(std::shared_ptr<NodeArena> arena)
+{
+  m_arena = std::move(arena);
+}
+
 List MathTypesetter::mlist2hlist(MathList mlist, math::Style style)
 {
   if (mlist.empty())
@@ -173,7 +183,7 @@ List MathTypesetter::mlist2hlist(MathList mlist, math::Style style)
   {
     auto current = *it;
     const bool isLast = current == mlist.back();
-    std::shared_ptr<Node> next = (isLast ? nullptr : *std::next(it));
+    NodeRef<Node> next = (isLast ? nullptr : *std::next(it));
     const bool nextIsRel = next != nullptr && next->is<math::Atom>() && cast<math::Atom>(next)->type() == math::Atom::Rel;
 
     if (current->is<math::Atom>() && m_most_recent_atom != nullptr)
@@ -187,9 +197,9 @@ List MathTypesetter::mlist2hlist(MathList mlist, math::Style style)
       if (!isLast && insertPenalties() && (next == nullptr || !next->isPenalty()))
       {
         if (m_most_recent_atom->type() == math::Atom::Op && binoppenalty() != 0)
-          ret.push_back(tex::penalty(binoppenalty()));
+          ret.push_back(make<Penalty>(binoppenalty()));
         else if (m_most_recent_atom->type() == math::Atom::Rel && relpenalty() != 0 && !nextIsRel)
-          ret.push_back(tex::penalty(relpenalty()));
+          ret.push_back(make<Penalty>(relpenalty()));
       }
 
     }
@@ -231,18 +241,43 @@ FontMetrics MathTypesetter::getMetrics(int fam, math::Style style) const
   return FontMetrics{ getFont(fam, style), engine().metrics() };
 }
 
-std::shared_ptr<Box> MathTypesetter::nullbox()
+NodeRef<Box> MathTypesetter::nullbox()
 {
-  static std::shared_ptr<Box> globalInstance = tex::hbox({});
+  static NodeRef<Box> globalInstance = tex::hbox({});
   return globalInstance;
 }
 
-std::shared_ptr<Box> MathTypesetter::typeset(std::shared_ptr<MathSymbol> symbol)
+NodeRef<Kern> MathTypesetter::kern(float space)
+{
+  return make<Kern>(space);
+}
+
+NodeRef<Rule> MathTypesetter::hrule(float width, float height, float depth)
+{
+  return make<Rule>(width, height, depth);
+}
+
+NodeRef<HBox> MathTypesetter::hbox(List&& hlist)
+{
+  return make<HBox>(std::move(hlist));
+}
+
+NodeRef<HBox> MathTypesetter::hbox(List&& hlist, float width)
+{
+  return make<HBox>(std::move(hlist), width);
+}
+
+NodeRef<VBox> MathTypesetter::vbox(List&& vlist)
+{
+  return make<VBox>(std::move(vlist));
+}
+
+NodeRef<Box> MathTypesetter::typeset(NodeRef<MathSymbol> symbol)
 {
   return engine().typeset(symbol, getFont(symbol->family()));
 }
 
-std::shared_ptr<Box> MathTypesetter::typesetDelimiter(const std::shared_ptr<Symbol>& ms, float minTotalHeight)
+NodeRef<Box> MathTypesetter::typesetDelimiter(const NodeRef<Symbol>& ms, float minTotalHeight)
 {
   if (ms == nullptr)
     return nullbox();
@@ -250,10 +285,10 @@ std::shared_ptr<Box> MathTypesetter::typesetDelimiter(const std::shared_ptr<Symb
   return engine().typesetDelimiter(ms, minTotalHeight);
 }
 
-std::shared_ptr<VBox> MathTypesetter::radicalSignBox(float minTotalHeight)
+NodeRef<VBox> MathTypesetter::radicalSignBox(float minTotalHeight)
 {
-  std::shared_ptr<Box> box = engine().typesetRadicalSign(minTotalHeight);
-  auto ret = tex::vbox({ box });
+  NodeRef<Box> box = engine().typesetRadicalSign(minTotalHeight);
+  auto ret = vbox({ box });
   const float theta = getMetrics(XiFamily).defaultRuleThickness();
 
   // @TODO: TeX takes the radical sign from font family 3 (math extension font),
@@ -270,7 +305,7 @@ std::shared_ptr<VBox> MathTypesetter::radicalSignBox(float minTotalHeight)
   return ret;
 }
 
-std::shared_ptr<Box> MathTypesetter::boxit(std::shared_ptr<Node> node)
+NodeRef<Box> MathTypesetter::boxit(NodeRef<Node> node)
 {
   if (node == nullptr)
   {
@@ -289,55 +324,57 @@ std::shared_ptr<Box> MathTypesetter::boxit(std::shared_ptr<Node> node)
     MathList mlist = cast<MathListNode>(node)->list();
     MathTypesetter typesetter{ sharedEngine() };
     typesetter.setFonts(m_fonts);
+    typesetter.setArena(m_arena);
     List hlist = typesetter.mlist2hlist(std::move(mlist), m_current_style);
-    return tex::hbox(std::move(hlist));
+    return hbox(std::move(hlist));
   }
 
   throw std::runtime_error{ "boxit() : invalid input" };
 }
 
-std::shared_ptr<Box> MathTypesetter::boxit(std::shared_ptr<Node> node, math::Style s)
+NodeRef<Box> MathTypesetter::boxit(NodeRef<Node> node, math::Style s)
 {
   RAIIStyleGuard style_guard{ m_current_style };
   m_current_style = s;
   return boxit(node);
 }
 
-std::shared_ptr<HBox> MathTypesetter::boxit(MathList mlist)
+NodeRef<HBox> MathTypesetter::boxit(MathList mlist)
 {
   return boxit(std::move(mlist), m_current_style);
 }
 
-std::shared_ptr<HBox> MathTypesetter::boxit(MathList mlist, math::Style s)
+NodeRef<HBox> MathTypesetter::boxit(MathList mlist, math::Style s)
 {
   MathTypesetter typesetter{ sharedEngine() };
   typesetter.setFonts(m_fonts);
+  typesetter.setArena(m_arena);
 
   List hlist = typesetter.mlist2hlist(std::move(mlist), s);
-  return tex::hbox(std::move(hlist));
+  return hbox(std::move(hlist));
 }
 
-std::shared_ptr<HBox> MathTypesetter::hboxit(std::shared_ptr<Node> node)
+NodeRef<HBox> MathTypesetter::hboxit(NodeRef<Node> node)
 {
   auto box = boxit(node);
   if (!box->isHBox())
-    return tex::hbox(List{ box });
+    return hbox(List{ box });
   return cast<HBox>(box);
 }
 
-std::shared_ptr<Box> MathTypesetter::mathstrut()
+NodeRef<Box> MathTypesetter::mathstrut()
 {
-  static const auto leftpar = std::make_shared<tex::MathSymbol>('(', math::Atom::Open, 3);
+  static const auto leftpar = make_node<tex::MathSymbol>('(', math::Atom::Open, 3);
 
   BoxMetrics metrics = getMetrics(XiFamily, math::Style::D).metrics(leftpar);
   metrics.width = 0.f;
 
-  return std::make_shared<VBox>(metrics);
+  return make<VBox>(metrics);
 }
 
-std::shared_ptr<Kern> MathTypesetter::quad()
+NodeRef<Kern> MathTypesetter::quad()
 {
-  return std::make_shared<Kern>(getMetrics(0, math::Style::D).quad());
+  return make<Kern>(getMetrics(0, math::Style::D).quad());
 }
 
 void MathTypesetter::preprocess(MathList& mlist)
@@ -455,7 +492,7 @@ void MathTypesetter::preprocess(MathList& mlist)
 
 void MathTypesetter::rule2_translateglue(MathList& mlist, MathList::iterator& current)
 {
-  auto g = std::static_pointer_cast<Glue>(*current);
+  auto g = static_pointer_cast<Glue>(*current);
 
   if (g->origin() == GlueOrigin::nonscript)
   {
@@ -484,7 +521,7 @@ void MathTypesetter::rule2_translateglue(MathList& mlist, MathList::iterator& cu
 
 void MathTypesetter::rule5_binatom(MathList& mlist, MathList::iterator& current)
 {
-  auto atom = std::static_pointer_cast<math::Atom>(*current);
+  auto atom = static_pointer_cast<math::Atom>(*current);
 
   auto filter = [](math::Atom::Type t) -> bool {
     switch (t)
@@ -513,11 +550,11 @@ void MathTypesetter::rule5_binatom(MathList& mlist, MathList::iterator& current)
 
 void MathTypesetter::rule8_vcent(MathList& mlist, MathList::iterator& current)
 {
-  auto atom = std::static_pointer_cast<math::Atom>(*current);
+  auto atom = static_pointer_cast<math::Atom>(*current);
 
   auto x = boxit(atom->nucleus());
   if (!x->is<VBox>())
-    x = tex::vbox({ x });
+    x = vbox({ x });
   float v = x->totalHeight();
   float a = sigma<22>();
   {
@@ -533,18 +570,18 @@ void MathTypesetter::rule8_vcent(MathList& mlist, MathList::iterator& current)
 
 void MathTypesetter::rule9_over(MathList& mlist, MathList::iterator& current)
 {
-  auto atom = std::static_pointer_cast<math::Atom>(*current);
+  auto atom = static_pointer_cast<math::Atom>(*current);
 
   auto x = boxit(atom->nucleus(), m_current_style.cramp());
   float theta = xi<8>(); // default_rule_thickness
-  auto box = tex::vbox({ kern(theta), hrule(x->width(), theta), kern(3 * theta), x });
+  auto box = vbox({ kern(theta), hrule(x->width(), theta), kern(3 * theta), x });
   atom->changeNucleus(box);
   rule16_changeToOrd(mlist, current);
 }
 
 void MathTypesetter::rule10_underline(MathList& mlist, MathList::iterator& current)
 {
-  auto atom = std::static_pointer_cast<math::Atom>(*current);
+  auto atom = static_pointer_cast<math::Atom>(*current);
 
   auto x = boxit(atom->nucleus(), m_current_style.cramp());
   float theta = xi<8>(); // default_rule_thickness
@@ -575,9 +612,9 @@ void MathTypesetter::rule13_opatom(MathList& mlist, MathList::iterator& current)
     auto x = engine().typesetLargeOp(mathsymbol);
     delta = getMetrics(mathsymbol->family()).italicCorrection(mathsymbol);
     const float a = getMetrics(SigmaFamily).axisHeight();
-    auto boxed_x = tex::hbox({ x });
+    auto boxed_x = hbox({ x });
     boxed_x->setShiftAmount(0.5f * (x->height() - x->depth()) - a);
-    atom->changeNucleus(tex::hbox({ x }));
+    atom->changeNucleus(hbox({ x }));
   }
 
   if (!hasLimits)
@@ -591,34 +628,34 @@ void MathTypesetter::rule13_opatom(MathList& mlist, MathList::iterator& current)
   auto z = boxit(atom->subscript(), m_current_style.sub());
 
   const float w = std::max({ x->width(), y->width(), z->width() });
-  const std::shared_ptr<Glue> reboxGlue = tex::glue(0.f, tex::Stretch{ 1.0f, GlueOrder::Fil });
+  const NodeRef<Glue> reboxGlue = make<Glue>(0.f, 0.f, 1.f, GlueOrder::Normal, GlueOrder::Fil);
   if (x->width() < w)
-    x = tex::hbox({ reboxGlue, x, reboxGlue }, w);
+    x = hbox({ reboxGlue, x, reboxGlue }, w);
   if (y->width() < w)
-    y = tex::hbox({ reboxGlue, y, reboxGlue }, w);
+    y = hbox({ reboxGlue, y, reboxGlue }, w);
   if (z->width() < w)
-    z = tex::hbox({ reboxGlue, z, reboxGlue }, w);
+    z = hbox({ reboxGlue, z, reboxGlue }, w);
 
   List vlist;
   if (atom->superscript() != nullptr)
   {
-    vlist.push_back(tex::kern(getMetrics(XiFamily).bigOpSpacing5()));
+    vlist.push_back(kern(getMetrics(XiFamily).bigOpSpacing5()));
     cast<ListBox>(x)->shift(0.5f * delta);
     vlist.push_back(x);
     vlist.push_back(kern(std::max({ getMetrics(XiFamily).bigOpSpacing1(), getMetrics(XiFamily).bigOpSpacing3() - x->depth() })));
   }
   vlist.push_back(y);
 
-  auto vbox = tex::vbox(std::move(vlist));
+  auto vbox = this->vbox(std::move(vlist));
   const float h = vbox->totalHeight() - y->depth();
 
   if (atom->subscript() != nullptr)
   {
     VBoxEditor editor{ *vbox };
-    editor.list().push_back(kern(std::max({ getMetrics(XiFamily).bigOpSpacing2(), getMetrics(XiFamily).bigOpSpacing4() - z->height() })));
+    editor.push_back(kern(std::max({ getMetrics(XiFamily).bigOpSpacing2(), getMetrics(XiFamily).bigOpSpacing4() - z->height() })));
     cast<ListBox>(z)->shift(-0.5f * delta);
-    editor.list().push_back(z);
-    editor.list().push_back(kern(getMetrics(XiFamily).bigOpSpacing5()));
+    editor.push_back(z);
+    editor.push_back(kern(getMetrics(XiFamily).bigOpSpacing5()));
     editor.rebox();
     editor.changeHeight(h);
     editor.done();
@@ -629,7 +666,7 @@ void MathTypesetter::rule13_opatom(MathList& mlist, MathList::iterator& current)
 
 void MathTypesetter::rule11_radatom(MathList& mathlist, MathList::iterator& current)
 {
-  std::shared_ptr<math::Atom> atom = cast<math::Atom>(*current);
+  NodeRef<math::Atom> atom = cast<math::Atom>(*current);
   assert(atom->type() == math::Atom::Rad);
 
   auto x = boxit(atom->nucleus(), m_current_style.cramp());
@@ -640,17 +677,17 @@ void MathTypesetter::rule11_radatom(MathList& mathlist, MathList::iterator& curr
   theta = y->height();
   if (y->depth() > psi + y->totalHeight())
     psi = 0.5f * (psi + y->depth() - x->totalHeight());
-  auto vbox = tex::vbox({ kern(theta), tex::hrule(x->width(), theta), kern(psi), x });
+  auto vbox = this->vbox({ kern(theta), hrule(x->width(), theta), kern(psi), x });
   y->setShiftAmount(y->shiftAmount() - (psi + x->height()));
-  atom->changeNucleus(tex::hbox({ y, vbox }));
+  atom->changeNucleus(hbox({ y, vbox }));
   rule16_changeToOrd(mathlist, current);
 }
 
 void MathTypesetter::rule12_accatom(MathList& mathlist, MathList::iterator& current)
 {
-  std::shared_ptr<math::Atom> atom = cast<math::Atom>(*current);
+  NodeRef<math::Atom> atom = cast<math::Atom>(*current);
 
-  std::shared_ptr<Box> x = boxit(atom->nucleus(), m_current_style.cramp());
+  NodeRef<Box> x = boxit(atom->nucleus(), m_current_style.cramp());
   const float u = x->width();
   float delta = std::min(x->height(), getMetrics(SigmaFamily).xHeight()); // @TODO: should be x-height in accent font
 
@@ -663,13 +700,13 @@ void MathTypesetter::rule12_accatom(MathList& mathlist, MathList::iterator& curr
   }
 
   /// TODO : add support for extensible accent !
-  auto y = tex::hbox({ typeset(std::dynamic_pointer_cast<MathSymbol>(atom->accent())) });
+  auto y = hbox({ typeset(dynamic_pointer_cast<MathSymbol>(atom->accent())) });
   y->shift(0.5f * (u - y->width()));
-  auto z = tex::vbox({ y, kern(-delta), x });
+  auto z = vbox({ y, kern(-delta), x });
   if (z->height() < x->height())
   {
     VBoxEditor editor{ *z };
-    editor.list().push_front(kern(x->height() - z->height()));
+    editor.push_front(kern(x->height() - z->height()));
     editor.rebox();
     editor.done();
   }
@@ -707,9 +744,9 @@ void MathTypesetter::rule17_processatom(MathList& mathlist, MathList::iterator&
   attachSubSup(mathlist, current);
 }
 
-bool MathTypesetter::isCharacterBox(const std::shared_ptr<Node>& node, float* w, float* h, float* d)
+bool MathTypesetter::isCharacterBox(const NodeRef<Node>& node, float* w, float* h, float* d)
 {
-  std::shared_ptr<Box> cbox = std::dynamic_pointer_cast<tex::Box>(node);
+  NodeRef<Box> cbox = dynamic_pointer_cast<tex::Box>(node);
 
   if (cbox == nullptr || cbox->isVBox())
     return false;
@@ -767,7 +804,7 @@ void MathTypesetter::attachSubSup(MathList& mlist, MathList::iterator& current)
     auto x = boxit(atom->subscript(), m_current_style.sub());
     if (isCharacterBox(x))
     {
-      x = tex::hbox({ x, kern(scriptspace) });
+      x = hbox({ x, kern(scriptspace) });
     }
     else
     {
@@ -777,14 +814,14 @@ void MathTypesetter::attachSubSup(MathList& mlist, MathList::iterator& current)
 
     float shift = std::max({ v, getMetrics(SigmaFamily).sub1(), x->height() - (4.f / 5.f) * std::abs(getMetrics(SigmaFamily).xHeight()) });
     cast<HBox>(x)->shift(shift);
-    atom->changeNucleus(tex::hbox({ atom->nucleus(), x }));
+    atom->changeNucleus(hbox({ atom->nucleus(), x }));
     return;
   }
 
   auto x = boxit(atom->superscript(), m_current_style.sup());
   if (isCharacterBox(x))
   {
-    x = tex::hbox({ x, kern(scriptspace) });
+    x = hbox({ x, kern(scriptspace) });
   }
   else
   {
@@ -798,14 +835,14 @@ void MathTypesetter::attachSubSup(MathList& mlist, MathList::iterator& current)
   if (atom->subscript() == nullptr)
   {
     cast<HBox>(x)->shift(-u);
-    atom->changeNucleus(tex::hbox({ atom->nucleus(), x }));
+    atom->changeNucleus(hbox({ atom->nucleus(), x }));
     return;
   }
 
   auto y = boxit(atom->superscript(), m_current_style.sub());
   if (isCharacterBox(y))
   {
-    y = tex::hbox({ y, kern(scriptspace) });
+    y = hbox({ y, kern(scriptspace) });
   }
   else
   {
@@ -833,19 +870,19 @@ void MathTypesetter::attachSubSup(MathList& mlist, MathList::iterator& current)
 
   cast<ListBox>(x)->shift(delta);
   const float totalHeight = x->totalHeight() + u + v + y->totalHeight();
-  auto vbox = tex::vbox({ x, kern(totalHeight - (x->totalHeight() + y->totalHeight())), y });
+  auto vbox = this->vbox({ x, kern(totalHeight - (x->totalHeight() + y->totalHeight())), y });
   {
     ListBoxEditor editor{ *vbox };
     editor.setHeight(x->height() + u);
     editor.setDepth(y->depth() + v);
   }
-  atom->changeNucleus(tex::hbox({ atom->nucleus(), vbox }));
+  atom->changeNucleus(hbox({ atom->nucleus(), vbox }));
 }
 
 
 void MathTypesetter::rule15_fraction(MathList& mlist, MathList::iterator& current)
 {
-  std::shared_ptr<math::Fraction> frac = cast<math::Fraction>(*current);
+  NodeRef<math::Fraction> frac = cast<math::Fraction>(*current);
 
   float theta = getMetrics(XiFamily).defaultRuleThickness();
 
@@ -853,13 +890,13 @@ void MathTypesetter::rule15_fraction(MathList& mlist, MathList::iterator& curren
   auto z = boxit(frac->denom(), m_current_style.fracDen());
   if (x->width() < z->width())
   {
-    const std::shared_ptr<Glue> reboxGlue = tex::glue(0.f, tex::Stretch{ 1.0f, GlueOrder::Fil });
-    x = tex::hbox({ reboxGlue, x, reboxGlue }, z->width());
+    const NodeRef<Glue> reboxGlue = make<Glue>(0.f, 0.f, 1.f, GlueOrder::Normal, GlueOrder::Fil);
+    x = hbox({ reboxGlue, x, reboxGlue }, z->width());
   }
   else if (z->width() < x->width())
   {
-    const std::shared_ptr<Glue> reboxGlue = tex::glue(0.f, tex::Stretch{ 1.0f, GlueOrder::Fil });
-    z = tex::hbox({ reboxGlue, z, reboxGlue }, x->width());
+    const NodeRef<Glue> reboxGlue = make<Glue>(0.f, 0.f, 1.f, GlueOrder::Normal, GlueOrder::Fil);
+    z = hbox({ reboxGlue, z, reboxGlue }, x->width());
   }
   const float w = z->width();
 
@@ -898,7 +935,7 @@ void MathTypesetter::rule15_fraction(MathList& mlist, MathList::iterator& curren
   vlist.push_back(kern(a - 0.5f * theta + v - z->height()));
   vlist.push_back(z);
 
-  auto vbox = tex::vbox(std::move(vlist));
+  auto vbox = this->vbox(std::move(vlist));
 
   {
     tex::VBoxEditor editor{ *vbox };
@@ -927,7 +964,7 @@ void MathTypesetter::processRoot(MathList& mlist, MathList::iterator& current)
   theta = y->height();
   if (y->depth() > psi + y->totalHeight())
     psi = 0.5f * (psi + y->depth() - x->totalHeight());
-  auto vbox = tex::vbox({ kern(theta), tex::hrule(x->width(), theta), kern(psi), x });
+  auto vbox = this->vbox({ kern(theta), hrule(x->width(), theta), kern(psi), x });
   y->setShiftAmount(y->shiftAmount() - (psi + x->height()));
 
   // Handle the root index
@@ -941,7 +978,7 @@ void MathTypesetter::processRoot(MathList& mlist, MathList::iterator& current)
   const float shiftAmount = 0.6f * (h - d);
   index->shift(-shiftAmount);
 
-  auto atom = math::Atom::create<math::Atom::Rad>(tex::hbox({ index, kern(-radicalSignBoxWidth), y, vbox }));
+  auto atom = math::Atom::create<math::Atom::Rad>(hbox({ index, kern(-radicalSignBoxWidth), y, vbox }));
   *current = atom;
   rule16_changeToOrd(mlist, current);
 }
@@ -955,15 +992,15 @@ void MathTypesetter::processMatrix(MathList& mlist, MathList::iterator& current)
   //   #1\crcr\mathstrut\crcr\noalign{\kern-\baselineskip} }
   //   }\,}
 
-  auto matrix = std::static_pointer_cast<math::Matrix>(*current);
+  auto matrix = static_pointer_cast<math::Matrix>(*current);
 
-  auto hfil = tex::glue(0.f, tex::Stretch{1.f, GlueOrder::Fil});
+  auto hfil = make<Glue>(0.f, 0.f, 1.f, GlueOrder::Normal, GlueOrder::Fil);
   auto quad_kern = quad();
-  std::shared_ptr<Kern> negbaselineskip = tex::kern(-m_baselineskip->space());
+  NodeRef<Kern> negbaselineskip = kern(-m_baselineskip->space());
 
-  std::shared_ptr<tex::Box> strut = mathstrut();
+  NodeRef<tex::Box> strut = mathstrut();
 
-  std::vector<std::shared_ptr<tex::HBox>> boxes;
+  std::vector<NodeRef<tex::HBox>> boxes;
 
   for (const auto& nested_mlist : matrix->elements())
   {
@@ -978,7 +1015,7 @@ void MathTypesetter::processMatrix(MathList& mlist, MathList::iterator& current)
     col_sizes[col] = std::max({ col_sizes[col], boxes.at(i)->width() });
   }
 
-  std::vector<std::shared_ptr<HBox>> rows;
+  std::vector<NodeRef<HBox>> rows;
 
   for (size_t i(0); i < matrix->rows(); ++i)
   {
@@ -986,27 +1023,28 @@ void MathTypesetter::processMatrix(MathList& mlist, MathList::iterator& current)
 
     for (size_t j(0); j < matrix->cols(); ++j)
     {
-      std::shared_ptr<HBox> curr_elem = boxes.at(i * matrix->cols() + j);
+      NodeRef<HBox> curr_elem = boxes.at(i * matrix->cols() + j);
 
       HBoxEditor editor{ *curr_elem };
 
       if (j != 0)
-        editor.list().push_front(quad_kern);
+        editor.push_front(quad_kern);
 
-      editor.list().push_front(hfil);
-      editor.list().push_back(hfil);
+      editor.push_front(hfil);
+      editor.push_back(hfil);
 
       editor.rebox(col_sizes[j]);
 
       row_content.push_back(curr_elem);
     }
 
-    auto row_box = tex::hbox(std::move(row_content));
+    auto row_box = hbox(std::move(row_content));
     rows.push_back(row_box);
   }
 
 
   VListBuilder vlist{m_baselineskip, m_lineskip};
+  vlist.arena = m_arena;
   vlist.push_back(strut);
   vlist.result.push_back(negbaselineskip);
 
@@ -1019,7 +1057,7 @@ void MathTypesetter::processMatrix(MathList& mlist, MathList::iterator& current)
   vlist.push_back(strut);
   vlist.result.push_back(negbaselineskip);
 
-  auto vbox = tex::vbox(std::move(vlist.result));
+  auto vbox = this->vbox(std::move(vlist.result));
 
   *current = math::Atom::create<math::Atom::Vcent>(vbox);
   rule8_vcent(mlist, current);
@@ -1063,8 +1101,8 @@ void MathTypesetter::processBoundary(MathList& mlist)
   float delta = std::max(h - a, d + a);
 
   float tth = std::max(delimiterfactor * delta / 500.f, 2 * delta - delimitershortfall);
-  auto left = tex::hbox({ typesetDelimiter(cast<math::Boundary>(first)->symbol(), tth) });
-  auto right = tex::hbox({ typesetDelimiter(cast<math::Boundary>(last)->symbol(), tth) });
+  auto left = hbox({ typesetDelimiter(cast<math::Boundary>(first)->symbol(), tth) });
+  auto right = hbox({ typesetDelimiter(cast<math::Boundary>(last)->symbol(), tth) });
   left->setShiftAmount(0.5f * (left->height() - left->depth()) - a);
   right->setShiftAmount(0.5f * (right->height() - right->depth()) - a);
 
@@ -1073,7 +1111,7 @@ void MathTypesetter::processBoundary(MathList& mlist)
 }
 
 
-void MathTypesetter::insertSpace(List& list, const std::shared_ptr<math::Atom>& preceding, const std::shared_ptr<math::Atom>& next)
+void MathTypesetter::insertSpace(List& list, const NodeRef<math::Atom>& preceding, const NodeRef<math::Atom>& next)
 {
   assert(static_cast<int>(preceding->type()) <= math::Atom::Inner);
   assert(static_cast<int>(next->type()) <= math::Atom::Inner);
@@ -1090,22 +1128,22 @@ void MathTypesetter::insertSpace(List& list, const std::shared_ptr<math::Atom>&
     list.push_back(thickmuskip());
 }
 
-std::shared_ptr<Glue> MathTypesetter::thinmuskip()
+NodeRef<Glue> MathTypesetter::thinmuskip()
 {
   const float mu = getMetrics(SigmaFamily).quad() / 18.f;
-  return glue(3 * mu);
+  return make<Glue>(3 * mu, 0.f, 0.f);
 }
 
-std::shared_ptr<Glue> MathTypesetter::medmuskip()
+NodeRef<Glue> MathTypesetter::medmuskip()
 {
   const float mu = getMetrics(SigmaFamily).quad() / 18.f;
-  return glue(4 * mu, tex::Shrink(4 * mu), tex::Stretch(2 * mu));
+  return make<Glue>(4 * mu, 4 * mu, 2 * mu);
 }
 
-std::shared_ptr<Glue> MathTypesetter::thickmuskip()
+NodeRef<Glue> MathTypesetter::thickmuskip()
 {
   const float mu = getMetrics(SigmaFamily).quad() / 18.f;
-  return tex::glue(5 * mu, tex::Stretch(5 * mu));
+  return make<Glue>(5 * mu, 0.f, 5 * mu);
 }
 
 } // namespace tex
@@ -11,17 +11,13 @@ namespace math
 {
 
 Matrix::Matrix(std::vector<MathList> elems, size_t cols)
-  : m_cols(cols), 
+  : Node(NodeKind::Matrix),
+    m_cols(cols), 
     m_elements(std::move(elems))
 {
 
 }
 
-bool Matrix::isMatrix() const
-{
-  return true;
-}
-
 } // namespace math
 
 } // namespace tex
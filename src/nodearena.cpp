@@ -0,0 +1,100 @@
+// Copyright (C) 2020 Vincent Chambrin
+// This file is part of the 'typeset' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "tex/nodearena.h"
+
+#include "tex/node.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace tex
+{
+
+struct NodeArenaStorage
+{
+  size_t refcount = 1;
+  size_t blocksize;
+  std::vector<std::unique_ptr<char[]>> blocks;
+  char* current = nullptr;
+  char* end = nullptr;
+  size_t used = 0;
+};
+
+NodeArena::NodeArena(size_t blocksize)
+  : m_storage(new Storage, &NodeArena::release)
+{
+  m_storage->blocksize = blocksize;
+}
+
+NodeArena::~NodeArena()
+{
+
+}
+
+size_t NodeArena::blockCount() const
+{
+  return m_storage->blocks.size();
+}
+
+size_t NodeArena::bytesUsed() const
+{
+  return m_storage->used;
+}
+
+void* NodeArena::allocate(Storage& storage, size_t size, size_t alignment)
+{
+  auto align_up = [alignment](char* ptr) -> char* {
+    const auto addr = reinterpret_cast<std::uintptr_t>(ptr);
+    return ptr + ((alignment - addr % alignment) % alignment);
+  };
+
+  char* ptr = storage.current != nullptr ? align_up(storage.current) : nullptr;
+
+  if (ptr == nullptr || ptr + size > storage.end)
+  {
+    const size_t capacity = std::max(storage.blocksize, size + alignment);
+    storage.blocks.emplace_back(new char[capacity]);
+    storage.current = storage.blocks.back().get();
+    storage.end = storage.current + capacity;
+    ptr = align_up(storage.current);
+  }
+
+  storage.current = ptr + size;
+  storage.used += size;
+  return ptr;
+}
+
+void NodeArena::release(Storage* storage)
+{
+  if (--storage->refcount == 0)
+    delete storage;
+}
+
+#if defined(LIBTYPESET_INTRUSIVE_REFCOUNT)
+
+void NodeArena::attach(Node& node)
+{
+  node.m_arena = m_storage.get();
+  ++m_storage->refcount;
+}
+
+void Node::destroy() const
+{
+  NodeArenaStorage* storage = m_arena;
+
+  if (!storage)
+  {
+    delete this;
+    return;
+  }
+
+  this->~Node();
+  NodeArena::release(storage);
+}
+
+#endif // defined(LIBTYPESET_INTRUSIVE_REFCOUNT)
+
+} // namespace tex
@@ -0,0 +1,276 @@
+// Copyright (C) 2020 Vincent Chambrin
+// This file is part of the 'typeset' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "tex/pagebuilder.h"
+
+#include "tex/kern.h"
+#include "tex/nodearena.h"
+#include "tex/penalty.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace tex
+{
+
+namespace
+{
+
+constexpr PageBuilder::Cost AwfulBad = MaxDimen;
+constexpr PageBuilder::Cost Deplorable = 100'000;
+
+int page_badness(Dimension t, Dimension s)
+{
+#if defined(LIBTYPESET_SCALED_POINTS)
+  return badness(t, s);
+#else
+  return badness(to_scaled(t), to_scaled(s));
+#endif // defined(LIBTYPESET_SCALED_POINTS)
+}
+
+} // namespace
+
+PageBuilder::PageBuilder()
+  : topskip(make_node<Glue>(10.f, 0.f, 0.f))
+{
+  resetPage();
+}
+
+PageBuilder::PageBuilder(std::function<void(NodeRef<VBox>)> output_)
+  : topskip(make_node<Glue>(10.f, 0.f, 0.f)),
+    output(std::move(output_))
+{
+  resetPage();
+}
+
+PageBuilder::~PageBuilder()
+{
+
+}
+
+/*!
+ * \fn void push_back(const NodeRef<Node>& node)
+ * \brief Contributes a node to the current page
+ *
+ * This may emit one or more pages.
+ * A kern is only processed once the node that follows it is known, since
+ * it is a breakpoint if and only if it is followed by glue.
+ */
+void PageBuilder::push_back(const NodeRef<Node>& node)
+{
+  m_contributions.push_back(node);
+  build();
+}
+
+void PageBuilder::push_back(const List& vlist)
+{
+  m_contributions.insert(m_contributions.end(), vlist.begin(), vlist.end());
+  build();
+}
+
+/*!
+ * \fn void finish()
+ * \brief Emits the last page
+ *
+ * As TeX's \c \\end, this appends \c \\vfill and a forced break to the
+ * contributions, so the last page is filled from the bottom.
+ * Nothing is emitted if the current page has no box.
+ */
+void PageBuilder::finish()
+{
+  m_contributions.push_back(make_node<Glue>(arena.get(), 0.f, 0.f, 1.f, GlueOrder::Normal, GlueOrder::Fill));
+  m_contributions.push_back(make_node<Penalty>(arena.get(), -Penalty::Infinity));
+  build();
+}
+
+/*!
+ * \fn void build()
+ * \brief Moves the contributions to the current page
+ *
+ * This follows TeX's build_page (tex.web, section 994), without insertions.
+ */
+void PageBuilder::build()
+{
+  while (!m_contributions.empty())
+  {
+    const auto p = m_contributions.begin();
+    const Node& node = **p;
+
+    int pi = Penalty::Infinity;
+
+    if (node.isBox())
+    {
+      if (!m_has_box)
+      {
+        // The first box of the page is preceded by topskip
+        m_has_box = true;
+        const float space = std::max(topskip->space() - node.as<Box>().height(), 0.f);
+        m_contributions.push_front(make_node<Glue>(arena.get(), space, topskip->shrink(), topskip->stretch(), topskip->shrinkOrder(), topskip->stretchOrder()));
+        continue;
+      }
+
+      m_total += m_depth + to_dimension(node.as<Box>().height());
+      m_depth = to_dimension(node.as<Box>().depth());
+    }
+    else if (node.isDiscardable())
+    {
+      if (!m_has_box)
+      {
+        m_contributions.pop_front();
+        continue;
+      }
+
+      if (node.isPenalty())
+      {
+        pi = node.as<Penalty>().value();
+      }
+      else if (node.isGlue())
+      {
+        if (!m_page.empty() && !m_page.back()->isDiscardable())
+          pi = 0;
+      }
+      else
+      {
+        auto next = std::next(p);
+
+        if (next == m_contributions.end())
+          return;
+
+        if ((*next)->isGlue())
+          pi = 0;
+      }
+    }
+
+    if (pi < Penalty::Infinity && tryBreak(p, pi))
+      continue;
+
+    if (node.isGlue())
+    {
+      const Glue& glue = node.as<Glue>();
+
+      if (glue.shrinkOrder() != GlueOrder::Normal && glue.shrink() != 0.f)
+        throw std::runtime_error{ "Infinite glue shrinkage found on current page" };
+
+      m_stretch[static_cast<int>(glue.stretchOrder())] += to_dimension(glue.stretch());
+      m_shrink += to_dimension(glue.shrink());
+      m_total += m_depth + to_dimension(glue.space());
+      m_depth = 0;
+    }
+    else if (node.isKern())
+    {
+      m_total += m_depth + to_dimension(node.as<Kern>().space());
+      m_depth = 0;
+    }
+
+    const Dimension max_depth = to_dimension(maxdepth);
+
+    if (m_depth > max_depth)
+    {
+      m_total += m_depth - max_depth;
+      m_depth = max_depth;
+    }
+
+    m_page.splice(m_page.end(), m_contributions, p);
+    statistics.peak = std::max(statistics.peak, m_page.size() + m_contributions.size());
+  }
+}
+
+/*!
+ * \fn bool tryBreak(List::iterator p, int pi)
+ * \brief Computes the cost of breaking the page at the first contribution \a p
+ *
+ * The cost is the badness of the page plus the penalty \a pi of the break;
+ * a page that is too loose costs Deplorable and an overfull page AwfulBad.
+ * If the page is overfull or the break is forced, the page is emitted
+ * with fireUp() and the function returns true.
+ */
+bool PageBuilder::tryBreak(List::iterator p, int pi)
+{
+  const Dimension goal = to_dimension(vsize);
+
+  Cost b;
+
+  if (m_total < goal)
+  {
+    if (m_stretch[1] != 0 || m_stretch[2] != 0 || m_stretch[3] != 0)
+      b = 0;
+    else
+      b = page_badness(goal - m_total, m_stretch[0]);
+  }
+  else if (m_total - goal > m_shrink)
+  {
+    b = AwfulBad;
+  }
+  else
+  {
+    b = page_badness(m_total - goal, m_shrink);
+  }
+
+  Cost c;
+
+  if (b < AwfulBad)
+  {
+    if (pi <= -Penalty::Infinity)
+      c = pi;
+    else if (b < InfBad)
+      c = b + pi;
+    else
+      c = Deplorable;
+  }
+  else
+  {
+    c = b;
+  }
+
+  const bool best = c <= m_least_cost;
+
+  if (best)
+  {
+    m_best = p;
+    m_least_cost = c;
+  }
+
+  if (c == AwfulBad || pi <= -Penalty::Infinity)
+  {
+    // The nodes that follow the best breakpoint go back to the contributions
+    if (!best)
+      m_contributions.splice(m_contributions.begin(), m_page, m_best, m_page.end());
+
+    fireUp();
+    return true;
+  }
+
+  return false;
+}
+
+/*!
+ * \fn void fireUp()
+ * \brief Emits the current page and starts a new one
+ */
+void PageBuilder::fireUp()
+{
+  List page;
+  page.swap(m_page);
+  resetPage();
+
+  ++statistics.pages;
+
+  NodeRef<VBox> box = make_node<VBox>(arena.get(), std::move(page), vsize);
+
+  if (output)
+    output(box);
+}
+
+void PageBuilder::resetPage()
+{
+  m_has_box = false;
+  m_total = 0;
+  m_depth = 0;
+  std::fill(std::begin(m_stretch), std::end(m_stretch), Dimension(0));
+  m_shrink = 0;
+  m_best = m_page.end();
+  m_least_cost = AwfulBad;
+}
+
+} // namespace tex
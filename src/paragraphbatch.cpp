@@ -0,0 +1,199 @@
+// Copyright (C) 2020 Vincent Chambrin
+// This file is part of the 'typeset' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "tex/paragraphbatch.h"
+
+#include "tex/hlistview.h"
+
+#include <algorithm>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace tex
+{
+
+namespace
+{
+
+class TaskQueue
+{
+public:
+  void push(size_t task)
+  {
+    std::lock_guard<std::mutex> lock{ m_mutex };
+    m_tasks.push_back(task);
+  }
+
+  bool pop(size_t& task)
+  {
+    std::lock_guard<std::mutex> lock{ m_mutex };
+
+    if (m_tasks.empty())
+      return false;
+
+    task = m_tasks.back();
+    m_tasks.pop_back();
+    return true;
+  }
+
+  bool steal(size_t& task)
+  {
+    std::lock_guard<std::mutex> lock{ m_mutex };
+
+    if (m_tasks.empty())
+      return false;
+
+    task = m_tasks.front();
+    m_tasks.pop_front();
+    return true;
+  }
+
+private:
+  std::mutex m_mutex;
+  std::deque<size_t> m_tasks;
+};
+
+/*!
+ * \fn void parallel_for(size_t count, size_t threads, F&& f)
+ * \brief Calls \a f for each index in [0, count) on a pool of threads
+ *
+ * Each thread starts with a contiguous range of indices in its own queue and
+ * steals from the other queues once its own is empty.
+ * No task is added once the threads are started, so a thread stops when
+ * all queues are empty.
+ * \a f must not throw.
+ */
+template<typename F>
+void parallel_for(size_t count, size_t threads, F&& f)
+{
+  threads = std::min(threads, count);
+
+  if (threads <= 1)
+  {
+    for (size_t i(0); i < count; ++i)
+      f(i);
+
+    return;
+  }
+
+  std::vector<TaskQueue> queues(threads);
+
+  for (size_t i(0); i < count; ++i)
+    queues[i * threads / count].push(i);
+
+  auto worker = [&](size_t id) {
+    size_t task;
+
+    for (;;)
+    {
+      bool found = queues[id].pop(task);
+
+      for (size_t k(1); !found && k < threads; ++k)
+        found = queues[(id + k) % threads].steal(task);
+
+      if (!found)
+        return;
+
+      f(task);
+    }
+  };
+
+  std::vector<std::thread> pool;
+
+  for (size_t id(1); id < threads; ++id)
+    pool.emplace_back(worker, id);
+
+  worker(0);
+
+  for (std::thread& t : pool)
+    t.join();
+}
+
+} // namespace
+
+/*!
+ * \fn ParagraphBatch(size_t threads)
+ * \brief Creates an empty batch
+ *
+ * If \a threads is 0, the number of hardware threads is used.
+ */
+ParagraphBatch::ParagraphBatch(size_t threads)
+  : m_threads(threads != 0 ? threads : std::max<size_t>(1, std::thread::hardware_concurrency()))
+{
+
+}
+
+ParagraphBatch::~ParagraphBatch()
+{
+
+}
+
+/*!
+ * \fn size_t add(Paragraph paragraph, List hlist)
+ * \brief Adds a paragraph to the batch and returns its index
+ */
+size_t ParagraphBatch::add(Paragraph paragraph, List hlist)
+{
+  m_items.push_back(Item{ std::move(paragraph), std::move(hlist), nullptr, {}, nullptr });
+  return m_items.size() - 1;
+}
+
+/*!
+ * \fn std::vector<List> run()
+ * \brief Breaks all paragraphs of the batch into lines
+ *
+ * The lines of the i-th paragraph are at index i of the result.
+ * If a paragraph cannot be broken, the exception of the first such paragraph
+ * is rethrown.
+ * The batch is empty afterwards.
+ */
+std::vector<List> ParagraphBatch::run()
+{
+  parallel_for(m_items.size(), m_threads, [this](size_t i) {
+    computeBreaks(i);
+  });
+
+  std::vector<Item> items;
+  items.swap(m_items);
+
+  for (const Item& item : items)
+  {
+    if (item.error)
+      std::rethrow_exception(item.error);
+  }
+
+  std::vector<List> result;
+  result.reserve(items.size());
+
+  for (Item& item : items)
+  {
+    if (item.hlist.empty())
+      result.emplace_back();
+    else
+      result.push_back(item.paragraph.create(*item.view, item.breaks, &item.hlist));
+  }
+
+  return result;
+}
+
+void ParagraphBatch::computeBreaks(size_t i)
+{
+  Item& item = m_items[i];
+
+  if (item.hlist.empty())
+    return;
+
+  try
+  {
+    item.view.reset(new HListView(item.hlist));
+    item.breaks = item.paragraph.computeBreaks(*item.view);
+  }
+  catch (...)
+  {
+    item.error = std::current_exception();
+  }
+}
+
+} // namespace tex
@@ -34,12 +34,9 @@ std::vector<Macro> Format::parse(const std::string& src)
 
   std::vector<Macro> result;
 
-  for (const auto& blocks : preproc.macros())
+  for (const auto& e : preproc.macros())
   {
-    for (const auto& e : blocks.macros)
-    {
-      result.push_back(e.second);
-    }
+    result.push_back(e.second);
   }
 
   return result;
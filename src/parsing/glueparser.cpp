@@ -128,7 +128,7 @@ void GlueParser::write(char c) {
   }
 }
 
-std::shared_ptr<Glue> GlueParser::finish() {
+NodeRef<Glue> GlueParser::finish() {
   if (m_state == State::ParsingSpace) {
     Dimen d = m_dimen_parser.finish();
 
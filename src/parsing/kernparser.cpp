@@ -48,7 +48,7 @@ bool KernParser::isFinished()
   return m_state == State::Finished;
 }
 
-std::shared_ptr<Kern> KernParser::finish()
+NodeRef<Kern> KernParser::finish()
 {
   Dimen d = m_dimen_parser.finish();
 
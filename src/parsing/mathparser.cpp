@@ -35,32 +35,32 @@ AtomBuilder::AtomBuilder(math::Atom::Type t)
 
 }
 
-AtomBuilder& AtomBuilder::setNucleus(const std::shared_ptr<Node>& node)
+AtomBuilder& AtomBuilder::setNucleus(const NodeRef<Node>& node)
 {
   nucleus_ = node;
   return *this;
 }
 
-AtomBuilder& AtomBuilder::setSuperscript(const std::shared_ptr<Node>& node)
+AtomBuilder& AtomBuilder::setSuperscript(const NodeRef<Node>& node)
 {
   superscript_ = node;
   return *this;
 }
 
-AtomBuilder& AtomBuilder::setSubscript(const std::shared_ptr<Node>& node)
+AtomBuilder& AtomBuilder::setSubscript(const NodeRef<Node>& node)
 {
   subscript_ = node;
   return *this;
 }
 
-std::shared_ptr<math::Atom> AtomBuilder::build() const
+NodeRef<math::Atom> AtomBuilder::build() const
 {
-  return std::make_shared<math::Atom>(type, nucleus(), subscript(), superscript(), nullptr, math::Atom::NoLimits);
+  return make_node<math::Atom>(type, nucleus(), subscript(), superscript(), nullptr, math::Atom::NoLimits);
 }
 
 MathList& MatrixBuilder::Row::newCell()
 {
-  auto node = std::make_shared<MathListNode>();
+  auto node = make_node<MathListNode>();
   cells.push_back(node);
   return node->list();
 }
@@ -76,7 +76,7 @@ MatrixBuilder::Row& MatrixBuilder::lastRow()
   return rows.back();
 }
 
-std::shared_ptr<Node> MatrixBuilder::build() const
+NodeRef<Node> MatrixBuilder::build() const
 {
   size_t nb_cols = 0;
 
@@ -89,14 +89,14 @@ std::shared_ptr<Node> MatrixBuilder::build() const
 
   for (const Row& r : rows)
   {
-    for (auto node : r.cells)
+    for (const auto& node : r.cells)
       elements.push_back(node->list());
 
     for (size_t i(0); i < (nb_cols - r.cells.size()); ++i)
       elements.emplace_back();
   }
 
-  return std::make_shared<math::Matrix>(std::move(elements), nb_cols);
+  return make_node<math::Matrix>(std::move(elements), nb_cols);
 }
 
 MathParser::MathParser()
@@ -119,7 +119,7 @@ void MathParser::popMatrix()
   m_matrices.pop_back();
 }
 
-void MathParser::writeSymbol(std::shared_ptr<MathSymbol> mathsym)
+void MathParser::writeSymbol(NodeRef<MathSymbol> mathsym)
 {
   switch (state())
   {
@@ -167,7 +167,7 @@ void MathParser::writeSymbol(std::shared_ptr<MathSymbol> mathsym)
   }
 }
 
-void MathParser::writeBox(const std::shared_ptr<tex::Box>& box)
+void MathParser::writeBox(const NodeRef<tex::Box>& box)
 {
   throw std::runtime_error{ "Not implemented" };
 }
@@ -222,21 +222,21 @@ void MathParser::beginMathList()
   }
   else if (state() == State::ParsingSqrtRadicand)
   {
-    auto root = std::dynamic_pointer_cast<math::Root>(mlist().back());
+    auto root = dynamic_pointer_cast<math::Root>(mlist().back());
     enter(State::ParsingSqrtRadicandMList);
     pushList(root->radicand());
     return;
   }
   else if (state() == State::ParsingFracNumer)
   {
-    auto frac = std::dynamic_pointer_cast<math::Fraction>(mlist().back());
+    auto frac = dynamic_pointer_cast<math::Fraction>(mlist().back());
     enter(State::ParsingFracNumerMList);
     pushList(frac->numer());
     return;
   }
   else if (state() == State::ParsingFracDenom)
   {
-    auto frac = std::dynamic_pointer_cast<math::Fraction>(mlist().back());
+    auto frac = dynamic_pointer_cast<math::Fraction>(mlist().back());
     enter(State::ParsingFracDenomMList);
     pushList(frac->denom());
     return;
@@ -392,9 +392,9 @@ void MathParser::popList()
   m_lists.pop_back();
 }
 
-std::shared_ptr<MathListNode> MathParser::pushMathList()
+NodeRef<MathListNode> MathParser::pushMathList()
 {
-  auto ret = std::make_shared<MathListNode>();
+  auto ret = make_node<MathListNode>();
   pushList(ret->list());
   return ret;
 }
@@ -419,7 +419,7 @@ bool MathParser::isParsingMList() const
   }
 }
 
-void MathParser::parse_mlist(std::shared_ptr<MathSymbol> mathsym)
+void MathParser::parse_mlist(NodeRef<MathSymbol> mathsym)
 {
   enter(State::ParsingAtom);
   m_builders.emplace_back();
@@ -427,13 +427,13 @@ void MathParser::parse_mlist(std::shared_ptr<MathSymbol> mathsym)
   m_builders.back().setNucleus(mathsym);
 }
 
-void MathParser::parse_atom(std::shared_ptr<MathSymbol> mathsym)
+void MathParser::parse_atom(NodeRef<MathSymbol> mathsym)
 {
   commitCurrentAtom();
   return writeSymbol(mathsym);
 }
 
-void MathParser::parse_subsupscript(std::shared_ptr<MathSymbol> mathsym)
+void MathParser::parse_subsupscript(NodeRef<MathSymbol> mathsym)
 {
   if (state() == State::AwaitingSubscript)
   {
@@ -447,16 +447,16 @@ void MathParser::parse_subsupscript(std::shared_ptr<MathSymbol> mathsym)
   }
 }
 
-void MathParser::parse_left(std::shared_ptr<MathSymbol> mathsym)
+void MathParser::parse_left(NodeRef<MathSymbol> mathsym)
 {
-  mlist().push_back(std::make_shared<math::Boundary>(mathsym));
+  mlist().push_back(make_node<math::Boundary>(mathsym));
   leave(State::ParsingLeft);
   assert(state() == State::ParsingBoundary);
 }
 
-void MathParser::parse_right(std::shared_ptr<MathSymbol> mathsym)
+void MathParser::parse_right(NodeRef<MathSymbol> mathsym)
 {
-  mlist().push_back(std::make_shared<math::Boundary>(mathsym));
+  mlist().push_back(make_node<math::Boundary>(mathsym));
   leave(State::ParsingRight);
   leave(State::ParsingBoundary);
   leave(State::ParsingNucleus);
@@ -464,12 +464,12 @@ void MathParser::parse_right(std::shared_ptr<MathSymbol> mathsym)
   assert(state() == State::ParsingAtom);
 }
 
-void MathParser::parse_sqrt(std::shared_ptr<MathSymbol> mathsym)
+void MathParser::parse_sqrt(NodeRef<MathSymbol> mathsym)
 {
   if (mathsym->character() == '[')
   {
     enter(State::ParsingSqrtDegree);
-    auto root = std::make_shared<math::Root>();
+    auto root = make_node<math::Root>();
     mlist().push_back(root);
     pushList(root->degree());
   }
@@ -482,7 +482,7 @@ void MathParser::parse_sqrt(std::shared_ptr<MathSymbol> mathsym)
   }
 }
 
-void MathParser::parse_sqrt_degree(std::shared_ptr<MathSymbol> mathsym)
+void MathParser::parse_sqrt_degree(NodeRef<MathSymbol> mathsym)
 {
   if (mathsym->character() == ']')
   {
@@ -496,36 +496,36 @@ void MathParser::parse_sqrt_degree(std::shared_ptr<MathSymbol> mathsym)
   }
 }
 
-void MathParser::parse_sqrt_radicand(std::shared_ptr<MathSymbol> mathsym)
+void MathParser::parse_sqrt_radicand(NodeRef<MathSymbol> mathsym)
 {
   AtomBuilder builder{ math::Atom::Ord }; // @TODO: is-it Ord ?
   builder.setNucleus(mathsym);
 
-  auto root = std::dynamic_pointer_cast<math::Root>(mlist().back());
+  auto root = dynamic_pointer_cast<math::Root>(mlist().back());
   root->radicand().push_back(builder.build());
 
   leave(State::ParsingSqrtRadicand);
   leave(State::ParsingSqrt);
 }
 
-void MathParser::parse_frac_numer(std::shared_ptr<MathSymbol> mathsym)
+void MathParser::parse_frac_numer(NodeRef<MathSymbol> mathsym)
 {
   AtomBuilder builder{ math::Atom::Ord }; // @TODO: is-it Ord ?
   builder.setNucleus(mathsym);
 
-  auto frac = std::dynamic_pointer_cast<math::Fraction>(mlist().back());
+  auto frac = dynamic_pointer_cast<math::Fraction>(mlist().back());
   frac->numer().push_back(builder.build());
 
   leave(State::ParsingFracNumer);
   enter(State::ParsingFracDenom);
 }
 
-void MathParser::parse_frac_denom(std::shared_ptr<MathSymbol> mathsym)
+void MathParser::parse_frac_denom(NodeRef<MathSymbol> mathsym)
 {
   AtomBuilder builder{ math::Atom::Ord }; // @TODO: is-it Ord ?
   builder.setNucleus(mathsym);
 
-  auto frac = std::dynamic_pointer_cast<math::Fraction>(mlist().back());
+  auto frac = dynamic_pointer_cast<math::Fraction>(mlist().back());
   frac->denom().push_back(builder.build());
 
   leave(State::ParsingFracDenom);
@@ -563,7 +563,7 @@ void MathParser::over()
     commitCurrentAtom();
 
   MathList& ml = mlist();
-  auto frac = std::make_shared<math::Fraction>(std::move(ml), MathList{});
+  auto frac = make_node<math::Fraction>(std::move(ml), MathList{});
   ml.clear();
   ml.push_back(frac);
   enter(State::ParsingOver);
@@ -575,7 +575,7 @@ void MathParser::frac()
   if (state() == State::ParsingAtom)
     commitCurrentAtom();
 
-  auto frac = std::make_shared<math::Fraction>();
+  auto frac = make_node<math::Fraction>();
   mlist().push_back(frac);
   enter(State::ParsingFrac);
   enter(State::ParsingFracNumer);
@@ -624,7 +624,7 @@ void MathParser::textstyle()
   if (state() == State::ParsingAtom)
     commitCurrentAtom();
 
-  mlist().push_back(std::make_shared<math::StyleChange>(math::Style::T));
+  mlist().push_back(make_node<math::StyleChange>(math::Style::T));
 }
 
 void MathParser::scriptstyle()
@@ -632,7 +632,7 @@ void MathParser::scriptstyle()
   if (state() == State::ParsingAtom)
     commitCurrentAtom();
 
-  mlist().push_back(std::make_shared<math::StyleChange>(math::Style::S));
+  mlist().push_back(make_node<math::StyleChange>(math::Style::S));
 }
 
 void MathParser::scriptscriptstyle()
@@ -640,7 +640,7 @@ void MathParser::scriptscriptstyle()
   if (state() == State::ParsingAtom)
     commitCurrentAtom();
 
-  mlist().push_back(std::make_shared<math::StyleChange>(math::Style::SS));
+  mlist().push_back(make_node<math::StyleChange>(math::Style::SS));
 }
 
 } // namespace parsing
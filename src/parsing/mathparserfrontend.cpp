@@ -279,7 +279,7 @@ void MathParserFrontend::writeSymbol(Character c)
 
 void MathParserFrontend::writeSymbol(Character c, int class_num, int fam)
 {
-  auto mathsym = std::make_shared<MathSymbol>(Character(c), class_num, fam);
+  auto mathsym = make_node<MathSymbol>(Character(c), class_num, fam);
   parser().writeSymbol(mathsym);
 }
 
@@ -294,16 +294,16 @@ void MathParserFrontend::writeMathChar(Character c, MathCode mc)
     f = fam() != -1 ? fam() : f;
   }
 
-  auto mathsym = std::make_shared<MathSymbol>(c, class_num, f);
+  auto mathsym = make_node<MathSymbol>(c, class_num, f);
   parser().writeSymbol(mathsym);
 }
 
-void MathParserFrontend::writeSymbol(std::shared_ptr<MathSymbol> mathsym)
+void MathParserFrontend::writeSymbol(NodeRef<MathSymbol> mathsym)
 {
   parser().writeSymbol(mathsym);
 }
 
-void MathParserFrontend::writeBox(const std::shared_ptr<tex::Box>& box)
+void MathParserFrontend::writeBox(const NodeRef<tex::Box>& box)
 {
   parser().writeBox(box);
 }
@@ -272,7 +272,41 @@ Preprocessor::State::Frame::~Frame() {
 
 Preprocessor::Preprocessor() {
   m_state.frames.emplace_back(State::Idle);
-  m_defs.push_front(Definitions{});
+}
+
+void Preprocessor::endGroup() {
+  const size_t begin = m_defs.groups.back();
+  m_defs.groups.pop_back();
+
+  while (m_defs.savestack.size() > begin) {
+    SavedMacro &saved = m_defs.savestack.back();
+
+    if (saved.defined)
+      m_defs.macros[saved.csname] = std::move(saved.macro);
+    else
+      m_defs.macros.erase(saved.csname);
+
+    if (saved.level > 0)
+      m_defs.levels[saved.csname] = saved.level;
+    else
+      m_defs.levels.erase(saved.csname);
+
+    m_defs.savestack.pop_back();
+  }
+}
+
+/*!
+ * \fn void reset(Definitions defs)
+ * \brief Discards the pending input and output and replaces the macro definitions
+ *
+ * This is used to restore the preprocessor to a state saved with definitions().
+ */
+void Preprocessor::reset(Definitions defs) {
+  input.clear();
+  output.clear();
+  m_state.frames.clear();
+  m_state.frames.emplace_back(State::Idle);
+  m_defs = std::move(defs);
 }
 
 void Preprocessor::advance() {
@@ -301,19 +335,33 @@ Preprocessor::State::Frame &Preprocessor::currentFrame() {
 }
 
 const Macro *Preprocessor::find(const std::string &cs) const {
-  for (const auto &defscope : m_defs) {
-    auto it = defscope.macros.find(cs);
+  auto it = m_defs.macros.find(cs);
+  return it != m_defs.macros.end() ? &(it->second) : nullptr;
+}
+
+void Preprocessor::define(Macro m) {
+  auto it = m_defs.macros.find(m.controlSequence());
+
+  const size_t level = m_defs.groups.size();
 
-    if (it != defscope.macros.end()) {
-      return &(it->second);
+  if (level > 0) {
+    // Only the meaning from before the group is saved
+    size_t &defined_at = m_defs.levels[m.controlSequence()];
+
+    if (defined_at != level) {
+      if (it != m_defs.macros.end())
+        m_defs.savestack.push_back(SavedMacro{m.controlSequence(), true, it->second, defined_at});
+      else
+        m_defs.savestack.push_back(SavedMacro{m.controlSequence(), false, Macro{}, defined_at});
+
+      defined_at = level;
     }
   }
 
-  return nullptr;
-}
+  if (it == m_defs.macros.end())
+    it = m_defs.macros.emplace(m.controlSequence(), Macro{}).first;
 
-void Preprocessor::define(Macro m) {
-  m_defs.front().macros[m.controlSequence()] = std::move(m);
+  it->second = std::move(m);
 }
 
 void Preprocessor::process(Token &tok) {
@@ -404,7 +452,7 @@ void Preprocessor::readMacro(Token &tok) {
           Macro mdef{std::move(macro_definition.csname),
                      std::move(macro_definition.parameter_text),
                      std::move(macro_definition.replacement_text)};
-          m_defs.front().macros[mdef.controlSequence()] = std::move(mdef);
+          define(std::move(mdef));
           leave();
         } else {
           macro_definition.brace_nesting -= 1;
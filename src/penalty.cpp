@@ -8,19 +8,20 @@ namespace tex
 {
 
 Penalty::Penalty(int val)
-  : mValue(val)
+  : Node(NodeKind::Penalty)
+  , mValue(val)
 {
 
 }
 
-std::shared_ptr<Penalty> penalty(int p)
+NodeRef<Penalty> penalty(int p)
 {
-  return std::make_shared<Penalty>(p);
+  return make_node<Penalty>(p);
 }
 
-std::shared_ptr<Penalty> infinitePenalty()
+NodeRef<Penalty> infinitePenalty()
 {
-  static const std::shared_ptr<Penalty> p = penalty(Penalty::Infinity);
+  static const NodeRef<Penalty> p = penalty(Penalty::Infinity);
   return p;
 }
 
@@ -8,14 +8,14 @@ namespace tex
 {
 
 Rule::Rule(float w, float h, float d)
-  : Box(h, d, w)
+  : Box(NodeKind::Rule, h, d, w)
 {
 
 }
 
-std::shared_ptr<Rule> hrule(float width, float height, float depth)
+NodeRef<Rule> hrule(float width, float height, float depth)
 {
-  return std::make_shared<Rule>(width, height, depth);
+  return make_node<Rule>(width, height, depth);
 }
 
 } // namespace tex
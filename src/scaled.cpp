@@ -0,0 +1,39 @@
+// Copyright (C) 2020 Vincent Chambrin
+// This file is part of the 'typeset' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "tex/scaled.h"
+
+namespace tex
+{
+
+/*!
+ * \fn int badness(Scaled t, Scaled s)
+ * \brief Computes the badness of a box whose glue of total \a s must stretch or shrink by \a t
+ *
+ * This is TeX's integer approximation of 100(t/s)^3 (tex.web, section 108);
+ * \a t must be non-negative and the result is capped to InfBad.
+ */
+int badness(Scaled t, Scaled s)
+{
+  if (t == 0)
+    return 0;
+  else if (s <= 0)
+    return InfBad;
+
+  int r;
+
+  if (t <= 7230584)
+    r = (t * 297) / s; // 297^3 = 99.94 * 2^18
+  else if (s >= 1663497)
+    r = t / (s / 297);
+  else
+    r = t;
+
+  if (r > 1290) // 1290^3 < 2^31 < 1291^3
+    return InfBad;
+
+  return (r * r * r + 0400000) / 01000000;
+}
+
+} // namespace tex
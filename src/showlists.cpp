@@ -5,7 +5,9 @@
 #include "tex/math/mathlist.h"
 
 #include "tex/charbox.h"
+#include "tex/discretionary.h"
 #include "tex/glue.h"
+#include "tex/glyphrun.h"
 #include "tex/hbox.h"
 #include "tex/kern.h"
 #include "tex/symbol.h"
@@ -164,11 +166,42 @@ struct ShowLists {
     }
   }
 
+  void write(const ChildList &list) {
+    for (const auto &n : list) {
+      write(n);
+    }
+  }
+
   void write(const CharacterBox &box) {
     beginLine();
     write(Utf8Char{box.character()}.data());
   }
 
+  void write(const GlyphRun &run) {
+    for (Character c : run.characters()) {
+      beginLine();
+      write(Utf8Char{c}.data());
+    }
+  }
+
+  void write(const Discretionary &disc) {
+    beginLine();
+    write("\\discretionary");
+
+    {
+      RAIIPrefixGuard guard{prefix};
+      write(disc.prebreak());
+    }
+
+    {
+      RAIIPrefixGuard guard{prefix, '|'};
+      write(disc.postbreak());
+    }
+
+    RAIIPrefixGuard guard{prefix, '='};
+    write(disc.nobreak());
+  }
+
   void writeBoxMetrics(const Box &box) {
     write('(');
     write(box.height());
@@ -256,7 +289,7 @@ struct ShowLists {
     write(Utf8Char{msym.character()}.data());
   }
 
-  void write(const std::shared_ptr<Node> &node) {
+  void write(const NodeRef<Node> &node) {
     if (node->isMathSymbol()) {
       write(node->as<tex::MathSymbol>());
     } else if (node->isMathList()) {
@@ -268,6 +301,10 @@ struct ShowLists {
       write(node->as<VBox>());
     } else if (node->isCharacterBox()) {
       write(node->as<CharacterBox>());
+    } else if (node->isGlyphRun()) {
+      write(node->as<GlyphRun>());
+    } else if (node->isDiscretionary()) {
+      write(node->as<Discretionary>());
     } else if (node->isGlue()) {
       write(node->as<Glue>());
     } else if (node->isKern()) {
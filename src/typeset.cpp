@@ -4,11 +4,35 @@
 
 #include "tex/typeset.h"
 
+#include "tex/gluecache.h"
+
 #include "tex/math/style.h"
 
 namespace tex
 {
 
+NodeRef<tex::Box> TypesetEngine::typeset(tex::Character c, tex::Font font, NodeArena& /* arena */)
+{
+  return typeset(c, font);
+}
+
+/*!
+ * \fn const std::shared_ptr<InterwordGlueCache>& interwordGlueCache()
+ * \brief Returns the cache of interword glue shared by the lists built with the engine
+ *
+ * The cache is created on first use, and created again if metrics()
+ * returns another provider.
+ */
+const std::shared_ptr<InterwordGlueCache>& TypesetEngine::interwordGlueCache()
+{
+  std::shared_ptr<FontMetricsProvider> provider = metrics();
+
+  if (!m_gluecache || m_gluecache->metrics() != provider)
+    m_gluecache = std::make_shared<InterwordGlueCache>(std::move(provider));
+
+  return m_gluecache;
+}
+
 Options::Options(const std::shared_ptr<TypesetEngine> & engine)
   : mEngine(engine)
   , mMathStyle(math::Style::T.id())
@@ -5,25 +5,27 @@
 #include "tex/vbox.h"
 
 #include "tex/kern.h"
+#include "tex/nodearena.h"
+#include "tex/visit.h"
 
 #include <algorithm>
 
 namespace tex
 {
 
-VListBuilder::VListBuilder(std::shared_ptr<Glue> baselineskip_, std::shared_ptr<Glue> lineskip_)
+VListBuilder::VListBuilder(NodeRef<Glue> baselineskip_, NodeRef<Glue> lineskip_)
   : baselineskip(baselineskip_),
     lineskip(lineskip_)
 {
 
 }
 
-void VListBuilder::push_back(const std::shared_ptr<Box>& box)
+void VListBuilder::push_back(const NodeRef<Box>& box)
 {
-  push_back(result, box, prevdepth, baselineskip, lineskip, lineskiplimit);
+  push_back(result, box, prevdepth, baselineskip, lineskip, lineskiplimit, arena.get());
 }
 
-void VListBuilder::push_back(List& vlist, const std::shared_ptr<Box>& box, float& prevdepth, const std::shared_ptr<Glue>& baselineskip, const std::shared_ptr<Glue>& lineskip, float lineskiplimit)
+void VListBuilder::push_back(List& vlist, const NodeRef<Box>& box, float& prevdepth, const NodeRef<Glue>& baselineskip, const NodeRef<Glue>& lineskip, float lineskiplimit, NodeArena* arena)
 {
   if (prevdepth <= -10000.f)
   {
@@ -34,7 +36,7 @@ void VListBuilder::push_back(List& vlist, const std::shared_ptr<Box>& box, float
     const float g = baselineskip->space() - prevdepth - box->height();
 
     if (g >= 0.f)
-      vlist.push_back(tex::glue(g, baselineskip->shrinkSpec(), baselineskip->stretchSpec()));
+      vlist.push_back(make_node<Glue>(arena, g, baselineskip->shrink(), baselineskip->stretch(), baselineskip->shrinkOrder(), baselineskip->stretchOrder()));
     else
       vlist.push_back(lineskip);
 
@@ -44,75 +46,62 @@ void VListBuilder::push_back(List& vlist, const std::shared_ptr<Box>& box, float
   prevdepth = box->depth();
 }
 
-void VListBuilder::push_back_node(const std::shared_ptr<Node>& node)
+void VListBuilder::push_back_node(const NodeRef<Node>& node)
 {
   if (node->isBox())
-    push_back(std::static_pointer_cast<tex::Box>(node));
+    push_back(static_pointer_cast<tex::Box>(node));
   else
     result.push_back(node);
 }
 
 VBox::VBox(List && list)
-  : ListBox(std::move(list))
+  : ListBox(NodeKind::VBox, std::move(list))
 {
   rebox_vbox();
 }
 
 VBox::VBox(List && list, float desiredHeight)
-  : ListBox(std::move(list))
+  : ListBox(NodeKind::VBox, std::move(list))
 {
   rebox_vbox(desiredHeight);
 }
 
 VBox::VBox(const BoxMetrics& metrics)
-  : ListBox(metrics)
+  : ListBox(NodeKind::VBox, metrics)
 {
 
 }
 
+void VBox::accumulate(BoxingInfo& info, const Node& node)
+{
+  visit(node, overloaded(
+    [&](const Box& box) {
+      info.height += box.totalHeight();
+      info.width = std::max(box.width(), info.width);
+    },
+    [&](const Kern& kern) {
+      info.height += kern.space();
+    },
+    [&](const Glue& glue) {
+      info.height += glue.space();
+      glue.accumulate(info.shrink, info.stretch);
+    },
+    [](const Node&) { }
+  ));
+}
+
 void VBox::getBoxingInfo(float *width, float *height, float *depth, GlueShrink *shrink, GlueStretch *stretch) const
 {
-  float h = 0;
-  float w = 0;
+  const BoxingInfo& info = totals();
 
-  auto last_box_it = list().end();
-  for (auto it = list().begin(); it != list().end(); ++it)
-  {
-    if ((*it)->isBox())
-    {
-      last_box_it = it;
-      h += std::static_pointer_cast<Box>(*it)->totalHeight();
-      w = std::max(std::static_pointer_cast<Box>(*it)->width(), w);
-    }
-    else if ((*it)->isKern())
-    {
-      h += std::static_pointer_cast<Kern>(*it)->space();
-    }
-    else if ((*it)->isGlue())
-    {
-      auto glue = std::static_pointer_cast<Glue>(*it);
-      h += std::static_pointer_cast<Glue>(*it)->space();
-      glue->accumulate(*shrink, *stretch);
-    }
-  }
+  float h = info.height;
+  float d = 0.f;
 
-  float d;
-  if (last_box_it == list().end())
+  // the depth of the box is the depth of the last node if it is a box
+  if (!list().empty() && list().back()->isBox())
   {
-    d = 0.f;
-  }
-  else
-  {
-    auto it = last_box_it;
-    if (++it != list().end()) // the box is followed by kern or glue
-    {
-      d = 0.f;
-    }
-    else
-    {
-      d = std::static_pointer_cast<Box>(*last_box_it)->depth();
-      h -= d;
-    }
+    d = list().back()->as<Box>().depth();
+    h -= d;
   }
 
   if (height)
@@ -120,12 +109,11 @@ void VBox::getBoxingInfo(float *width, float *height, float *depth, GlueShrink *
   if (depth)
     *depth = d;
   if (width)
-    *width = w;
-}
-
-bool VBox::isVBox() const
-{
-  return true;
+    *width = info.width;
+  if (shrink)
+    static_cast<GlueShrinkStretch&>(*shrink) = *shrink + info.shrink;
+  if (stretch)
+    static_cast<GlueShrinkStretch&>(*stretch) = *stretch + info.stretch;
 }
 
 void VBox::rebox_vbox()
@@ -180,30 +168,30 @@ void VBox::make_vtop()
   float h = height();
   float d = depth();
 
-  float x = (*list().begin())->isBox() ? std::static_pointer_cast<Box>(*list().begin())->height() : 0.f;
+  float x = (*list().begin())->isBox() ? static_pointer_cast<Box>(*list().begin())->height() : 0.f;
   setHeight(x);
   setDepth(h + d - x);
 }
 
 
-std::shared_ptr<VBox> vbox(List && list)
+NodeRef<VBox> vbox(List && list)
 {
-  return std::make_shared<VBox>(std::move(list));
+  return make_node<VBox>(std::move(list));
 }
 
-std::shared_ptr<VBox> vbox(List && list, float h)
+NodeRef<VBox> vbox(List && list, float h)
 {
-  return std::make_shared<VBox>(std::move(list), h);
+  return make_node<VBox>(std::move(list), h);
 }
 
-std::shared_ptr<VBox> vtop(List && list)
+NodeRef<VBox> vtop(List && list)
 {
   auto box = vbox(std::move(list));
   box->make_vtop();
   return box;
 }
 
-std::shared_ptr<VBox> vtop(List && list, float dimh)
+NodeRef<VBox> vtop(List && list, float dimh)
 {
   auto box = vbox(std::move(list), dimh);
   box->make_vtop();
@@ -211,7 +199,8 @@ std::shared_ptr<VBox> vtop(List && list, float dimh)
 }
 
 VBoxEditor::VBoxEditor(VBox & box)
-  : mReboxDone(false)
+  : ListBoxEditor(box)
+  , mReboxDone(false)
   , mVbox(&box)
 {
 
@@ -220,35 +209,37 @@ VBoxEditor::VBoxEditor(VBox & box)
 VBoxEditor::~VBoxEditor()
 {
   if (!mReboxDone)
+  {
+    sync();
     mVbox->rebox_vbox();
-}
-
-List & VBoxEditor::list()
-{
-  return mVbox->mutableList();
+  }
 }
 
 void VBoxEditor::rebox()
 {
   mReboxDone = true;
+  sync();
   mVbox->rebox_vbox();
 }
 
 BoxingResult VBoxEditor::rebox(float desiredHeight)
 {
   mReboxDone = true;
+  sync();
   return mVbox->rebox_vbox(desiredHeight);
 }
 
 void VBoxEditor::rebox_vtop()
 {
   mReboxDone = true;
+  sync();
   mVbox->rebox_vtop();
 }
 
 BoxingResult VBoxEditor::rebox_vtop(float desiredHeight)
 {
   mReboxDone = true;
+  sync();
   return mVbox->rebox_vtop(desiredHeight);
 }
 
@@ -10,10 +10,10 @@ TEST_CASE("Helper functions for creating atoms are working", "[atom]")
 {
   using namespace tex;
 
-  auto x = std::make_shared<Symbol>();
-  auto dot = std::make_shared<Symbol>();
-  auto y = std::make_shared<Symbol>();
-  auto z = std::make_shared<Symbol>();
+  auto x = tex::make_node<Symbol>();
+  auto dot = tex::make_node<Symbol>();
+  auto y = tex::make_node<Symbol>();
+  auto z = tex::make_node<Symbol>();
 
   auto acc = math::Atom::create<math::Atom::Acc>(x, dot);
   REQUIRE(acc->type() == math::Atom::Acc);
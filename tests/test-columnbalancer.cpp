@@ -0,0 +1,169 @@
+// Copyright (C) 2020 Vincent Chambrin
+// This file is part of the typeset project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "catch.hpp"
+
+#include "tex/columnbalancer.h"
+#include "tex/glue.h"
+#include "tex/penalty.h"
+#include "tex/rule.h"
+
+#include <algorithm>
+
+namespace
+{
+
+// Lines of height 8 and depth 2, 12pt apart;
+// a column of n lines is 12n - 4 high
+void push_lines(tex::List& vlist, int count)
+{
+  for (int i(0); i < count; ++i)
+  {
+    if (!vlist.empty() && vlist.back()->isBox())
+      vlist.push_back(tex::make_node<tex::Glue>(2.f, 0.f, 1.f));
+
+    vlist.push_back(tex::hrule(100.f, 8.f, 2.f));
+  }
+}
+
+size_t count_lines(const tex::VBox& column)
+{
+  return std::count_if(column.list().begin(), column.list().end(), [](const tex::NodeRef<tex::Node>& n) {
+    return n->isBox();
+  });
+}
+
+} // namespace
+
+TEST_CASE("ColumnBalancer splits a list into columns", "[columnbalancer]")
+{
+  using namespace tex;
+
+  List vlist;
+  push_lines(vlist, 10);
+
+  ColumnBalancer balancer{ vlist };
+
+  REQUIRE(balancer.size() == 19);
+  REQUIRE(balancer.columnHeight(0, 19) == 116.f);
+  REQUIRE(balancer.computeHeight(1) == 116.f);
+  REQUIRE(balancer.computeHeight(3) == 44.f);
+  REQUIRE(balancer.computeHeight(10) == 8.f);
+  REQUIRE(balancer.computeHeight(12) == 8.f);
+
+  REQUIRE(balancer.computeBreaks(3, 44.f) == std::vector<size_t>{ 7, 15, 19 });
+  REQUIRE(balancer.computeBreaks(2, 80.f) == std::vector<size_t>{ 13, 19 });
+  REQUIRE_THROWS_AS(balancer.computeBreaks(3, 43.f), std::runtime_error);
+  REQUIRE_THROWS_AS(balancer.computeHeight(0), std::runtime_error);
+
+  std::vector<NodeRef<VBox>> columns = balancer.balance(3);
+
+  REQUIRE(columns.size() == 3);
+  REQUIRE(count_lines(*columns.at(0)) == 4);
+  REQUIRE(count_lines(*columns.at(1)) == 4);
+  REQUIRE(count_lines(*columns.at(2)) == 2);
+  REQUIRE(columns.at(2)->height() == 44.f);
+
+  // The glue at the breaks was discarded
+  REQUIRE(columns.at(1)->list()[0]->isBox());
+
+  columns = balancer.balance(12);
+  REQUIRE(columns.size() == 12);
+  REQUIRE(columns.back()->list().size() == 0);
+}
+
+TEST_CASE("ColumnBalancer honours penalties", "[columnbalancer]")
+{
+  using namespace tex;
+
+  List vlist;
+  push_lines(vlist, 2);
+  vlist.push_back(make_node<Penalty>(-10000));
+  push_lines(vlist, 6);
+
+  ColumnBalancer balancer{ vlist };
+
+  REQUIRE(balancer.computeHeight(2) == 68.f);
+  REQUIRE(balancer.computeHeight(3) == 32.f);
+
+  std::vector<NodeRef<VBox>> columns = balancer.balance(2);
+  REQUIRE(count_lines(*columns.at(0)) == 2);
+  REQUIRE(count_lines(*columns.at(1)) == 6);
+
+  // Breaking after the 4th line is forbidden: the first column takes
+  // 5 lines, without glue between the 4th and the 5th
+  vlist.clear();
+  push_lines(vlist, 4);
+  vlist.push_back(make_node<Penalty>(10000));
+  push_lines(vlist, 4);
+
+  REQUIRE(ColumnBalancer{ vlist }.computeHeight(2) == 54.f);
+
+  vlist.clear();
+  push_lines(vlist, 1);
+  vlist.push_back(make_node<Penalty>(-10000));
+  push_lines(vlist, 1);
+  vlist.push_back(make_node<Penalty>(-10000));
+  push_lines(vlist, 1);
+
+  REQUIRE_THROWS_AS(ColumnBalancer{ vlist }.computeHeight(2), std::runtime_error);
+  REQUIRE(ColumnBalancer{ vlist }.computeHeight(3) == 8.f);
+
+  REQUIRE(ColumnBalancer{ List{} }.computeHeight(2) == 0.f);
+}
+
+TEST_CASE("ColumnBalancer balances long lists", "[columnbalancer]")
+{
+  using namespace tex;
+
+  List vlist;
+  push_lines(vlist, 1000);
+
+  ColumnBalancer balancer{ vlist };
+
+  const float height = balancer.computeHeight(7);
+  REQUIRE(height == 12.f * 143 - 4);
+
+  std::vector<size_t> breaks = balancer.computeBreaks(7, height);
+  REQUIRE(breaks.size() == 7);
+  REQUIRE(breaks.back() == balancer.size());
+  REQUIRE(balancer.columnHeight(0, breaks.front()) == height);
+}
+
+TEST_CASE("ColumnBalancer finds the exact minimal height", "[columnbalancer]")
+{
+  using namespace tex;
+
+  // Lines of irregular heights, separated by glue that is not a whole number of points
+  List vlist;
+  unsigned seed = 3;
+
+  for (int i(0); i < 40; ++i)
+  {
+    seed = seed * 1103515245 + 12345;
+    const float height = 5.f + static_cast<float>((seed >> 16) % 100) / 16.f;
+
+    if (!vlist.empty())
+      vlist.push_back(make_node<Glue>(1.1f, 0.f, 1.f));
+
+    vlist.push_back(hrule(100.f, height, 1.3f));
+  }
+
+  ColumnBalancer balancer{ vlist };
+
+  for (size_t columns : { 2, 3, 5, 8 })
+  {
+    const float height = balancer.computeHeight(columns);
+
+    // The columns fit at that height, but not at any smaller one
+    std::vector<size_t> breaks = balancer.computeBreaks(columns, height);
+    REQUIRE(breaks.size() <= columns);
+    REQUIRE(breaks.back() == balancer.size());
+    REQUIRE_THROWS_AS(balancer.computeBreaks(columns, height - 0.01f), std::runtime_error);
+
+    std::vector<NodeRef<VBox>> boxes = balancer.balance(columns);
+    REQUIRE(boxes.size() == columns);
+    REQUIRE(boxes.front()->height() == Approx(height));
+  }
+}
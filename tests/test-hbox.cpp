@@ -0,0 +1,122 @@
+// Copyright (C) 2020 Vincent Chambrin
+// This file is part of the typeset project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "catch.hpp"
+
+#include "tex/discretionary.h"
+#include "tex/glue.h"
+#include "tex/hbox.h"
+#include "tex/hlistview.h"
+#include "tex/kern.h"
+#include "tex/layoutreader.h"
+#include "tex/vbox.h"
+
+#include <vector>
+
+#include "test-typeset.h"
+
+TEST_CASE("ListBox children can be edited", "[hbox]")
+{
+  using namespace tex;
+
+  auto box = hbox({ kern(1.f), kern(2.f) });
+  REQUIRE(box->list().size() == 2);
+  REQUIRE(box->width() == 3.f);
+
+  {
+    HBoxEditor editor{ *box };
+    editor.list().push_front(kern(3.f));
+    editor.list().push_back(kern(4.f));
+    editor.list().push_back(kern(5.f));
+  }
+
+  REQUIRE(box->list().size() == 5);
+  REQUIRE(box->list().front()->as<Kern>().space() == 3.f);
+  REQUIRE(box->width() == 15.f);
+}
+
+TEST_CASE("ListBox editors keep the cached totals up-to-date", "[hbox]")
+{
+  using namespace tex;
+
+  auto box = hbox({ kern(1.f), make_node<Glue>(2.f, 0.f, 1.f) });
+  REQUIRE(box->totals().width == 3.f);
+  REQUIRE(box->totals().stretch.normal == 1.f);
+
+  {
+    HBoxEditor editor{ *box };
+    editor.push_back(make_node<Glue>(0.f, 0.f, 1.f, GlueOrder::Normal, GlueOrder::Fil));
+    editor.push_front(kern(4.f));
+    REQUIRE(box->totals().width == 7.f);
+    REQUIRE(box->totals().stretch.fil == 1.f);
+    REQUIRE(editor.rebox(10.f) == BoxingResult::NormalBox);
+  }
+
+  REQUIRE(box->width() == 10.f);
+  REQUIRE(box->glueOrder() == GlueOrder::Fil);
+  REQUIRE(box->glueRatio() == 3.f);
+
+  {
+    HBoxEditor editor{ *box };
+    editor.erase(box->list().begin());
+    REQUIRE(box->totals().width == 3.f);
+    editor.erase(box->list().end() - 1);
+    editor.rebox();
+  }
+
+  REQUIRE(box->totals().stretch.fil == 0.f);
+  REQUIRE(box->width() == 3.f);
+
+  auto v = vbox({ hbox({ kern(2.f) }), kern(1.f) });
+  {
+    VBoxEditor editor{ *v };
+    editor.push_back(make_node<TestBox>(BoxMetrics{ 2.f, 1.f, 5.f }));
+  }
+
+  REQUIRE(v->width() == 5.f);
+  REQUIRE(v->height() == 3.f);
+  REQUIRE(v->depth() == 1.f);
+}
+
+TEST_CASE("Discretionaries are measured and read with their no-break material", "[hbox]")
+{
+  using namespace tex;
+
+  auto nobreak = make_node<TestBox>(BoxMetrics{ 3.f, 2.f, 5.f });
+
+  List hlist;
+  hlist.push_back(make_node<TestBox>(BoxMetrics{ 2.f, 1.f, 1.f }));
+  hlist.push_back(discretionary({ make_node<TestBox>(BoxMetrics{ 9.f, 9.f, 9.f }) }, {}, { kern(1.f), nobreak }));
+  hlist.push_back(make_node<TestBox>(BoxMetrics{ 0.f, 1.f, 8.f }));
+
+  BoxingInfo expected;
+  HListView{ hlist }.getBoxingInfo(0, hlist.size(), expected);
+
+  auto box = hbox(List{ hlist });
+  REQUIRE(box->width() == 15.f);
+  REQUIRE(box->height() == 3.f);
+  REQUIRE(box->depth() == 2.f);
+  REQUIRE(box->width() == expected.width);
+  REQUIRE(box->height() == expected.height);
+  REQUIRE(box->depth() == expected.depth);
+
+  std::vector<float> positions;
+
+  read([&positions](const NodeRef<Box>& b, Pos pos) {
+    if (!b->isHBox())
+      positions.push_back(pos.x);
+    }, box, Pos{ 0.f, 0.f });
+
+  REQUIRE(positions == std::vector<float>{ 0.f, 2.f, 7.f });
+
+  size_t visited = 0;
+
+  read([&visited, &nobreak](const NodeRef<Box>& b, Pos pos) -> bool {
+    if (!b->isHBox())
+      ++visited;
+    return b == nobreak;
+    }, box, Pos{ 0.f, 0.f });
+
+  REQUIRE(visited == 2);
+}
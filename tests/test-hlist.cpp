@@ -0,0 +1,123 @@
+// Copyright (C) 2020 Vincent Chambrin
+// This file is part of the typeset project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "catch.hpp"
+
+#include "tex/glue.h"
+#include "tex/gluecache.h"
+#include "tex/glyphrun.h"
+#include "tex/hlist.h"
+
+#include "test-typeset.h"
+
+namespace
+{
+
+class MutableFontMetricsProvider : public TestFontMetricsProvider
+{
+public:
+  tex::FontDimen dimen = TestFontMetricsProvider::fontdimen(tex::Font(0));
+
+  const tex::FontDimen& fontdimen(tex::Font) override { return dimen; }
+};
+
+} // namespace
+
+TEST_CASE("HListBuilder interns interword glue", "[hlist]")
+{
+  using namespace tex;
+
+  auto engine = std::make_shared<TestTypesetEngine>();
+  HListBuilder builder{ engine };
+
+  builder.push_back(Character('a'));
+  builder.push_back_interword_glue();
+  builder.push_back(Character('b'));
+  builder.push_back_interword_glue();
+
+  REQUIRE(builder.result.size() == 4);
+
+  auto first = std::next(builder.result.begin());
+  auto second = std::next(first, 2);
+  REQUIRE((*first)->isGlue());
+  REQUIRE(*first == *second);
+  REQUIRE(builder.gluecache->size() == 1);
+
+  builder.spacefactor = 3000;
+  builder.push_back_interword_glue();
+  REQUIRE(builder.result.back() != *first);
+  REQUIRE(builder.result.back()->as<Glue>().space() > (*first)->as<Glue>().space());
+  REQUIRE(builder.gluecache->size() == 2);
+
+  // The cache belongs to the engine and is shared by its builders
+  HListBuilder other{ engine };
+  REQUIRE(other.gluecache == builder.gluecache);
+  REQUIRE(other.gluecache == engine->interwordGlueCache());
+
+  other.push_back(Character('c'));
+  other.push_back_interword_glue();
+  REQUIRE(other.result.back() == *first);
+  REQUIRE(engine->interwordGlueCache()->size() == 2);
+}
+
+TEST_CASE("InterwordGlueCache is invalidated when the FontDimen changes", "[hlist]")
+{
+  using namespace tex;
+
+  auto metrics = std::make_shared<MutableFontMetricsProvider>();
+  InterwordGlueCache cache{ metrics };
+
+  auto g = cache.get(Font(0), 1000);
+  REQUIRE(g->space() == metrics->dimen.interword_space);
+  REQUIRE(cache.get(Font(0), 1000) == g);
+
+  metrics->dimen.interword_space *= 2.f;
+
+  auto h = cache.get(Font(0), 1000);
+  REQUIRE(h != g);
+  REQUIRE(h->space() == metrics->dimen.interword_space);
+  REQUIRE(cache.size() == 1);
+
+  cache.invalidate(Font(0));
+  REQUIRE(cache.size() == 0);
+  REQUIRE(cache.get(Font(0), 1000) != h);
+}
+
+TEST_CASE("HListBuilder gathers characters in glyph runs", "[hlist]")
+{
+  using namespace tex;
+
+  auto engine = std::make_shared<TestTypesetEngine>();
+  HListBuilder builder{ engine };
+
+  for (char c : std::string("abc"))
+    builder.push_back(Character(c));
+  builder.push_back_interword_glue();
+  builder.push_back(Character('d'));
+  builder.font = Font(1);
+  builder.push_back(Character('e'));
+
+  REQUIRE(builder.result.size() == 4);
+  REQUIRE(builder.result.front()->isGlyphRun());
+  REQUIRE(builder.result.front()->isBox());
+
+  const GlyphRun& run = builder.result.front()->as<GlyphRun>();
+  REQUIRE(run.size() == 3);
+  REQUIRE(run.character(1) == 'b');
+  REQUIRE(run.width() == 6.f);
+  REQUIRE(run.height() == 2.f);
+  REQUIRE(run.depth() == 1.f);
+
+  REQUIRE(builder.result.back()->as<GlyphRun>().font() == Font(1));
+
+  auto tail = run.slice(1, 3);
+  REQUIRE(tail->size() == 2);
+  REQUIRE(tail->character(0) == 'b');
+  REQUIRE(tail->width() == 4.f);
+
+  builder.glyphruns = false;
+  builder.push_back(Character('f'));
+  REQUIRE(builder.result.size() == 5);
+  REQUIRE(!builder.result.back()->isGlyphRun());
+}
@@ -0,0 +1,139 @@
+// Copyright (C) 2020 Vincent Chambrin
+// This file is part of the typeset project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "catch.hpp"
+
+#include "tex/discretionary.h"
+#include "tex/glyphrun.h"
+#include "tex/hlist.h"
+#include "tex/hyphenation.h"
+
+#include "test-typeset.h"
+
+TEST_CASE("Hyphenator applies Liang patterns", "[hyphenation]")
+{
+  using namespace tex;
+
+  Hyphenator hyphenator;
+  hyphenator.addPatterns("a1b xa2b .ab1c");
+
+  // root, a, x, ., ab, xa, .a, xab, .ab, .abc
+  REQUIRE(hyphenator.patternCount() == 3);
+  REQUIRE(hyphenator.trieSize() == 10);
+
+  REQUIRE(hyphenator.hyphenate("yyabyxabyyy") == std::vector<size_t>{ 3 });
+  REQUIRE(hyphenator.hyphenate("abcabc") == std::vector<size_t>{ 2 });
+  REQUIRE(hyphenator.hyphenate("ABCABC") == std::vector<size_t>{ 2 });
+  REQUIRE(hyphenator.hyphenate("ab").empty());
+
+  hyphenator.lefthyphenmin = 4;
+  hyphenator.clearCache();
+  REQUIRE(hyphenator.hyphenate("yyabyxabyyy").empty());
+}
+
+TEST_CASE("Hyphenator exceptions and cache", "[hyphenation]")
+{
+  using namespace tex;
+
+  Hyphenator hyphenator;
+  hyphenator.addPatterns("a1b");
+
+  REQUIRE(hyphenator.hyphenate("tbaab").empty());
+  REQUIRE(hyphenator.hyphenate("xxabxxx") == std::vector<size_t>{ 3 });
+  REQUIRE(hyphenator.cacheSize() == 2);
+
+  REQUIRE(hyphenator.hyphenate("xxabxxx") == std::vector<size_t>{ 3 });
+  REQUIRE(hyphenator.cacheSize() == 2);
+
+  hyphenator.addException("xxab-xxx");
+  REQUIRE(hyphenator.cacheSize() == 0);
+  REQUIRE(hyphenator.hyphenate("xxabxxx") == std::vector<size_t>{ 4 });
+  REQUIRE(hyphenator.hyphenate("XXABXXX") == std::vector<size_t>{ 4 });
+
+  hyphenator.addPatterns("x1x");
+  REQUIRE(hyphenator.cacheSize() == 0);
+  REQUIRE(hyphenator.hyphenate("yxxabyy") == std::vector<size_t>{ 2, 4 });
+  REQUIRE(hyphenator.hyphenate("xxabxxx") == std::vector<size_t>{ 4 });
+}
+
+TEST_CASE("Hyphenator reads TeX pattern files", "[hyphenation]")
+{
+  using namespace tex;
+
+  Hyphenator hyphenator;
+  hyphenator.addPatterns("% Test patterns\n"
+    "\\patterns{ a1b\n"
+    "xa2b } \n"
+    "\\hyphenation{ xxab-xxx }\n");
+
+  REQUIRE(hyphenator.patternCount() == 2);
+  REQUIRE(hyphenator.hyphenate("yyabyxabyyy") == std::vector<size_t>{ 3 });
+  REQUIRE(hyphenator.hyphenate("xxabxxx") == std::vector<size_t>{ 4 });
+
+  REQUIRE_THROWS_AS(hyphenator.load("test-hyphenation-missing-patterns.tex"), std::runtime_error);
+}
+
+TEST_CASE("Hyphenator recognizes letters", "[hyphenation]")
+{
+  using namespace tex;
+
+  for (Character c : std::vector<Character>{ 'a', 'Z', 0xE9, 0xFF, 0x153, 0x3B1, 0x3C9, 0x416, 0x1E9E })
+    REQUIRE(Hyphenator::isLetter(c));
+
+  // Digits, punctuation, signs and combining marks
+  for (Character c : std::vector<Character>{ '0', '-', '\'', 0xA0, 0xAB, 0xD7, 0xF7, 0x301, 0x2013, 0x2019 })
+    REQUIRE(!Hyphenator::isLetter(c));
+}
+
+TEST_CASE("HListBuilder inserts discretionaries", "[hyphenation]")
+{
+  using namespace tex;
+
+  auto engine = std::make_shared<TestTypesetEngine>();
+
+  HListBuilder builder{ engine };
+  builder.hyphenator = std::make_shared<Hyphenator>();
+  builder.hyphenator->addPatterns("a1b");
+
+  for (char c : std::string("(xxabxxx),"))
+    builder.push_back(Character(c));
+
+  builder.push_back_interword_glue();
+
+  List& hlist = builder.result;
+
+  REQUIRE(hlist.size() == 4);
+
+  auto it = hlist.begin();
+  REQUIRE((*it)->as<GlyphRun>().size() == 4);
+  REQUIRE((*++it)->isDiscretionary());
+  REQUIRE((*it)->as<Discretionary>().prebreak().front()->as<GlyphRun>().character(0) == '-');
+  REQUIRE((*it)->as<Discretionary>().prebreakWidth() == 2.f);
+  REQUIRE((*++it)->as<GlyphRun>().size() == 6);
+  REQUIRE((*++it)->isGlue());
+}
+
+TEST_CASE("HListBuilder hyphenates the last word when the list is finished", "[hyphenation]")
+{
+  using namespace tex;
+
+  auto engine = std::make_shared<TestTypesetEngine>();
+
+  HListBuilder builder{ engine };
+  builder.hyphenator = std::make_shared<Hyphenator>();
+  builder.hyphenator->addPatterns("a1b");
+
+  for (char c : std::string("xxabxxx"))
+    builder.push_back(Character(c));
+
+  REQUIRE(builder.result.size() == 1);
+
+  builder.finish();
+  REQUIRE(builder.result.size() == 3);
+  REQUIRE((*std::next(builder.result.begin()))->isDiscretionary());
+
+  // The word is not hyphenated again
+  builder.finish();
+  REQUIRE(builder.result.size() == 3);
+}
@@ -0,0 +1,194 @@
+// Copyright (C) 2020 Vincent Chambrin
+// This file is part of the typeset project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "catch.hpp"
+
+#include "tex/hlist.h"
+#include "tex/layoutcache.h"
+
+#include "test-typeset.h"
+
+#include <algorithm>
+
+namespace
+{
+
+tex::List prepared_paragraph(std::shared_ptr<TestTypesetEngine> engine, int words, char letter = 'a')
+{
+  tex::List hlist = build_paragraph(engine, words, letter);
+  tex::Paragraph{}.prepare(hlist);
+  return hlist;
+}
+
+// Gives access to the entries, to simulate collisions of the keys
+class CollidingLayoutCache : public tex::LayoutCache
+{
+public:
+  using LayoutCache::Check;
+  using LayoutCache::hash;
+  using LayoutCache::insert;
+};
+
+} // namespace
+
+TEST_CASE("LayoutCache returns the lines of known paragraphs", "[layoutcache]")
+{
+  using namespace tex;
+
+  auto engine = std::make_shared<TestTypesetEngine>();
+
+  LayoutCache cache;
+
+  Paragraph paragraph;
+  paragraph.hsize = 60.f;
+
+  const List hlist = prepared_paragraph(engine, 60);
+
+  const LayoutCache::Key key = LayoutCache::hash(paragraph, hlist);
+
+  Paragraph reference = paragraph;
+  const List expected = reference.create(hlist);
+
+  List lines = cache.create(paragraph, hlist);
+  REQUIRE(cache.statistics.misses == 1);
+  REQUIRE(cache.size() == 1);
+  REQUIRE(cache.bytes() == LayoutCache::footprint(lines));
+  REQUIRE(cache.contains(key));
+  REQUIRE(lines.size() == expected.size());
+
+  // prevdepth is part of the key and is set by create()
+  REQUIRE(paragraph.prevdepth == reference.prevdepth);
+  paragraph.prevdepth = -10000.f;
+
+  List again = cache.create(paragraph, prepared_paragraph(engine, 60));
+  REQUIRE(cache.statistics.hits == 1);
+  REQUIRE(std::equal(again.begin(), again.end(), lines.begin()));
+  REQUIRE(paragraph.prevdepth == reference.prevdepth);
+
+  // Changing the text or the parameters is a miss
+  paragraph.prevdepth = -10000.f;
+  cache.create(paragraph, prepared_paragraph(engine, 60, 'b'));
+  REQUIRE(cache.statistics.misses == 2);
+
+  paragraph.prevdepth = -10000.f;
+  paragraph.hsize = 50.f;
+  cache.create(paragraph, hlist);
+  REQUIRE(cache.statistics.misses == 3);
+  REQUIRE(cache.size() == 3);
+
+  paragraph.prevdepth = -10000.f;
+  paragraph.hsize = 60.f;
+  REQUIRE(LayoutCache::hash(paragraph, hlist) == key);
+  paragraph.rightskip = make_node<Glue>(0.f, 0.f, 1.f);
+  REQUIRE(LayoutCache::hash(paragraph, hlist) != key);
+
+  cache.clear();
+  REQUIRE(cache.size() == 0);
+  REQUIRE(cache.bytes() == 0);
+}
+
+TEST_CASE("LayoutCache evicts the least recently used paragraphs", "[layoutcache]")
+{
+  using namespace tex;
+
+  auto engine = std::make_shared<TestTypesetEngine>();
+
+  std::vector<List> paragraphs;
+
+  for (char c : std::string("abcd"))
+    paragraphs.push_back(prepared_paragraph(engine, 40, c));
+
+  Paragraph paragraph;
+  paragraph.hsize = 60.f;
+
+  auto key = [&paragraph](const List& hlist) {
+    Paragraph p = paragraph;
+    p.prevdepth = -10000.f;
+    return LayoutCache::hash(p, hlist);
+  };
+
+  auto create = [&paragraph](LayoutCache& cache, const List& hlist) {
+    paragraph.prevdepth = -10000.f;
+    return cache.create(paragraph, hlist);
+  };
+
+  LayoutCache cache;
+  const size_t bytes = LayoutCache::footprint(create(cache, paragraphs.at(0)));
+
+  // Room for about 3 paragraphs of the same size
+  cache.clear();
+  cache.setBudget(3 * bytes + bytes / 2);
+
+  create(cache, paragraphs.at(0));
+  create(cache, paragraphs.at(1));
+  create(cache, paragraphs.at(2));
+  REQUIRE(cache.size() == 3);
+
+  create(cache, paragraphs.at(0));
+  create(cache, paragraphs.at(3));
+
+  REQUIRE(cache.size() == 3);
+  REQUIRE(cache.statistics.evictions == 1);
+  REQUIRE(cache.bytes() <= cache.budget());
+  REQUIRE(cache.contains(key(paragraphs.at(0))));
+  REQUIRE(!cache.contains(key(paragraphs.at(1))));
+  REQUIRE(cache.contains(key(paragraphs.at(3))));
+
+  cache.setBudget(bytes + bytes / 2);
+  REQUIRE(cache.size() == 1);
+  REQUIRE(cache.contains(key(paragraphs.at(3))));
+
+  // Lines larger than the budget are not cached
+  cache.setBudget(bytes / 2);
+  REQUIRE(create(cache, paragraphs.at(2)).size() > 0);
+  REQUIRE(cache.size() == 0);
+}
+
+TEST_CASE("LayoutCache does not trust a key alone", "[layoutcache]")
+{
+  using namespace tex;
+
+  auto engine = std::make_shared<TestTypesetEngine>();
+
+  CollidingLayoutCache cache;
+
+  Paragraph paragraph;
+  paragraph.hsize = 60.f;
+
+  const List hlist = prepared_paragraph(engine, 60);
+  const List other = prepared_paragraph(engine, 40, 'b');
+
+  CollidingLayoutCache::Check check;
+  const LayoutCache::Key key = CollidingLayoutCache::hash(paragraph, hlist, check);
+
+  CollidingLayoutCache::Check other_check;
+  CollidingLayoutCache::hash(paragraph, other, other_check);
+  REQUIRE(other_check.hash != check.hash);
+  REQUIRE(other_check.nodes != check.nodes);
+
+  // The lines of another paragraph are stored under the key of hlist
+  Paragraph p = paragraph;
+  const List wrong = p.create(other);
+  cache.insert(key, other_check, wrong, p);
+  REQUIRE(cache.contains(key));
+
+  Paragraph reference = paragraph;
+  const List expected = reference.create(hlist);
+  REQUIRE(wrong.size() != expected.size());
+
+  List lines = cache.create(paragraph, hlist);
+  REQUIRE(cache.statistics.collisions == 1);
+  REQUIRE(cache.statistics.misses == 1);
+  REQUIRE(cache.statistics.hits == 0);
+  REQUIRE(lines.size() == expected.size());
+
+  // The colliding entry was replaced
+  REQUIRE(cache.size() == 1);
+  REQUIRE(cache.bytes() == LayoutCache::footprint(lines));
+
+  paragraph.prevdepth = -10000.f;
+  cache.create(paragraph, hlist);
+  REQUIRE(cache.statistics.hits == 1);
+  REQUIRE(cache.statistics.collisions == 1);
+}
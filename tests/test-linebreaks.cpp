@@ -0,0 +1,662 @@
+// Copyright (C) 2020 Vincent Chambrin
+// This file is part of the typeset project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "catch.hpp"
+
+#include "tex/discretionary.h"
+#include "tex/glue.h"
+#include "tex/glyphrun.h"
+#include "tex/hbox.h"
+#include "tex/hlist.h"
+#include "tex/hlistview.h"
+#include "tex/hyphenation.h"
+#include "tex/linebreaks.h"
+#include "tex/paragraphbatch.h"
+#include "tex/penalty.h"
+
+#include "test-typeset.h"
+
+#include <algorithm>
+
+TEST_CASE("Paragraph can consume its horizontal list", "[linebreaks]")
+{
+  using namespace tex;
+
+  auto engine = std::make_shared<TestTypesetEngine>();
+
+  Paragraph paragraph;
+  paragraph.hsize = 60.f;
+  Paragraph other = paragraph;
+
+  List hlist = build_paragraph(engine, 60);
+  paragraph.prepare(hlist);
+
+  List copied = other.create(hlist);
+  const NodeRef<Node> first = hlist.front();
+  const long use_count = first.use_count();
+
+  List consumed = paragraph.create(std::move(hlist));
+
+  REQUIRE(hlist.empty());
+  REQUIRE(first.use_count() == use_count);
+  REQUIRE(consumed.size() == copied.size());
+
+  for (auto it = consumed.begin(), jt = copied.begin(); it != consumed.end(); ++it, ++jt)
+  {
+    REQUIRE((*it)->kind() == (*jt)->kind());
+
+    if ((*it)->isHBox())
+    {
+      const HBox& a = (*it)->as<HBox>();
+      const HBox& b = (*jt)->as<HBox>();
+      REQUIRE(a.width() == b.width());
+      REQUIRE(a.glueRatio() == b.glueRatio());
+      REQUIRE(a.list().size() == b.list().size());
+      REQUIRE(std::equal(a.list().begin(), a.list().end(), b.list().begin()));
+    }
+  }
+}
+
+TEST_CASE("Integer badness and demerits", "[linebreaks]")
+{
+  using namespace tex;
+
+  REQUIRE(to_scaled(1.f) == ScaledUnity);
+  REQUIRE(to_scaled(-0.5f) == -ScaledUnity / 2);
+  REQUIRE(from_scaled(3 * ScaledUnity) == 3.f);
+
+  const Scaled s = to_scaled(4.f);
+  REQUIRE(badness(0, s) == 0);
+  REQUIRE(badness(s, 0) == InfBad);
+  REQUIRE(badness(s / 2, s) == 12);
+  REQUIRE(badness(s, s) == 100);
+  REQUIRE(badness(2 * s, s) == 800);
+  REQUIRE(badness(100 * s, s) == InfBad);
+
+  REQUIRE(Paragraph::computeDemerits(10, 100, 50) == 14600);
+  REQUIRE(Paragraph::computeDemerits(10, 100, -50) == 9600);
+  REQUIRE(Paragraph::computeDemerits(10, 100, -10000) == 12100);
+}
+
+TEST_CASE("Index-based linebreaking matches the breakpoint list", "[linebreaks]")
+{
+  using namespace tex;
+
+  auto engine = std::make_shared<TestTypesetEngine>();
+
+  for (float hsize : { 40.f, 60.f, 90.f })
+  {
+    Paragraph paragraph;
+    paragraph.hsize = hsize;
+
+    List hlist = build_paragraph(engine, 80);
+    paragraph.prepare(hlist);
+    HListView view{ hlist };
+
+    std::vector<Paragraph::Breakpoint> breakpoints = paragraph.computeBreakpoints(view);
+    std::vector<size_t> breaks = paragraph.computeBreaks(view);
+
+    REQUIRE(breaks.size() + 1 == breakpoints.size());
+
+    for (size_t i(0); i < breaks.size(); ++i)
+      REQUIRE(view.position(breaks.at(i)) == breakpoints.at(i + 1).position);
+
+    REQUIRE(breaks.back() == view.size() - 1);
+  }
+}
+
+TEST_CASE("Linebreaking uses a first pass with pretolerance", "[linebreaks]")
+{
+  using namespace tex;
+
+  auto engine = std::make_shared<TestTypesetEngine>();
+
+  List hlist = build_paragraph(engine, 80);
+  Paragraph{}.prepare(hlist);
+  HListView view{ hlist };
+
+  Paragraph paragraph;
+  paragraph.hsize = 90.f;
+
+  Paragraph single = paragraph;
+  single.pretolerance = -1;
+
+  Paragraph first = single;
+  first.tolerance = paragraph.pretolerance;
+
+  REQUIRE(paragraph.computeBreaks(view) == first.computeBreaks(view));
+  REQUIRE(paragraph.statistics.firstpass == 1);
+  REQUIRE(paragraph.statistics.secondpass == 0);
+
+  // No line has its natural width, the first pass fails
+  paragraph.pretolerance = 0.f;
+  REQUIRE(paragraph.computeBreaks(view) == single.computeBreaks(view));
+  REQUIRE(paragraph.statistics.firstpass == 1);
+  REQUIRE(paragraph.statistics.secondpass == 1);
+
+  paragraph.computeBreakpoints(view);
+  REQUIRE(paragraph.statistics.secondpass == 2);
+
+  paragraph.pretolerance = 1.f;
+  paragraph.computeBreaks(view, std::vector<float>{ 60.f, 90.f, 200.f });
+  REQUIRE(paragraph.statistics.firstpass + paragraph.statistics.secondpass == 6);
+}
+
+TEST_CASE("Paragraph can be broken for several hsize at once", "[linebreaks]")
+{
+  using namespace tex;
+
+  auto engine = std::make_shared<TestTypesetEngine>();
+
+  Paragraph paragraph;
+
+  List hlist = build_paragraph(engine, 150);
+  paragraph.prepare(hlist);
+  HListView view{ hlist };
+
+  const std::vector<float> hsizes{ 40.f, 55.f, 60.f, 90.f, 200.f };
+  std::vector<std::vector<size_t>> result = paragraph.computeBreaks(view, hsizes);
+
+  REQUIRE(result.size() == hsizes.size());
+
+  for (size_t k(0); k < hsizes.size(); ++k)
+  {
+    Paragraph single = paragraph;
+    single.hsize = hsizes.at(k);
+    REQUIRE(result.at(k) == single.computeBreaks(view));
+  }
+
+  REQUIRE(result.front().size() > result.back().size());
+  REQUIRE(paragraph.computeBreaks(view, {}).empty());
+
+  // The concave mode and the pruning check run each hsize separately
+  paragraph.adjdemerits = 0;
+  paragraph.concave = true;
+  paragraph.maxactive = 1;
+  paragraph.checkpruning = true;
+
+  result = paragraph.computeBreaks(view, hsizes);
+
+  Paragraph::Statistics statistics;
+
+  for (size_t k(0); k < hsizes.size(); ++k)
+  {
+    Paragraph single = paragraph;
+    single.statistics = Paragraph::Statistics{};
+    single.hsize = hsizes.at(k);
+    REQUIRE(result.at(k) == single.computeBreaks(view));
+
+    statistics.concave += single.statistics.concave;
+    statistics.prunedpasses += single.statistics.prunedpasses;
+  }
+
+  REQUIRE(statistics.concave > 0);
+  REQUIRE(paragraph.statistics.concave == statistics.concave);
+  REQUIRE(paragraph.statistics.prunedpasses == statistics.prunedpasses);
+}
+
+TEST_CASE("Incremental linebreaking matches a full run", "[linebreaks]")
+{
+  using namespace tex;
+
+  auto engine = std::make_shared<TestTypesetEngine>();
+
+  Paragraph paragraph;
+  paragraph.hsize = 60.f;
+  paragraph.pretolerance = -1; // a single pass, so that all edits are incremental
+
+  std::vector<int> lengths = word_lengths(120);
+  List hlist = build_paragraph(engine, lengths);
+  paragraph.prepare(hlist);
+
+  LinebreakCheckpoints checkpoints;
+  std::vector<size_t> breaks = paragraph.computeBreaks(HListView{ hlist }, checkpoints);
+
+  REQUIRE(breaks == paragraph.computeBreaks(HListView{ hlist }));
+  REQUIRE(checkpoints.checkpoints().size() == breaks.size() - 1);
+
+  // Each word is a single glyph run followed by interword glue,
+  // so the i-th word is at index 2i.
+
+  SECTION("replacing a word")
+  {
+    for (size_t word : { 3, 60, 117, 30 })
+    {
+      lengths.at(word) = lengths.at(word) == 6 ? 1 : 6;
+      hlist = build_paragraph(engine, lengths);
+      paragraph.prepare(hlist);
+
+      HListView view{ hlist };
+      breaks = paragraph.recomputeBreaks(view, 2 * word, 1, 1, checkpoints);
+
+      REQUIRE(breaks == paragraph.computeBreaks(view));
+      REQUIRE(checkpoints.resumedAt() <= 2 * word);
+    }
+
+    REQUIRE(checkpoints.resumedAt() > 0);
+  }
+
+  SECTION("inserting and removing words")
+  {
+    lengths.insert(lengths.begin() + 50, { 4, 2 });
+    hlist = build_paragraph(engine, lengths);
+    paragraph.prepare(hlist);
+
+    HListView view{ hlist };
+    breaks = paragraph.recomputeBreaks(view, 100, 0, 4, checkpoints);
+    REQUIRE(breaks == paragraph.computeBreaks(view));
+    REQUIRE(checkpoints.resumedAt() > 0);
+
+    lengths.erase(lengths.begin() + 10, lengths.begin() + 13);
+    hlist = build_paragraph(engine, lengths);
+    paragraph.prepare(hlist);
+
+    view = HListView{ hlist };
+    breaks = paragraph.recomputeBreaks(view, 20, 6, 0, checkpoints);
+    REQUIRE(breaks == paragraph.computeBreaks(view));
+  }
+
+  SECTION("edits that do not change the lines are local")
+  {
+    // Retypes word 20 with other characters of the same width
+    HListBuilder builder{ engine };
+
+    for (int j(0); j < lengths.at(20); ++j)
+      builder.push_back(Character('b'));
+
+    auto it = std::next(hlist.begin(), 40);
+    *it = builder.result.front();
+
+    HListView view{ hlist };
+    breaks = paragraph.recomputeBreaks(view, 40, 1, 1, checkpoints);
+
+    REQUIRE(breaks == paragraph.computeBreaks(view));
+    REQUIRE(checkpoints.resumedAt() > 0);
+    REQUIRE(checkpoints.resynchronizedAt() < 60);
+    REQUIRE(checkpoints.checkpoints().size() == breaks.size() - 1);
+
+    // The checkpoints that were copied from the previous run are usable
+    lengths.at(100) += 1;
+    hlist = build_paragraph(engine, lengths);
+    paragraph.prepare(hlist);
+
+    view = HListView{ hlist };
+    breaks = paragraph.recomputeBreaks(view, 200, 1, 1, checkpoints);
+
+    REQUIRE(breaks == paragraph.computeBreaks(view));
+    REQUIRE(checkpoints.resumedAt() > 150);
+  }
+}
+
+TEST_CASE("Linebreaking skips runs of discardable nodes", "[linebreaks]")
+{
+  using namespace tex;
+
+  auto engine = std::make_shared<TestTypesetEngine>();
+  HListBuilder builder{ engine };
+
+  for (int i(0); i < 40; ++i)
+  {
+    builder.push_back(Character('a'));
+    builder.push_back(Character('b'));
+
+    // Every fourth run ends with two forced breaks: the line between them
+    // only contains discardables and is empty whatever the demerits
+    for (int j(0); j < 1 + i % 4; ++j)
+    {
+      builder.push_back_interword_glue();
+      builder.result.push_back(make_node<Penalty>(i % 4 == 2 && j > 0 ? -10000 : j * 10));
+    }
+  }
+
+  // The rightskip stretches infinitely, so that no line is bad and the
+  // total demerits stay small
+  Paragraph paragraph;
+  paragraph.hsize = 30.f;
+  paragraph.leftskip = glue(1.f, Stretch(1.f));
+  paragraph.rightskip = glue(0.f, Stretch(1.f, GlueOrder::Fil));
+
+  List hlist = std::move(builder.result);
+  paragraph.prepare(hlist);
+  HListView view{ hlist };
+
+  std::vector<Paragraph::Breakpoint> breakpoints = paragraph.computeBreakpoints(view);
+  std::vector<size_t> breaks = paragraph.computeBreaks(view);
+
+  REQUIRE(breaks.size() + 1 == breakpoints.size());
+
+  for (size_t i(0); i < breaks.size(); ++i)
+    REQUIRE(view.position(breaks.at(i)) == breakpoints.at(i + 1).position);
+
+  // Consecutive breaks in the same run of discardables produce empty lines
+  size_t empty_lines = 0;
+
+  for (size_t i(1); i < breaks.size(); ++i)
+  {
+    size_t j = breaks.at(i - 1) + 1;
+
+    while (j < breaks.at(i) && !view.isBox(j))
+      ++j;
+
+    if (j == breaks.at(i))
+      ++empty_lines;
+  }
+
+  REQUIRE(empty_lines == 10);
+
+  List lines = paragraph.create(view, breaks);
+  REQUIRE(std::count_if(lines.begin(), lines.end(), [](const NodeRef<Node>& n) { return n->isHBox(); }) == static_cast<long>(breaks.size()));
+}
+
+TEST_CASE("ParagraphBatch breaks paragraphs in input order", "[linebreaks]")
+{
+  using namespace tex;
+
+  auto engine = std::make_shared<TestTypesetEngine>();
+
+  ParagraphBatch batch{ 4 };
+  std::vector<List> expected;
+
+  for (int i(0); i < 32; ++i)
+  {
+    Paragraph paragraph;
+    paragraph.hsize = 40.f + 10.f * (i % 5);
+    Paragraph other = paragraph;
+
+    List hlist = build_paragraph(engine, 20 + 7 * i);
+    paragraph.prepare(hlist);
+
+    expected.push_back(other.create(hlist));
+    REQUIRE(batch.add(paragraph, std::move(hlist)) == static_cast<size_t>(i));
+  }
+
+  std::vector<List> result = batch.run();
+
+  REQUIRE(batch.empty());
+  REQUIRE(result.size() == expected.size());
+
+  for (size_t i(0); i < result.size(); ++i)
+  {
+    REQUIRE(result[i].size() == expected[i].size());
+
+    for (auto it = result[i].begin(), jt = expected[i].begin(); it != result[i].end(); ++it, ++jt)
+    {
+      REQUIRE((*it)->kind() == (*jt)->kind());
+
+      if ((*it)->isHBox())
+        REQUIRE(std::equal((*it)->as<HBox>().list().begin(), (*it)->as<HBox>().list().end(), (*jt)->as<HBox>().list().begin()));
+    }
+  }
+
+  Paragraph impossible;
+  impossible.pretolerance = -1;
+  impossible.tolerance = -2;
+  List hlist = build_paragraph(engine, 10);
+  impossible.prepare(hlist);
+
+  batch.add(Paragraph{}, List{});
+  batch.add(impossible, std::move(hlist));
+  REQUIRE_THROWS_AS(batch.run(), std::runtime_error);
+}
+
+TEST_CASE("Linebreaking at discretionaries", "[linebreaks]")
+{
+  using namespace tex;
+
+  auto engine = std::make_shared<TestTypesetEngine>();
+
+  auto hyphenator = std::make_shared<Hyphenator>();
+  hyphenator->addPatterns("a1a");
+
+  HListBuilder builder{ engine };
+  builder.hyphenator = hyphenator;
+
+  for (int i(0); i < 30; ++i)
+  {
+    for (int j(0); j < 10; ++j)
+      builder.push_back(Character('a'));
+
+    builder.push_back_interword_glue();
+  }
+
+  List hlist = std::move(builder.result);
+  hlist.pop_back();
+
+  REQUIRE(std::count_if(hlist.begin(), hlist.end(), [](const NodeRef<Node>& n) { return n->isDiscretionary(); }) == 30 * 6);
+
+  Paragraph paragraph;
+  paragraph.hsize = 27.f;
+  paragraph.prepare(hlist);
+  HListView view{ hlist };
+
+  std::vector<Paragraph::Breakpoint> breakpoints = paragraph.computeBreakpoints(view);
+  std::vector<size_t> breaks = paragraph.computeBreaks(view);
+
+  REQUIRE(breaks.size() + 1 == breakpoints.size());
+
+  for (size_t i(0); i < breaks.size(); ++i)
+    REQUIRE(view.position(breaks.at(i)) == breakpoints.at(i + 1).position);
+
+  const long hyphenated = std::count_if(breaks.begin(), breaks.end(), [&](size_t b) {
+    return b < view.size() && view.isDiscretionary(b);
+  });
+
+  REQUIRE(hyphenated > 0);
+
+  // The lines of single words have no glue, the first pass fails
+  REQUIRE(paragraph.statistics.firstpass == 0);
+  REQUIRE(paragraph.statistics.secondpass == 2);
+
+  List lines = paragraph.create(view, breaks);
+
+  long hyphens = 0;
+
+  for (const NodeRef<Node>& line : lines)
+  {
+    if (!line->isHBox())
+      continue;
+
+    const HBox& box = line->as<HBox>();
+    REQUIRE(box.totals().width <= 27.f);
+
+    for (const NodeRef<Node>& n : box.list())
+    {
+      REQUIRE(!n->isDiscretionary());
+
+      if (n->isGlyphRun() && n->as<GlyphRun>().characters().front() == '-')
+        ++hyphens;
+    }
+  }
+
+  REQUIRE(hyphens == hyphenated);
+}
+
+TEST_CASE("Concave linebreaking matches the classic algorithm", "[linebreaks]")
+{
+  using namespace tex;
+
+  auto engine = std::make_shared<TestTypesetEngine>();
+
+  // Irregular words, so that different breakpoints rarely have the same demerits
+  std::vector<int> lengths;
+  unsigned seed = 1;
+
+  for (int i(0); i < 300; ++i)
+  {
+    seed = seed * 1103515245 + 12345;
+    lengths.push_back(1 + static_cast<int>((seed >> 16) % 9));
+  }
+
+  List hlist = build_paragraph(engine, lengths);
+  Paragraph{}.prepare(hlist);
+  HListView view{ hlist };
+
+  for (float hsize : { 50.f, 55.f, 60.f, 90.f, 200.f })
+  {
+    Paragraph classic;
+    classic.hsize = hsize;
+    classic.adjdemerits = 0;
+
+    Paragraph paragraph = classic;
+    paragraph.concave = true;
+
+    REQUIRE(paragraph.computeBreaks(view) == classic.computeBreaks(view));
+    REQUIRE(paragraph.statistics.concave == 1);
+    REQUIRE(paragraph.statistics.firstpass == classic.statistics.firstpass);
+
+    // Badnesses are capped with the default tolerance, the second pass uses the active list
+    REQUIRE(!paragraph.hasConcaveDemerits(paragraph.tolerance));
+  }
+
+  for (float hsize : { 90.f, 200.f })
+  {
+    Paragraph classic;
+    classic.hsize = hsize;
+    classic.adjdemerits = 0;
+    classic.pretolerance = -1;
+    classic.tolerance = 4.5f;
+
+    Paragraph paragraph = classic;
+    paragraph.concave = true;
+
+    REQUIRE(paragraph.computeBreaks(view) == classic.computeBreaks(view));
+    REQUIRE(paragraph.statistics.concave == 1);
+  }
+
+  // Fitness classes or variable line lengths fall back to the active list
+  Paragraph paragraph;
+  paragraph.concave = true;
+  paragraph.hsize = 60.f;
+  paragraph.computeBreaks(view);
+  REQUIRE(paragraph.statistics.concave == 0);
+
+  paragraph.adjdemerits = 0;
+  paragraph.hangindent = 10.f;
+  paragraph.computeBreaks(view);
+  REQUIRE(paragraph.statistics.concave == 0);
+}
+
+TEST_CASE("Linebreaking with a bounded active list", "[linebreaks]")
+{
+  using namespace tex;
+
+  auto engine = std::make_shared<TestTypesetEngine>();
+
+  std::vector<int> lengths;
+  unsigned seed = 7;
+
+  for (int i(0); i < 300; ++i)
+  {
+    seed = seed * 1103515245 + 12345;
+    lengths.push_back(1 + static_cast<int>((seed >> 16) % 9));
+  }
+
+  List hlist = build_paragraph(engine, lengths);
+  Paragraph{}.prepare(hlist);
+  HListView view{ hlist };
+
+  Paragraph reference;
+  reference.hsize = 60.f;
+  reference.pretolerance = -1;
+
+  const std::vector<size_t> breaks = reference.computeBreaks(view);
+
+  // Limits that are never reached do not change anything
+  Paragraph paragraph = reference;
+  paragraph.maxactive = 1000;
+  paragraph.demeritscutoff = std::numeric_limits<int64_t>::max();
+  paragraph.checkpruning = true;
+
+  REQUIRE(paragraph.computeBreaks(view) == breaks);
+  REQUIRE(paragraph.statistics.pruned == 0);
+  REQUIRE(paragraph.statistics.prunedpasses == 0);
+
+  // The best breakpoint of each line is always kept
+  paragraph = reference;
+  paragraph.maxactive = 1;
+  paragraph.checkpruning = true;
+
+  const std::vector<size_t> pruned = paragraph.computeBreaks(view);
+  REQUIRE(!pruned.empty());
+  REQUIRE(pruned.back() == breaks.back());
+  REQUIRE(paragraph.statistics.pruned > 0);
+  REQUIRE(paragraph.statistics.prunedpasses == 1);
+  REQUIRE(paragraph.statistics.prunechanged == (pruned != breaks ? 1 : 0));
+
+  paragraph.demeritscutoff = 0;
+  REQUIRE(paragraph.computeBreaks(view) == pruned);
+
+  // Breakpoints worse than the best by more than a line of maximal badness are hopeless
+  paragraph = reference;
+  paragraph.demeritscutoff = Paragraph::computeDemerits(paragraph.linepenalty, 10'000, 0);
+  paragraph.checkpruning = true;
+
+  REQUIRE(paragraph.computeBreaks(view) == breaks);
+  REQUIRE(paragraph.statistics.pruned > 0);
+  REQUIRE(paragraph.statistics.prunechanged == 0);
+
+  // The active lists saved in checkpoints are bounded
+  LinebreakCheckpoints unbounded;
+  reference.computeBreaks(view, unbounded);
+
+  LinebreakCheckpoints bounded;
+  paragraph = reference;
+  paragraph.maxactive = 2;
+  REQUIRE(paragraph.computeBreaks(view, bounded).back() == breaks.back());
+
+  size_t unbounded_size = 0, bounded_size = 0;
+
+  for (const LinebreakCheckpoint& c : unbounded.checkpoints())
+    unbounded_size = std::max(unbounded_size, c.active.size());
+
+  for (const LinebreakCheckpoint& c : bounded.checkpoints())
+    bounded_size = std::max(bounded_size, c.active.size());
+
+  REQUIRE(bounded_size < unbounded_size);
+}
+
+TEST_CASE("Linebreaking merges lines of the same length", "[linebreaks]")
+{
+  using namespace tex;
+
+  auto engine = std::make_shared<TestTypesetEngine>();
+
+  List hlist = build_paragraph(engine, 200);
+  Paragraph{}.prepare(hlist);
+  HListView view{ hlist };
+
+  size_t opportunities = 0;
+
+  for (size_t i(0); i < view.size(); ++i)
+  {
+    if (view.isGlue(i) || view.isPenalty(i))
+      ++opportunities;
+  }
+
+  // At most one breakpoint per fitness class at each position
+  Paragraph paragraph;
+  paragraph.hsize = 60.f;
+  paragraph.pretolerance = -1;
+  paragraph.computeBreaks(view);
+  REQUIRE(paragraph.statistics.breakpoints <= 4 * opportunities);
+
+  // The lines after the hangindent region, or after the parshape, are merged
+  Paragraph hanging = paragraph;
+  hanging.statistics = {};
+  hanging.hangindent = 6.f;
+  hanging.hangafter = -3;
+
+  Paragraph shaped = paragraph;
+  shaped.statistics = {};
+  shaped.parshape = { { 6.f, 54.f }, { 6.f, 54.f }, { 6.f, 54.f }, { 0.f, 60.f } };
+
+  REQUIRE(hanging.computeBreaks(view) == shaped.computeBreaks(view));
+  REQUIRE(hanging.statistics.breakpoints <= 4 * (opportunities + 3));
+  REQUIRE(shaped.statistics.breakpoints <= 4 * (opportunities + 3));
+
+  hanging.hangafter = 3;
+  shaped.parshape = { { 0.f, 60.f }, { 0.f, 60.f }, { 0.f, 60.f }, { 6.f, 54.f } };
+
+  REQUIRE(hanging.computeBreaks(view) == shaped.computeBreaks(view));
+}
@@ -0,0 +1,45 @@
+// Copyright (C) 2020 Vincent Chambrin
+// This file is part of the typeset project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "catch.hpp"
+
+#include "tex/hbox.h"
+#include "tex/math/atom.h"
+#include "tex/math/boundary.h"
+#include "tex/math/math-typeset.h"
+
+#include "test-typeset.h"
+
+TEST_CASE("Delimiters take the shift of boxes into account", "[math-typeset]")
+{
+  using namespace tex;
+
+  auto engine = std::make_shared<TestTypesetEngine>();
+
+  auto delimited = [&](float shift) -> NodeRef<Box> {
+    auto box = hbox({ make_node<TestBox>(BoxMetrics{ 2.f, 1.f, 2.f }) });
+    box->setShiftAmount(shift);
+
+    MathList mlist;
+    mlist.push_back(make_node<math::Boundary>(make_node<Symbol>()));
+    mlist.push_back(math::Atom::create<math::Atom::Ord>(box));
+    mlist.push_back(make_node<math::Boundary>(make_node<Symbol>()));
+
+    MathTypesetter typesetter{ engine };
+    List hlist = typesetter.mlist2hlist(std::move(mlist));
+
+    REQUIRE(hlist.front()->isHBox());
+    return cast<HBox>(hlist.front());
+  };
+
+  // The axis is at 1: the box extends 1 above and 2 below it, and the
+  // delimiter covers 901/1000 of twice that
+  NodeRef<Box> left = delimited(0.f);
+  REQUIRE(left->totalHeight() == Approx(901.f * 2.f / 500.f));
+
+  // Raising the box by 2 moves it 3 above the axis; the delimiter covers
+  // twice that minus the shortfall of 0.5
+  left = delimited(-2.f);
+  REQUIRE(left->totalHeight() == Approx(2.f * 3.f - 0.5f));
+}
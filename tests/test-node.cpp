@@ -0,0 +1,154 @@
+// Copyright (C) 2020 Vincent Chambrin
+// This file is part of the typeset project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "catch.hpp"
+
+#include "tex/hlistview.h"
+#include "tex/nodearena.h"
+#include "tex/penalty.h"
+#include "tex/visit.h"
+
+#include "test-typeset.h"
+
+TEST_CASE("Node kinds are set at construction", "[node]")
+{
+  using namespace tex;
+
+  tex::NodeRef<Node> g = glue(1.f);
+  tex::NodeRef<Node> k = kern(1.f);
+  tex::NodeRef<Node> p = penalty(0);
+  tex::NodeRef<Node> b = tex::make_node<TestBox>(BoxMetrics{ 1.f, 1.f, 1.f });
+  tex::NodeRef<Node> h = hbox({ g, k, b });
+
+  REQUIRE(g->kind() == NodeKind::Glue);
+  REQUIRE(g->isGlue());
+  REQUIRE(g->isGlueOrKern());
+  REQUIRE(!g->isBox());
+
+  REQUIRE(k->is<Kern>());
+  REQUIRE(p->is<Penalty>());
+  REQUIRE(!p->is<Kern>());
+
+  REQUIRE(b->isBox());
+  REQUIRE(b->is<Box>());
+  REQUIRE(b->is<TestBox>());
+  REQUIRE(!b->isListBox());
+
+  REQUIRE(h->isHBox());
+  REQUIRE(h->is<Box>());
+  REQUIRE(h->is<ListBox>());
+  REQUIRE(!h->is<VBox>());
+}
+
+TEST_CASE("visit() dispatches on the node kind", "[node]")
+{
+  using namespace tex;
+
+  List list{ glue(1.f), kern(2.f), tex::make_node<TestBox>(BoxMetrics{ 1.f, 1.f, 3.f }), hbox({ kern(4.f) }), penalty(0) };
+
+  int boxes = 0;
+  int listboxes = 0;
+  int others = 0;
+  float w = 0.f;
+
+  auto visitor = overloaded(
+    [&](const ListBox& box) { ++listboxes; w += box.width(); },
+    [&](const Box& box) { ++boxes; w += box.width(); },
+    [&](const Kern& k) { w += k.space(); },
+    [&](const Glue& g) { w += g.space(); },
+    [&](const Node&) { ++others; }
+  );
+
+  for (const auto& node : list)
+    visit(*node, visitor);
+
+  REQUIRE(boxes == 1);
+  REQUIRE(listboxes == 1);
+  REQUIRE(others == 1);
+  REQUIRE(w == 10.f);
+}
+
+TEST_CASE("Nodes can be allocated from an arena", "[node]")
+{
+  using namespace tex;
+
+  tex::NodeRef<Glue> g;
+  tex::NodeRef<HBox> h;
+
+  {
+    auto arena = std::make_shared<NodeArena>(1024);
+
+    g = make_node<Glue>(arena.get(), 1.f, 0.5f, 2.f);
+    h = make_node<HBox>(arena.get(), List{ g, make_node<Kern>(arena.get(), 3.f) });
+
+    REQUIRE(arena->blockCount() == 1);
+    REQUIRE(arena->bytesUsed() > 0);
+
+    for (int i(0); i < 200; ++i)
+      make_node<Penalty>(arena.get(), i);
+
+    REQUIRE(arena->blockCount() > 1);
+  }
+
+  // nodes keep their memory alive after the arena is gone
+  REQUIRE(g->isGlue());
+  REQUIRE(g->stretch() == 2.f);
+  REQUIRE(h->width() == 4.f);
+
+  auto heap = make_node<Kern>(static_cast<NodeArena*>(nullptr), 1.f);
+  REQUIRE(heap->space() == 1.f);
+}
+
+TEST_CASE("HListView flattens a horizontal list", "[node]")
+{
+  using namespace tex;
+
+  List hlist;
+  hlist.push_back(tex::make_node<TestBox>(BoxMetrics{ 2.f, 1.f, 3.f }));
+  hlist.push_back(tex::make_node<Glue>(1.f, 0.5f, 2.f));
+  hlist.push_back(kern(4.f));
+  hlist.push_back(penalty(-10));
+  hlist.push_back(tex::make_node<TestBox>(BoxMetrics{ 5.f, 0.f, 1.f }));
+
+  HListView view{ hlist };
+
+  REQUIRE(view.size() == 5);
+  REQUIRE(view.isBox(0));
+  REQUIRE(view.isGlue(1));
+  REQUIRE(view.isKern(2));
+  REQUIRE(view.isPenalty(3));
+  REQUIRE(view.penalty(3) == -10);
+  REQUIRE(view.width(2) == 4.f);
+  REQUIRE(view.stretch(1, GlueOrder::Normal) == 2.f);
+  REQUIRE(view.position(view.size()) == hlist.end());
+
+  BoxingInfo info;
+  view.getBoxingInfo(0, view.size(), info);
+
+  auto box = hbox(std::move(hlist));
+  REQUIRE(info.width == box->width());
+  REQUIRE(info.height == box->height());
+  REQUIRE(info.depth == box->depth());
+}
+
+TEST_CASE("NodeRef shares ownership of nodes", "[node]")
+{
+  using namespace tex;
+
+  NodeRef<Node> n = make_node<Kern>(2.f);
+  REQUIRE(n.use_count() == 1);
+
+  {
+    NodeRef<Kern> k = static_pointer_cast<Kern>(n);
+    REQUIRE(n.use_count() == 2);
+    REQUIRE(k->space() == 2.f);
+    REQUIRE(k == n);
+  }
+
+  REQUIRE(n.use_count() == 1);
+  REQUIRE(dynamic_pointer_cast<Glue>(n) == nullptr);
+
+  n.reset();
+  REQUIRE(n == nullptr);
+}
@@ -0,0 +1,130 @@
+// Copyright (C) 2020 Vincent Chambrin
+// This file is part of the typeset project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "catch.hpp"
+
+#include "tex/glue.h"
+#include "tex/pagebuilder.h"
+#include "tex/penalty.h"
+#include "tex/rule.h"
+
+#include <algorithm>
+
+namespace
+{
+
+// Lines of height 8 and depth 2, 12pt apart
+void push_lines(tex::PageBuilder& builder, int count)
+{
+  for (int i(0); i < count; ++i)
+  {
+    builder.push_back(tex::make_node<tex::Glue>(2.f, 0.f, 1.f));
+    builder.push_back(tex::hrule(100.f, 8.f, 2.f));
+  }
+}
+
+size_t count_lines(const tex::VBox& page)
+{
+  return std::count_if(page.list().begin(), page.list().end(), [](const tex::NodeRef<tex::Node>& n) {
+    return n->isBox();
+  });
+}
+
+} // namespace
+
+TEST_CASE("PageBuilder fills pages", "[pagebuilder]")
+{
+  using namespace tex;
+
+  std::vector<NodeRef<VBox>> pages;
+
+  PageBuilder builder{ [&pages](NodeRef<VBox> page) {
+    pages.push_back(page);
+  } };
+
+  builder.vsize = 94.f;
+
+  // With topskip, a page of n lines is 12n - 2 high
+  push_lines(builder, 20);
+
+  REQUIRE(pages.size() == 2);
+  REQUIRE(count_lines(*pages.at(0)) == 8);
+  REQUIRE(count_lines(*pages.at(1)) == 8);
+  REQUIRE(pages.at(0)->height() == 94.f);
+
+  // The glue at the break was discarded and replaced by topskip
+  const ChildList& page = pages.at(1)->list();
+  REQUIRE(page[0]->isGlue());
+  REQUIRE(page[0]->as<Glue>().space() == 2.f);
+  REQUIRE(page[1]->isBox());
+
+  builder.finish();
+
+  REQUIRE(pages.size() == 3);
+  REQUIRE(count_lines(*pages.at(2)) == 4);
+  REQUIRE(pages.at(2)->height() == 94.f);
+  REQUIRE(builder.page().empty());
+  REQUIRE(builder.contributions().empty());
+
+  builder.finish();
+  REQUIRE(pages.size() == 3);
+}
+
+TEST_CASE("PageBuilder breaks at penalties", "[pagebuilder]")
+{
+  using namespace tex;
+
+  std::vector<size_t> lines;
+
+  PageBuilder builder{ [&lines](NodeRef<VBox> page) {
+    lines.push_back(count_lines(*page));
+  } };
+
+  builder.vsize = 94.f;
+
+  push_lines(builder, 3);
+  builder.push_back(make_node<Penalty>(-10000));
+  REQUIRE(lines == std::vector<size_t>{ 3 });
+
+  // Penalties at the top of a page are discarded
+  builder.push_back(make_node<Penalty>(-10000));
+  REQUIRE(lines == std::vector<size_t>{ 3 });
+
+  // Breaking after the 8th line is forbidden: the page is a bit underfull
+  push_lines(builder, 8);
+  builder.push_back(make_node<Penalty>(10000));
+  push_lines(builder, 2);
+  REQUIRE(lines == std::vector<size_t>{ 3, 7 });
+
+  builder.finish();
+  REQUIRE(lines == std::vector<size_t>{ 3, 7, 3 });
+
+  // The penalty makes the best fit worse than a slightly underfull page
+  lines.clear();
+  push_lines(builder, 8);
+  builder.push_back(make_node<Penalty>(1000));
+  push_lines(builder, 2);
+  REQUIRE(lines == std::vector<size_t>{ 7 });
+  REQUIRE(builder.statistics.pages == 4);
+}
+
+TEST_CASE("PageBuilder only keeps the current page", "[pagebuilder]")
+{
+  using namespace tex;
+
+  size_t pages = 0;
+
+  PageBuilder builder{ [&pages](NodeRef<VBox> page) {
+    REQUIRE(count_lines(*page) == 8);
+    ++pages;
+  } };
+
+  builder.vsize = 94.f;
+
+  push_lines(builder, 1000);
+  builder.finish();
+
+  REQUIRE(pages == 125);
+  REQUIRE(builder.statistics.peak <= 20);
+}
@@ -71,7 +71,7 @@ TEST_CASE("The parser can process a simple glue", "[glue-parsing]")
   parsing::GlueParser parser{ us };
   write_chars(parser, "1em");
 
-  std::shared_ptr<Glue> g = parser.finish();
+  tex::NodeRef<Glue> g = parser.finish();
 
   REQUIRE(g->space() == 2.f);
   REQUIRE(g->stretch() == 0.f);
@@ -90,7 +90,7 @@ TEST_CASE("The parser can process a glue with finite stretch & shrink", "[glue-p
   parsing::GlueParser parser{ us };
   write_chars(parser, "1ex plus 2pt minus 3em");
 
-  std::shared_ptr<Glue> g = parser.finish();
+  tex::NodeRef<Glue> g = parser.finish();
 
   REQUIRE(g->space() == 0.5f);
   REQUIRE(g->stretch() == 2.f);
@@ -109,7 +109,7 @@ TEST_CASE("The parser can process a glue with infinite stretch & shrink", "[glue
   parsing::GlueParser parser{ us };
   write_chars(parser, "1pc plus 1fil minus 2fill");
 
-  std::shared_ptr<Glue> g = parser.finish();
+  tex::NodeRef<Glue> g = parser.finish();
 
   REQUIRE(g->space() == 12.f);
   REQUIRE(g->stretch() == 1.f);
@@ -130,7 +130,7 @@ TEST_CASE("The parser can process a glue with a trailing space", "[glue-parsing]
   parsing::GlueParser parser{ us };
   write_chars(parser, "1pc ");
 
-  std::shared_ptr<Glue> g = parser.finish();
+  tex::NodeRef<Glue> g = parser.finish();
 
   REQUIRE(g->space() == 12.f);
 }
@@ -147,7 +147,7 @@ TEST_CASE("The parser can process a kern", "[glue-parsing]")
   parsing::KernParser parser{ us };
   write_chars(parser, "1pc ");
 
-  std::shared_ptr<Kern> k = parser.finish();
+  tex::NodeRef<Kern> k = parser.finish();
 
   REQUIRE(k->space() == 12.f);
 }
@@ -164,7 +164,7 @@ TEST_CASE("The parser can process a decimal kern", "[glue-parsing]")
   parsing::KernParser parser{ us };
   write_chars(parser, "-.125pt ");
 
-  std::shared_ptr<Kern> k = parser.finish();
+  tex::NodeRef<Kern> k = parser.finish();
 
   REQUIRE(k->space() == -0.125f);
 }
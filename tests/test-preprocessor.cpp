@@ -122,6 +122,66 @@ TEST_CASE("The preprocessor supports \\if", "[preprocessor]")
   preproc.output.clear();
 }
 
+TEST_CASE("The preprocessor restores definitions at the end of a group", "[preprocessor]")
+{
+  using namespace tex;
+  using namespace parsing;
+
+  Preprocessor preproc{};
+
+  write(preproc, "\\def\\foo{A}");
+
+  preproc.beginGroup();
+  write(preproc, "\\def\\foo{B}\\def\\bar{C}\\def\\foo{D}");
+
+  // Only the first definition of each macro in the group is saved
+  REQUIRE(preproc.definitions().savestack.size() == 2);
+
+  preproc.beginGroup();
+  write(preproc, "\\def\\foo{E}\\foo ");
+  REQUIRE(preproc.output == tokenize("E"));
+  preproc.output.clear();
+  preproc.endGroup();
+
+  write(preproc, "\\foo\\bar ");
+  REQUIRE(preproc.output == tokenize("DC"));
+  preproc.output.clear();
+
+  // Leaving the inner group restores the level at which \foo was defined
+  write(preproc, "\\def\\foo{F}");
+  REQUIRE(preproc.definitions().savestack.size() == 2);
+  REQUIRE(preproc.definitions().levels.at("foo") == 1);
+
+  preproc.endGroup();
+  REQUIRE(preproc.definitions().savestack.empty());
+  REQUIRE(preproc.definitions().levels.empty());
+  REQUIRE(preproc.find("bar") == nullptr);
+
+  write(preproc, "\\foo ");
+  REQUIRE(preproc.output == tokenize("A"));
+}
+
+TEST_CASE("The preprocessor can be reset to saved definitions", "[preprocessor]")
+{
+  using namespace tex;
+  using namespace parsing;
+
+  Preprocessor preproc{};
+
+  write(preproc, "\\def\\foo{A}");
+  const Preprocessor::Definitions saved = preproc.definitions();
+
+  write(preproc, "\\def\\foo{B}\\def\\bar{C}\\def\\baz#1{");
+  REQUIRE(preproc.state().frames.back().type == Preprocessor::State::ReadingMacro);
+
+  preproc.reset(saved);
+  REQUIRE(preproc.state().frames.size() == 1);
+  REQUIRE(preproc.find("bar") == nullptr);
+
+  write(preproc, "\\foo ");
+  REQUIRE(preproc.output == tokenize("A"));
+}
+
 TEST_CASE("The preprocessor supports \\csname", "[preprocessor]")
 {
   using namespace tex;
@@ -0,0 +1,44 @@
+// Copyright (C) 2020 Vincent Chambrin
+// This file is part of the typeset project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "catch.hpp"
+
+#include "tex/smallvector.h"
+
+#include <string>
+
+TEST_CASE("SmallVector stores small sequences inline", "[smallvector]")
+{
+  using namespace tex;
+
+  SmallVector<std::string, 2> vec;
+  REQUIRE(vec.empty());
+  REQUIRE(vec.isInline());
+
+  vec.push_back("b");
+  vec.push_front("a");
+  REQUIRE(vec.isInline());
+  REQUIRE(vec.size() == 2);
+  REQUIRE(vec.front() == "a");
+  REQUIRE(vec.back() == "b");
+
+  vec.push_back("d");
+  REQUIRE(!vec.isInline());
+  vec.insert(vec.begin() + 2, "c");
+  REQUIRE(vec.size() == 4);
+  REQUIRE(std::string(vec[0] + vec[1] + vec[2] + vec[3]) == "abcd");
+
+  SmallVector<std::string, 2> moved{ std::move(vec) };
+  REQUIRE(vec.empty());
+  REQUIRE(moved.size() == 4);
+
+  moved.erase(moved.begin(), moved.begin() + 3);
+  REQUIRE(moved.size() == 1);
+  REQUIRE(moved.front() == "d");
+
+  SmallVector<std::string, 2> small{ "x" };
+  SmallVector<std::string, 2> copy = small;
+  REQUIRE(copy.isInline());
+  REQUIRE(copy.front() == "x");
+}
@@ -4,6 +4,8 @@
 
 #include "test-typeset.h"
 
+#include "tex/hlist.h"
+
 TestFontMetricsProvider::TestFontMetricsProvider()
 {
   m_fontdimen.slant_per_pt = 0.f;
@@ -41,12 +43,12 @@ tex::BoxMetrics TestFontMetricsProvider::metrics(tex::Character c, tex::Font fon
   return tex::BoxMetrics{ 2.f, 1.f, 2.f };
 }
 
-tex::BoxMetrics TestFontMetricsProvider::metrics(const std::shared_ptr<tex::Symbol>& symbol, tex::Font font)
+tex::BoxMetrics TestFontMetricsProvider::metrics(const tex::NodeRef<tex::Symbol>& symbol, tex::Font font)
 {
   return tex::BoxMetrics{ 2.f, 1.f, 2.f };
 }
 
-float TestFontMetricsProvider::italicCorrection(const std::shared_ptr<tex::Symbol>& symbol, tex::Font font)
+float TestFontMetricsProvider::italicCorrection(const tex::NodeRef<tex::Symbol>& symbol, tex::Font font)
 {
   return 0.0f;
 }
@@ -66,40 +68,71 @@ std::shared_ptr<tex::FontMetricsProvider> TestTypesetEngine::metrics() const
   return m_metrics;
 }
 
-std::shared_ptr<tex::Box> TestTypesetEngine::typeset(tex::Character c, tex::Font font)
+tex::NodeRef<tex::Box> TestTypesetEngine::typeset(tex::Character c, tex::Font font)
 {
-  return std::make_shared<TestBox>(std::string(tex::Utf8Char{ c }.data()), metrics()->metrics(nullptr, font));
+  return tex::make_node<TestBox>(std::string(tex::Utf8Char{ c }.data()), metrics()->metrics(nullptr, font));
 }
 
-std::shared_ptr<tex::Box> TestTypesetEngine::typeset(const std::string& text, tex::Font font)
+tex::NodeRef<tex::Box> TestTypesetEngine::typeset(const std::string& text, tex::Font font)
 {
-  return std::make_shared<TestBox>(text, metrics()->metrics(nullptr, font));
+  return tex::make_node<TestBox>(text, metrics()->metrics(nullptr, font));
 }
 
-std::shared_ptr<tex::Box> TestTypesetEngine::typeset(const std::shared_ptr<tex::Symbol>& symbol, tex::Font font)
+tex::NodeRef<tex::Box> TestTypesetEngine::typeset(const tex::NodeRef<tex::Symbol>& symbol, tex::Font font)
 {
-  return std::make_shared<TestBox>(metrics()->metrics(symbol, font));
+  return tex::make_node<TestBox>(metrics()->metrics(symbol, font));
 }
 
-std::shared_ptr<tex::Box> TestTypesetEngine::typesetRadicalSign(float minTotalHeight)
+tex::NodeRef<tex::Box> TestTypesetEngine::typesetRadicalSign(float minTotalHeight)
 {
   tex::BoxMetrics box;
   box.width = 2;
   box.height = metrics()->fontdimen(tex::Font::MathRoman).default_rule_thickness;
   box.depth = minTotalHeight - metrics()->fontdimen(tex::Font::MathRoman).default_rule_thickness;
-  return std::make_shared<TestBox>(box);
+  return tex::make_node<TestBox>(box);
 }
 
-std::shared_ptr<tex::Box> TestTypesetEngine::typesetDelimiter(const std::shared_ptr<tex::Symbol>& symbol, float minTotalHeight)
+tex::NodeRef<tex::Box> TestTypesetEngine::typesetDelimiter(const tex::NodeRef<tex::Symbol>& symbol, float minTotalHeight)
 {
   tex::BoxMetrics box;
   box.width = 2;
   box.height = metrics()->fontdimen(tex::Font::MathRoman).default_rule_thickness;
   box.depth = minTotalHeight - metrics()->fontdimen(tex::Font::MathRoman).default_rule_thickness;
-  return std::make_shared<TestBox>(box);
+  return tex::make_node<TestBox>(box);
+}
+
+tex::NodeRef<tex::Box> TestTypesetEngine::typesetLargeOp(const tex::NodeRef<tex::Symbol>& symbol)
+{
+  return tex::make_node<TestBox>(metrics()->metrics(symbol, tex::Font::MathRoman));
+}
+
+std::vector<int> word_lengths(int words)
+{
+  std::vector<int> result;
+
+  for (int i(0); i < words; ++i)
+    result.push_back(1 + (i * 7) % 6);
+
+  return result;
+}
+
+tex::List build_paragraph(std::shared_ptr<TestTypesetEngine> engine, const std::vector<int>& lengths, char letter)
+{
+  tex::HListBuilder builder{ engine };
+
+  for (size_t i(0); i < lengths.size(); ++i)
+  {
+    for (int j(0); j < lengths.at(i); ++j)
+      builder.push_back(tex::Character(letter));
+
+    if (i + 1 < lengths.size())
+      builder.push_back_interword_glue();
+  }
+
+  return std::move(builder.result);
 }
 
-std::shared_ptr<tex::Box> TestTypesetEngine::typesetLargeOp(const std::shared_ptr<tex::Symbol>& symbol)
+tex::List build_paragraph(std::shared_ptr<TestTypesetEngine> engine, int words, char letter)
 {
-  return std::make_shared<TestBox>(metrics()->metrics(symbol, tex::Font::MathRoman));
+  return build_paragraph(engine, word_lengths(words), letter);
 }
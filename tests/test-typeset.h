@@ -5,8 +5,11 @@
 #ifndef LIBTYPESET_TEST_TYPESET_H
 #define LIBTYPESET_TEST_TYPESET_H
 
+#include "tex/listbox.h"
 #include "tex/typeset.h"
 
+#include <vector>
+
 class TestBox : public tex::Box
 {
 public:
@@ -35,8 +38,8 @@ public:
   TestFontMetricsProvider();
 
   tex::BoxMetrics metrics(tex::Character c, tex::Font font) override;
-  tex::BoxMetrics metrics(const std::shared_ptr<tex::Symbol>& symbol, tex::Font font) override;
-  float italicCorrection(const std::shared_ptr<tex::Symbol>& symbol, tex::Font font) override;
+  tex::BoxMetrics metrics(const tex::NodeRef<tex::Symbol>& symbol, tex::Font font) override;
+  float italicCorrection(const tex::NodeRef<tex::Symbol>& symbol, tex::Font font) override;
 
   const tex::FontDimen& fontdimen(tex::Font f) override;
 };
@@ -49,15 +52,20 @@ public:
 
   std::shared_ptr<tex::FontMetricsProvider> metrics() const override;
   
-  std::shared_ptr<tex::Box> typeset(tex::Character c, tex::Font font) override;
-  std::shared_ptr<tex::Box> typeset(const std::string& text, tex::Font font) override;
-  std::shared_ptr<tex::Box> typeset(const std::shared_ptr<tex::Symbol>& symbol, tex::Font font)  override;
-  std::shared_ptr<tex::Box> typesetRadicalSign(float minTotalHeight)  override;
-  std::shared_ptr<tex::Box> typesetDelimiter(const std::shared_ptr<tex::Symbol>& symbol, float minTotalHeight)  override;
-  std::shared_ptr<tex::Box> typesetLargeOp(const std::shared_ptr<tex::Symbol>& symbol)  override;
+  tex::NodeRef<tex::Box> typeset(tex::Character c, tex::Font font) override;
+  tex::NodeRef<tex::Box> typeset(const std::string& text, tex::Font font) override;
+  tex::NodeRef<tex::Box> typeset(const tex::NodeRef<tex::Symbol>& symbol, tex::Font font)  override;
+  tex::NodeRef<tex::Box> typesetRadicalSign(float minTotalHeight)  override;
+  tex::NodeRef<tex::Box> typesetDelimiter(const tex::NodeRef<tex::Symbol>& symbol, float minTotalHeight)  override;
+  tex::NodeRef<tex::Box> typesetLargeOp(const tex::NodeRef<tex::Symbol>& symbol)  override;
 
 private:
   std::shared_ptr<tex::FontMetricsProvider> m_metrics;
 };
 
+std::vector<int> word_lengths(int words);
+
+tex::List build_paragraph(std::shared_ptr<TestTypesetEngine> engine, const std::vector<int>& lengths, char letter = 'a');
+tex::List build_paragraph(std::shared_ptr<TestTypesetEngine> engine, int words, char letter = 'a');
+
 #endif // LIBTYPESET_TEST_TYPESET_H